@@ -1500,18 +1500,14 @@ sint32 way_builder_t::intern_calc_route(const vector_tpl<koord3d> &start, const
 		route_t::INIT_NODES(welt->get_settings().get_max_route_steps(), welt->get_size());
 	}
 
-	static binary_heap_tpl <route_t::ANode *> queue;
-
-	// get exclusively a tile list
+	// get exclusively a tile list, and its queue
 	route_t::ANode *nodes;
 	uint8 ni = route_t::GET_NODES(&nodes);
+	binary_heap_tpl <route_t::ANode *> &queue = route_t::GET_QUEUE(ni);
 
 	// initialize marker field
 	marker_t& marker = marker_t::instance(welt->get_size().x, welt->get_size().y, karte_t::marker_index);
 
-	// clear the queue (should be empty anyhow)
-	queue.clear();
-
 	// some obj for the search
 	grund_t *to;
 	koord3d gr_pos; // just the last valid pos ...
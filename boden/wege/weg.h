@@ -17,6 +17,8 @@
 #include "../../obj/simobj.h"
 #include "../../descriptor/way_desc.h"
 #include "../../dataobj/koord3d.h"
+#include "../../dataobj/route_landmarks.h"
+#include "../../dataobj/private_car_routes.h"
 #include "../../tpl/minivec_tpl.h"
 #include "../../tpl/ordered_vector_tpl.h"
 #include "../../simskin.h"
@@ -246,115 +248,15 @@ public:
 	// This was in strasse_t, but being there possibly caused heap corruption.
 	minivec_tpl<gebaeude_t*> connected_buildings;
 
-	/**
-	 * Map of all private car routes from way
-	 */
-	class private_car_route_map{
-	public:
-		void set_route_map_elem(uint8 elem){route_map_elem=elem;}
-
-		private_car_route_map(){link_mode=link_mode_NULL;}
-
-		void clear();
-
-		void pre_reset();
-
-		bool contains(koord elem) const;
-		bool insert_unique(koord elem, private_car_route_map* link_to = NULL, uint8 link_dir=0);
-
-		koord& get_by_index(uint32_t i);
-		const koord& get_by_index(uint32_t i) const;
-
-		koord& operator [] (uint32 i);
-		const koord& operator [] (uint32 i) const ;
-
-		uint32 get_count() const ;
-		bool is_empty() const ;
-
-		bool remove(koord elem);
-		void resize(uint32 new_size);
-
-		static void reset(uint8 map_elem);
-
-		//backwards compatible saving
-		void rdwr(loadsave_t *file);
-
-	private:
-		union {
-			uint32 idx;
-			koord single_koord;
-		};
-		uint8 link_mode:3;
-		uint8 route_map_elem:1;
-		enum link_modes {
-			link_mode_NULL=7,
-			link_mode_single=6,
-			link_mode_master=5
-		};
-
-		static vector_tpl<ordered_vector_tpl<koord,uint32> > route_maps[2];
-public:
-
-		inline sint32 get_idx() const {if(link_mode==link_mode_NULL || link_mode==link_mode_single) return -1; return idx;}
-
-#ifdef MULTI_THREAD
-		static pthread_mutex_t route_map_mtx;
-#endif
-
-
-		inline static void route_map_lock() {
-#ifdef MULTI_THREAD
-			int error = pthread_mutex_lock(&route_map_mtx);
-			assert(error == 0);
-			(void)error;
-#endif
-			return;
-		}
-
-		inline static void route_map_unlock() {
-#ifdef MULTI_THREAD
-			int error = pthread_mutex_unlock(&route_map_mtx);
-			assert(error == 0);
-			(void)error;
-#endif
-			return;
-		}
-	};
-
-
-
-	// Likewise, out of caution, put this here for the same reason.
-	// n_bags must be fairly low as there are 2 maps per way and usually zero elements per way, up to ~150 in high cases and ~1500 in highest cases
-	//typedef ordered_vector_tpl<koord, uint32> private_car_route_map;
-	//typedef std::unordered_map<koord, koord3d> private_car_route_map_2;
-	private_car_route_map private_car_routes[2][5];
-	//private_car_route_map_2 private_car_routes_std[2];
-	static uint32 private_car_routes_currently_reading_element;
-	static uint32 get_private_car_routes_currently_writing_element() { return private_car_routes_currently_reading_element == 1 ? 0 : 1; }
-
-	static void private_car_backtrace_begin();
-	static void private_car_backtrace_end();
-	void private_car_backtrace_add(koord destination, koord3d next_tile);
-	void private_car_backtrace_inc(koord3d next_tile);
-
-	static private_car_route_map* private_car_backtrace_last_route_map;
-	static uint8 private_car_backtrace_last_idx;
-
-	void add_private_car_route(koord dest, koord3d next_tile);
+	/// @returns whether private cars at this tile have a route to @p dest
 	bool has_private_car_route(koord dest) const;
-	koord3d get_next_on_private_car_route_to(koord dest, bool reading_set=true, uint8 start_dir=0) const;
-private:
-	/// Set the boolean value to true to modify the set currently used for reading (this must ONLY be done when this is called from a single threaded part of the code).
-	void remove_private_car_route(koord dest, bool reading_set = false);
-public:
-	static void swap_private_car_routes_currently_reading_element() { private_car_routes_currently_reading_element = private_car_routes_currently_reading_element == 0 ? 1 : 0; }
-
-	/// Delete all private car routes originating from or passing through this tile.
-	/// Set the boolean value to true to modify the set currently used for reading (this must ONLY be done when this is called from a single threaded part of the code).
-	void delete_all_routes_from_here(bool reading_set = false);
-	void delete_route_to(koord destination, bool reading_set = false);
-
 
+	/**
+	 * @returns the next tile on the route of private cars from here to @p dest, koord3d::invalid if @p dest
+	 * is reached here, or koord3d() if there is no such route. Where the routes of several cities leave
+	 * this tile in different directions, the first one from @p start_dir on is taken.
+	 */
+	koord3d get_next_on_private_car_route_to(koord dest, uint8 start_dir=0) const;
 
 	virtual ~weg_t();
 
@@ -443,7 +345,16 @@ public:
 	* @note After changing of ribi the image of the way is wrong. To correct this,
 	* grund_t::calc_image needs to be called. This is not done here (Too expensive).
 	*/
-	void ribi_add(ribi_t::ribi ribi) { this->ribi |= (uint8)ribi;}
+	void ribi_add(ribi_t::ribi ribi)
+	{
+		if(  ribi & ~this->ribi  ) {
+			route_landmarks_t::set_network_changed(get_waytype());
+			if(  wtyp == road_wt  ) {
+				private_car_routes_t::set_road_changed(get_pos(), false);
+			}
+		}
+		this->ribi |= (uint8)ribi;
+	}
 
 	/**
 	* Remove direction bits (ribi) for a way.
@@ -451,7 +362,13 @@ public:
 	* @note After changing of ribi the image of the way is wrong. To correct this,
 	* grund_t::calc_image needs to be called. This is not done here (Too expensive).
 	*/
-	void ribi_rem(ribi_t::ribi ribi) { this->ribi &= (uint8)~ribi;}
+	void ribi_rem(ribi_t::ribi ribi)
+	{
+		if(  wtyp == road_wt  &&  (ribi & this->ribi)  ) {
+			private_car_routes_t::set_road_changed(get_pos(), true);
+		}
+		this->ribi &= (uint8)~ribi;
+	}
 
 	/**
 	* Set direction bits (ribi) for the way.
@@ -459,7 +376,16 @@ public:
 	* @note After changing of ribi the image of the way is wrong. To correct this,
 	* grund_t::calc_image needs to be called. This is not done here (Too expensive).
 	*/
-	void set_ribi(ribi_t::ribi ribi) { this->ribi = (uint8)ribi;}
+	void set_ribi(ribi_t::ribi ribi)
+	{
+		if(  ribi & ~this->ribi  ) {
+			route_landmarks_t::set_network_changed(get_waytype());
+		}
+		if(  wtyp == road_wt  &&  ribi != this->ribi  ) {
+			private_car_routes_t::set_road_changed(get_pos(), (this->ribi & ~ribi) != 0);
+		}
+		this->ribi = (uint8)ribi;
+	}
 
 	/**
 	* Get the unmasked direction bits (ribi) for the way (without signals or other ribi changer).
@@ -501,6 +427,13 @@ public:
 	*/
 	void new_month();
 
+	/**
+	* The two halves of new_month(): rolling over the statistics only changes
+	* this way, whereas the wear may renew it at the owner's expense.
+	*/
+	void roll_statistics();
+	void apply_monthly_wear();
+
 	void check_diagonal();
 
 	void count_sign();
@@ -593,8 +526,6 @@ public:
 		}
 		return (combined_actual * 100u / combined_ideal) - 100u;
 	}
-
-	uint8 get_map_idx(const koord3d &next_tile) const;
 };
 
 
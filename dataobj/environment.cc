@@ -24,6 +24,7 @@ bool env_t::simple_drawing = false;
 bool env_t::simple_drawing_fast_forward = true;
 sint16 env_t::simple_drawing_normal = 4;
 sint16 env_t::simple_drawing_default = 24;
+bool env_t::redraw_changes_only = false;
 uint8 env_t::follow_convoi_underground = 2;
 
 char env_t::data_dir[PATH_MAX];
@@ -63,6 +64,7 @@ sint32 env_t::network_frames_per_step = 4;
 uint32 env_t::server_sync_steps_between_checks = 24;
 bool env_t::pause_server_no_clients = false;
 bool env_t::server_runs_background_tasks_when_paused = false;
+bool env_t::server_streamed_join = false;
 
 std::string env_t::nickname = "";
 
@@ -130,6 +132,7 @@ sint32 env_t::intercity_road_length;
 plainstring env_t::river_type[10];
 uint8 env_t::river_types;
 sint32 env_t::autosave;
+bool env_t::background_autosave;
 uint32 env_t::fps;
 uint32 env_t::ff_fps;
 sint16 env_t::max_acceleration;
@@ -263,6 +266,7 @@ void env_t::init()
 
 	// autosave every x months (0=off)
 	autosave = 0;
+	background_autosave = true;
 
 	// default: make 25 frames per second (if possible) and 10 for faster fast forward
 	fps = 25;
@@ -138,6 +138,12 @@ public:
 	/// The server will run the path explorer and private car route finder when paused if this is set.
 	static bool server_runs_background_tasks_when_paused;
 
+	/**
+	 * Joining clients receive a snapshot of the running game and the commands issued since.
+	 * All clients still reload the game at the same time, but none waits for the transfer.
+	 */
+	static bool server_streamed_join;
+
 	/// nickname of player
 	static std::string nickname;
 
@@ -371,6 +377,12 @@ public:
 	/// always use fast drawing in fast forward
 	static bool simple_drawing_fast_forward;
 
+	/**
+	 * While the view does not move, only redraw the parts of the world which have changed.
+	 * Semi-transparent window decorations may then look wrong, so it is meant for observing clients.
+	 */
+	static bool redraw_changes_only;
+
 	/// format in which date is shown
 	enum date_fmt {
 		DATE_FMT_SEASON             = 0,
@@ -462,6 +474,9 @@ public:
 	/// do autosave every month?
 	static sint32 autosave;
 
+	/// compress and write autosaves on a background thread, while the game continues
+	static bool background_autosave;
+
 
 	/**
 	 * @name Midi/sound options
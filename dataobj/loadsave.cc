@@ -21,6 +21,7 @@
 #include "../utils/simstring.h"
 
 #include "../io/rdwr/bzip2_file_rdwr_stream.h"
+#include "../io/rdwr/memory_rdwr_stream.h"
 #include "../io/rdwr/raw_file_rdwr_stream.h"
 #include "../io/rdwr/zlib_file_rdwr_stream.h"
 #if USE_ZSTD
@@ -187,6 +188,22 @@ void saving_finalize()
 	simthread_barrier_wait(&loadsave_barrier);
 }
 
+/*
+ * Background saving:
+ * a snapshot is written into memory like any other file, and then compressed and written
+ * to disk by snapshot_thread while the game continues. It does not use the buffers above,
+ * so other files can be read and written meanwhile.
+ */
+static pthread_t background_save_thread;
+static bool background_save_running = false;
+static const char *background_save_error = NULL;
+
+void *snapshot_thread( void *ptr )
+{
+	background_save_error = loadsave_t::write_snapshot( reinterpret_cast<loadsave_t::snapshot_t *>(ptr) );
+	return ptr;
+}
+
 #endif
 
 
@@ -199,7 +216,8 @@ int loadsave_t::autosave_level = 1;
 loadsave_t::loadsave_t() :
 	mode(binary),
 	buffered(false),
-	stream(NULL)
+	stream(NULL),
+	snapshot(NULL)
 {
 	curr_buff = 0;
 }
@@ -278,6 +296,7 @@ void loadsave_t::set_buffered(bool enable)
 loadsave_t::file_status_t loadsave_t::rd_open(const char *filename_utf8)
 {
 	close();
+	finish_background_save();
 
 	const file_classify_status_t cl_status = classify_file(filename_utf8, &finfo);
 
@@ -403,6 +422,7 @@ loadsave_t::file_status_t loadsave_t::wr_open( const char *filename_utf8, mode_t
 {
 	mode = m;
 	close();
+	finish_background_save();
 
 #if !USE_ZSTD
 	if( mode & zstd ) {
@@ -414,16 +434,18 @@ loadsave_t::file_status_t loadsave_t::wr_open( const char *filename_utf8, mode_t
 
 	assert(stream == NULL);
 
-	switch (mode & ~xml) {
-#if USE_ZSTD
-		case zstd: stream = new zstd_file_rdwr_stream_t(filename_utf8, true, level); break;
-#endif
-		case bzip2:  stream = new bzip2_file_rdwr_stream_t(filename_utf8, true);       break;
-		case zipped: stream = new zlib_file_rdwr_stream_t(filename_utf8, true, level); break;
-		case binary: stream = new raw_file_rdwr_stream_t(filename_utf8, true);         break;
-		default:
+	if (snapshot) {
+		// compressed later by write_snapshot()
+		snapshot->mode = mode;
+		snapshot->data = new memory_rdwr_stream_t();
+		stream = snapshot->data;
+	}
+	else {
+		stream = create_write_stream(filename_utf8, mode, level);
+		if (!stream) {
 			dbg->error("loadsave_t::wr_open", "Unsupported save file compression");
 			return FILE_STATUS_ERR_UNSUPPORTED_COMPRESSION;
+		}
 	}
 
 	if (stream->get_status() != rdwr_stream_t::STATUS_OK) {
@@ -495,6 +517,99 @@ loadsave_t::file_status_t loadsave_t::wr_open( const char *filename_utf8, mode_t
 }
 
 
+loadsave_t::file_status_t loadsave_t::wr_open_snapshot( const char *filename_utf8, const char *final_name, mode_t m, int level, const char *pak_extension,
+	const char *savegame_version, const char *savegame_version_ex, const char *savegame_revision_ex )
+{
+	close();
+
+	snapshot = new snapshot_t;
+	snapshot->filename = filename_utf8;
+	snapshot->final_name = final_name ? final_name : "";
+	snapshot->mode = m;
+	snapshot->level = level;
+	snapshot->data = NULL;
+
+	return wr_open( filename_utf8, m, level, pak_extension, savegame_version, savegame_version_ex, savegame_revision_ex );
+}
+
+
+rdwr_stream_t *loadsave_t::create_write_stream(const char *filename_utf8, int mode, int level)
+{
+	switch (mode & ~xml) {
+#if USE_ZSTD
+		case zstd:   return new zstd_file_rdwr_stream_t(filename_utf8, true, level);
+#endif
+		case bzip2:  return new bzip2_file_rdwr_stream_t(filename_utf8, true);
+		case zipped: return new zlib_file_rdwr_stream_t(filename_utf8, true, level);
+		case binary: return new raw_file_rdwr_stream_t(filename_utf8, true);
+		default:     return NULL;
+	}
+}
+
+
+const char *loadsave_t::get_status_message(rdwr_stream_t::status_t status)
+{
+	switch (status) {
+		case rdwr_stream_t::STATUS_EOF:
+		case rdwr_stream_t::STATUS_OK:                 return NULL;
+
+		case rdwr_stream_t::STATUS_ERR_CORRUPT:        return "Corrupt save file";
+		case rdwr_stream_t::STATUS_ERR_DEPRECATED:     return "Save file version too old";
+		case rdwr_stream_t::STATUS_ERR_FUTURE_VERSION: return "Save file version too new";
+		case rdwr_stream_t::STATUS_ERR_NO_VERSION:     return "Unversioned save file";
+		case rdwr_stream_t::STATUS_ERR_FULL:           return "No space left on device";
+		case rdwr_stream_t::STATUS_ERR_NOT_EXISTING:   return "File not found";
+		case rdwr_stream_t::STATUS_INVALID:            return "<Invalid status>";
+	}
+	return NULL;
+}
+
+
+const char *loadsave_t::write_snapshot(snapshot_t *snap)
+{
+	const char *errmsg = NULL;
+	rdwr_stream_t *out = create_write_stream( snap->filename.c_str(), snap->mode, snap->level );
+
+	if(  !out  ) {
+		errmsg = "Unsupported save file compression";
+	}
+	else if(  out->get_status() != rdwr_stream_t::STATUS_OK  ) {
+		errmsg = get_status_message( out->get_status() );
+	}
+	else {
+		snap->data->write_to( out );
+		errmsg = get_status_message( out->get_status() );
+	}
+	delete out;
+
+	if(  !errmsg  &&  !snap->final_name.empty()  &&  dr_rename( snap->filename.c_str(), snap->final_name.c_str() )  ) {
+		errmsg = "Cannot rename save file";
+	}
+	if(  errmsg  ) {
+		dbg->error( "loadsave_t::write_snapshot", "Could not save '%s': %s", snap->filename.c_str(), errmsg );
+	}
+
+	delete snap->data;
+	delete snap;
+	return errmsg;
+}
+
+
+const char *loadsave_t::finish_background_save()
+{
+#ifdef MULTI_THREAD
+	if(  background_save_running  ) {
+		pthread_join( background_save_thread, NULL );
+		background_save_running = false;
+		const char *errmsg = background_save_error;
+		background_save_error = NULL;
+		return errmsg;
+	}
+#endif
+	return NULL;
+}
+
+
 const char *loadsave_t::close()
 {
 	if (!stream) {
@@ -512,19 +627,27 @@ const char *loadsave_t::close()
 		set_buffered(false);
 	}
 
-	const char *errmsg = NULL;
+	const char *errmsg = get_status_message(stream->get_status());
 
-	switch (stream->get_status()) {
-		case rdwr_stream_t::STATUS_EOF:
-		case rdwr_stream_t::STATUS_OK: errmsg = NULL; break;
-
-		case rdwr_stream_t::STATUS_ERR_CORRUPT:        errmsg = "Corrupt save file";         break;
-		case rdwr_stream_t::STATUS_ERR_DEPRECATED:     errmsg = "Save file version too old"; break;
-		case rdwr_stream_t::STATUS_ERR_FUTURE_VERSION: errmsg = "Save file version too new"; break;
-		case rdwr_stream_t::STATUS_ERR_NO_VERSION:     errmsg = "Unversioned save file";     break;
-		case rdwr_stream_t::STATUS_ERR_FULL:           errmsg = "No space left on device";   break;
-		case rdwr_stream_t::STATUS_ERR_NOT_EXISTING:   errmsg = "File not found";            break;
-		case rdwr_stream_t::STATUS_INVALID:            errmsg = "<Invalid status>";          break;
+	if (snapshot) {
+		// the snapshot is complete in memory, now write it to disk
+		snapshot_t *snap = snapshot;
+		snapshot = NULL;
+		stream = NULL;
+
+		if (errmsg) {
+			delete snap->data;
+			delete snap;
+			return errmsg;
+		}
+#ifdef MULTI_THREAD
+		background_save_error = NULL;
+		background_save_running = pthread_create(&background_save_thread, NULL, snapshot_thread, snap) == 0;
+		if (background_save_running) {
+			return NULL;
+		}
+#endif
+		return write_snapshot(snap);
 	}
 
 	delete stream;
@@ -16,6 +16,7 @@
 
 
 class plainstring;
+class memory_rdwr_stream_t;
 struct file_descriptors_t;
 
 /**
@@ -68,6 +69,17 @@ protected:
 
 	rdwr_stream_t *stream;
 
+	/// Set while writing a snapshot into memory, see wr_open_snapshot()
+	struct snapshot_t
+	{
+		std::string filename;
+		std::string final_name;
+		int mode;
+		int level;
+		memory_rdwr_stream_t *data;
+	};
+	snapshot_t *snapshot;
+
 	file_descriptors_t *fd;
 
 	/// @sa putc
@@ -86,6 +98,15 @@ protected:
 
 	friend void *save_thread(void *ptr);
 	friend void *load_thread(void *ptr);
+	friend void *snapshot_thread(void *ptr);
+
+	/// Creates the stream which compresses according to @p mode
+	static rdwr_stream_t *create_write_stream(const char *filename, int mode, int level);
+
+	static const char *get_status_message(rdwr_stream_t::status_t status);
+
+	/// Compresses and writes a snapshot to its file; deletes @p snap
+	static const char *write_snapshot(snapshot_t *snap);
 
 	/**
 	* Reads into buffer number @p buf_num.
@@ -118,8 +139,20 @@ public:
 
 	file_status_t rd_open(const char *filename);
 	file_status_t wr_open(const char *filename, mode_t mode, int level, const char *pak_extension, const char *savegame_version, const char *savegame_version_ex, const char *savegame_revision_ex);
+
+	/**
+	 * Like wr_open(), but the data is only collected in memory. close() then returns at once,
+	 * while the data is compressed and written to @p filename on a background thread,
+	 * which renames it to @p final_name when done (unless it is NULL).
+	 */
+	file_status_t wr_open_snapshot(const char *filename, const char *final_name, mode_t mode, int level, const char *pak_extension, const char *savegame_version, const char *savegame_version_ex, const char *savegame_revision_ex);
+
 	const char *close();
 
+	/// Waits until the snapshot being written in the background (if any) is on disk.
+	/// @returns the error message of writing it, or NULL
+	static const char *finish_background_save();
+
 	static void set_savemode(mode_t mode) { save_mode = mode; }
 	static void set_autosavemode(mode_t mode) { autosave_mode = mode; }
 	static void set_savelevel(int level) { save_level = level;  }
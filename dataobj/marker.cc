@@ -12,6 +12,9 @@
 marker_t marker_t::the_instance;
 marker_t* marker_t::markers;
 
+// initial number of entries of the table for non-ground tiles, must be a power of two
+static const uint32 initial_more_size = 256;
+
 void marker_t::init(int world_size_x, int world_size_y)
 {
 	// do not reallocate it, if same size ...
@@ -21,13 +24,20 @@ void marker_t::init(int world_size_x, int world_size_y)
 	if( bits_length != new_bits_length  ) {
 		bits_length = new_bits_length;
 		delete [] bits;
+		delete [] word_generations;
 		if(bits_length) {
-			bits = new unsigned char[bits_length];
+			bits = new uint32[bits_length];
+			word_generations = new uint16[bits_length](); // never the current generation
 		}
 		else {
 			bits = NULL;
+			word_generations = NULL;
 		}
 	}
+	if(  more == NULL  ) {
+		more_size = initial_more_size;
+		more = new more_entry_t[more_size]();
+	}
 	unmark_all();
 }
 
@@ -54,14 +64,53 @@ marker_t& marker_t::instance(int world_size_x, int world_size_y, uint32 thread_n
 marker_t::~marker_t()
 {
 	delete [] bits;
+	delete [] word_generations;
+	delete [] more;
 }
 
 void marker_t::unmark_all()
 {
-	if(bits) {
-		MEMZERON(bits, bits_length);
+	generation++;
+	if(  generation == 0  ) {
+		// the stamps have wrapped around: clear them, so that none matches the new generation
+		if(word_generations) {
+			MEMZERON(word_generations, bits_length);
+		}
+		MEMZERON(more, more_size);
+		generation = 1;
+	}
+	more_count = 0;
+}
+
+marker_t::more_entry_t *marker_t::find_more(const grund_t *gr) const
+{
+	const uint32 mask = more_size - 1;
+	uint32 i = (uint32)(((size_t)gr >> 4) * 2654435761u) & mask;
+	while(  more[i].generation == generation  &&  more[i].gr != gr  ) {
+		i = (i + 1) & mask;
+	}
+	return more + i;
+}
+
+void marker_t::insert_more(more_entry_t *entry, const grund_t *gr)
+{
+	entry->gr = gr;
+	entry->generation = generation;
+	more_count++;
+
+	if(  more_count * 2 > more_size  ) {
+		// keep the table at most half full, so that searches stay short and always find a free entry
+		more_entry_t *const old_more = more;
+		const uint32 old_size = more_size;
+		more_size *= 2;
+		more = new more_entry_t[more_size]();
+		for(  uint32 i = 0;  i < old_size;  i++  ) {
+			if(  old_more[i].generation == generation  &&  old_more[i].gr != NULL  ) {
+				*find_more(old_more[i].gr) = old_more[i];
+			}
+		}
+		delete [] old_more;
 	}
-	more.clear();
 }
 
 void marker_t::mark(const grund_t *gr)
@@ -70,10 +119,18 @@ void marker_t::mark(const grund_t *gr)
 		if(gr->ist_karten_boden()) {
 			// ground level
 			const int bit = gr->get_pos().y*cached_size_x+gr->get_pos().x;
-			bits[bit/bit_unit] |= 1 << (bit & bit_mask);
+			const int word = bit/bit_unit;
+			if(  word_generations[word] != generation  ) {
+				word_generations[word] = generation;
+				bits[word] = 0;
+			}
+			bits[word] |= 1u << (bit & bit_mask);
 		}
 		else {
-			more.set(gr, true);
+			more_entry_t *entry = find_more(gr);
+			if(  entry->generation != generation  ) {
+				insert_more(entry, gr);
+			}
 		}
 	}
 }
@@ -84,10 +141,17 @@ void marker_t::unmark(const grund_t *gr)
 		if(gr->ist_karten_boden()) {
 			// ground level
 			const int bit = gr->get_pos().y*cached_size_x+gr->get_pos().x;
-			bits[bit/bit_unit] &= ~(1 << (bit & bit_mask));
+			const int word = bit/bit_unit;
+			if(  word_generations[word] == generation  ) {
+				bits[word] &= ~(1u << (bit & bit_mask));
+			}
 		}
 		else {
-			more.remove(gr);
+			more_entry_t *entry = find_more(gr);
+			if(  entry->generation == generation  ) {
+				// leave the entry occupied, so that searches continue past it
+				entry->gr = NULL;
+			}
 		}
 	}
 }
@@ -100,10 +164,11 @@ bool marker_t::is_marked(const grund_t *gr) const
 	if(gr->ist_karten_boden()) {
 		// ground level
 		const int bit = gr->get_pos().y*cached_size_x+gr->get_pos().x;
-		return (bits[bit/bit_unit] & (1 << (bit & bit_mask))) != 0;
+		const int word = bit/bit_unit;
+		return word_generations[word] == generation  &&  (bits[word] & (1u << (bit & bit_mask))) != 0;
 	}
 	else {
-		return more.get(gr);
+		return find_more(gr)->generation == generation;
 	}
 }
 
@@ -113,13 +178,22 @@ bool marker_t::test_and_mark(const grund_t *gr)
 		if(gr->ist_karten_boden()) {
 			// ground level
 			const int bit = gr->get_pos().y*cached_size_x+gr->get_pos().x;
-			if ((bits[bit/bit_unit] & (1 << (bit & bit_mask))) != 0) {
+			const int word = bit/bit_unit;
+			if(  word_generations[word] != generation  ) {
+				word_generations[word] = generation;
+				bits[word] = 0;
+			}
+			else if ((bits[word] & (1u << (bit & bit_mask))) != 0) {
 				return true;
 			}
-			bits[bit/bit_unit] |= 1 << (bit & bit_mask);
+			bits[word] |= 1u << (bit & bit_mask);
 		}
 		else {
-			return more.set(gr, true);
+			more_entry_t *entry = find_more(gr);
+			if(  entry->generation == generation  ) {
+				return true;
+			}
+			insert_more(entry, gr);
 		}
 	}
 	return false;
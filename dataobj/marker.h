@@ -7,7 +7,7 @@
 #define DATAOBJ_MARKER_H
 
 
-#include "../tpl/ptrhashtable_tpl.h"
+#include "../simtypes.h"
 
 #include "../utils/simthread.h"
 
@@ -16,17 +16,22 @@ class grund_t;
 /**
  * Class to mark tiles as visited during route search.
  * Singleton.
+ *
+ * Marks are stamped with a generation, which is advanced instead of clearing
+ * the whole map when a new search begins. Marks of older generations count as
+ * not marked, so that starting a search costs nothing however large the map.
  */
 class marker_t {
-	// added bit mask, because it allows a more efficient
-	// implementation (use & instead of %)
 	enum {
-		bit_unit = (8 * sizeof(unsigned char)),
-		bit_mask = (8 * sizeof(unsigned char))-1
+		bit_unit = (8 * sizeof(uint32)),
+		bit_mask = (8 * sizeof(uint32))-1
 	};
 
 	/// bit-field to mark ground tiles
-	unsigned char *bits;
+	uint32 *bits;
+
+	/// generation in which each word of the bit-field was last written
+	uint16 *word_generations;
 
 	/// length of field
 	int bits_length;
@@ -34,8 +39,29 @@ class marker_t {
 	/// bit-field is made for this x-size
 	int cached_size_x;
 
-	/// hashtable to mark non-ground tiles (bridges, tunnels)
-	ptrhashtable_tpl <const grund_t *, bool, N_BAGS_LARGE> more;
+	/// current generation of marks
+	uint16 generation;
+
+	/// entry of the table to mark non-ground tiles
+	struct more_entry_t
+	{
+		const grund_t *gr;
+		uint16 generation;
+	};
+
+	/**
+	 * Open addressing hash table to mark non-ground tiles (bridges, tunnels).
+	 * Entries of older generations are free, and the table is at most half full.
+	 */
+	more_entry_t *more;
+	uint32 more_size;
+	uint32 more_count;
+
+	/// @returns the entry holding @p gr, or the free entry where it is to be inserted
+	more_entry_t *find_more(const grund_t *gr) const;
+
+	/// inserts @p gr into the free entry @p entry found by find_more
+	void insert_more(more_entry_t *entry, const grund_t *gr);
 
 	/**
 	 * Initializes marker. Set all tiles to not marked.
@@ -52,7 +78,7 @@ public:
 	/// For running multi-threadedly
 	static marker_t* markers;
 
-	marker_t() : bits(NULL) { bits_length = 0; init(0, 0); }
+	marker_t() : bits(NULL), word_generations(NULL), generation(0), more(NULL), more_size(0), more_count(0) { bits_length = 0; init(0, 0); }
 	~marker_t();
 
 	/**
@@ -0,0 +1,647 @@
+/*
+ * This file is part of the Simutrans-Extended project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include <algorithm>
+#include <string.h>
+
+#include "private_car_routes.h"
+
+#include "loadsave.h"
+#include "ribi.h"
+#include "../simdebug.h"
+#include "../simmem.h"
+#include "../tpl/koordhashtable_tpl.h"
+#include "../utils/simthread.h"
+#include "../vehicle/simroadtraffic.h"
+
+
+uint32 private_car_routes_t::reading_element = 0;
+vector_tpl<koord3d> private_car_routes_t::changed_roads;
+vector_tpl<koord3d> private_car_routes_t::removed_roads;
+bool private_car_routes_t::too_many_road_changes = false;
+
+// beyond this number of changed roads, all routes are found again
+static const uint32 max_road_changes = 1024;
+
+
+/**
+ * The tiles from which one destination is reached. Each step holds the key of its tile above
+ * its direction bits; the first sorted_count steps are sorted and unique, the rest are appended
+ * by add() and merged into them once there are enough.
+ */
+class destination_routes_t
+{
+public:
+	destination_routes_t() : steps(NULL), count(0), capacity(0), sorted_count(0) {}
+	~destination_routes_t() { free(steps); }
+
+	destination_routes_t(const destination_routes_t &other) :
+		steps(other.count ? MALLOCN(uint64, other.count) : NULL),
+		count(other.count),
+		capacity(other.count),
+		sorted_count(other.sorted_count)
+	{
+		if(  count  ) {
+			memcpy(steps, other.steps, sizeof(uint64) * count);
+		}
+	}
+
+	/// @param replace whether the directions of @p step replace those already held for its tile
+	void add(uint64 step, uint8 direction_bits, bool replace)
+	{
+		const uint32 found = find(step >> direction_bits, direction_bits);
+		if(  found != UINT32_MAX_VALUE  ) {
+			if(  replace  ) {
+				steps[found] = step;
+			}
+			else {
+				steps[found] |= step & ((1 << direction_bits) - 1);
+			}
+			return;
+		}
+		if(  count == capacity  ) {
+			capacity = max(capacity * 2, (uint32)16);
+			steps = REALLOC(steps, uint64, capacity);
+		}
+		steps[count++] = step;
+		if(  count - sorted_count >= max(sorted_count, (uint32)64)  ) {
+			merge(direction_bits, false);
+		}
+	}
+
+	/// @returns the index of the first sorted step whose bits above @p shift are not less than @p key
+	uint32 lower_bound(uint64 key, uint8 shift) const
+	{
+		uint32 low = 0;
+		uint32 high = sorted_count;
+		while(  low < high  ) {
+			const uint32 middle = (low + high) / 2;
+			if(  (steps[middle] >> shift) < key  ) {
+				low = middle + 1;
+			}
+			else {
+				high = middle;
+			}
+		}
+		return low;
+	}
+
+	/// @returns the index of the sorted step of the tile @p key, or UINT32_MAX_VALUE
+	uint32 find(uint64 key, uint8 direction_bits) const
+	{
+		const uint32 found = lower_bound(key, direction_bits);
+		return found < sorted_count  &&  (steps[found] >> direction_bits) == key ? found : UINT32_MAX_VALUE;
+	}
+
+	/**
+	 * Removes the tiles @p keys, then the directions which lead into removed tiles, until no more
+	 * tiles lose all their directions. All steps must be merged.
+	 */
+	void prune(const vector_tpl<uint64> &keys, uint8 direction_bits)
+	{
+		const uint64 direction_mask = (1 << direction_bits) - 1;
+		vector_tpl<uint64> removed;
+		FOR(vector_tpl<uint64>, key, keys) {
+			const uint32 found = find(key, direction_bits);
+			if(  found != UINT32_MAX_VALUE  &&  (steps[found] & direction_mask)  ) {
+				steps[found] &= ~direction_mask;
+				removed.append(key);
+			}
+		}
+		if(  removed.empty()  ) {
+			return;
+		}
+
+		while(  !removed.empty()  ) {
+			const uint64 key = removed.pop_back();
+			const koord pos((sint16)(key >> 24), (sint16)(key >> 8));
+			for(  uint8 d = 0;  d < 4;  d++  ) {
+				// the tiles (on any level) from which direction d leads here
+				const koord from = pos - koord::nesw[d];
+				const uint64 tile = ((uint64)(uint16)from.x << 16) | (uint16)from.y;
+				for(  uint32 i = lower_bound(tile, direction_bits + 8);  i < sorted_count  &&  (steps[i] >> (direction_bits + 8)) == tile;  i++  ) {
+					if(  steps[i] & (1 << d)  ) {
+						steps[i] &= ~(uint64)(1 << d);
+						if(  (steps[i] & direction_mask) == 0  ) {
+							removed.append(steps[i] >> direction_bits);
+						}
+					}
+				}
+			}
+		}
+
+		uint32 kept = 0;
+		for(  uint32 i = 0;  i < count;  i++  ) {
+			if(  steps[i] & direction_mask  ) {
+				steps[kept++] = steps[i];
+			}
+		}
+		count = kept;
+		sorted_count = kept;
+	}
+
+	/// Sorts all steps and combines those of the same tile; @p shrink releases the unused capacity.
+	void merge(uint8 direction_bits, bool shrink)
+	{
+		if(  sorted_count < count  ) {
+			std::sort(steps, steps + count);
+			uint32 merged = 0;
+			for(  uint32 i = 1;  i < count;  i++  ) {
+				if(  (steps[i] >> direction_bits) == (steps[merged] >> direction_bits)  ) {
+					steps[merged] |= steps[i];
+				}
+				else {
+					steps[++merged] = steps[i];
+				}
+			}
+			count = merged + 1;
+			sorted_count = count;
+		}
+		if(  shrink  &&  capacity > count  ) {
+			capacity = count;
+			steps = REALLOC(steps, uint64, capacity);
+		}
+	}
+
+	uint64 *steps;
+	uint32 count;
+	uint32 capacity;
+	uint32 sorted_count;
+};
+
+
+/**
+ * One set of routes: the tables of all destinations, divided into stripes by the y coordinate
+ * of the destination, so that the hash bags of a stripe (chosen by x) are all used.
+ */
+class route_table_set_t
+{
+public:
+	enum { stripes = 64 };
+
+	typedef koordhashtable_tpl<koord, destination_routes_t*, 256> table_t;
+
+	route_table_set_t()
+	{
+#ifdef MULTI_THREAD
+		for(  uint32 i = 0;  i < stripes;  i++  ) {
+			pthread_mutex_init(&mutexes[i], NULL);
+		}
+#endif
+	}
+
+	~route_table_set_t()
+	{
+		clear();
+#ifdef MULTI_THREAD
+		for(  uint32 i = 0;  i < stripes;  i++  ) {
+			pthread_mutex_destroy(&mutexes[i]);
+		}
+#endif
+	}
+
+	static uint32 get_stripe(koord destination) { return (uint16)destination.y % stripes; }
+
+	void add(koord destination, const uint64 *steps, uint32 count, uint8 direction_bits, bool replace = false)
+	{
+		const uint32 stripe = get_stripe(destination);
+#ifdef MULTI_THREAD
+		pthread_mutex_lock(&mutexes[stripe]);
+#endif
+		destination_routes_t *routes = tables[stripe].get(destination);
+		if(  routes == NULL  ) {
+			routes = new destination_routes_t();
+			tables[stripe].put(destination, routes);
+		}
+		for(  uint32 i = 0;  i < count;  i++  ) {
+			routes->add(steps[i], direction_bits, replace);
+		}
+#ifdef MULTI_THREAD
+		pthread_mutex_unlock(&mutexes[stripe]);
+#endif
+	}
+
+	const destination_routes_t *get(koord destination) const
+	{
+		return tables[get_stripe(destination)].get(destination);
+	}
+
+	/// Sorts and compacts all tables, so that they can be searched without locking.
+	void merge_all(uint8 direction_bits)
+	{
+		for(  uint32 i = 0;  i < stripes;  i++  ) {
+			FOR(table_t, const& entry, tables[i]) {
+				entry.value->merge(direction_bits, true);
+			}
+		}
+	}
+
+	void clear()
+	{
+		for(  uint32 i = 0;  i < stripes;  i++  ) {
+			FOR(table_t, const& entry, tables[i]) {
+				delete entry.value;
+			}
+			tables[i].clear();
+		}
+	}
+
+	void copy_from(const route_table_set_t &other)
+	{
+		clear();
+		for(  uint32 i = 0;  i < stripes;  i++  ) {
+			FOR(table_t, const& entry, other.tables[i]) {
+				tables[i].put(entry.key, new destination_routes_t(*entry.value));
+			}
+		}
+	}
+
+	/// Cuts the branches which lead through the tiles @p keys from all tables, which must be merged.
+	void prune(const vector_tpl<uint64> &keys, uint8 direction_bits)
+	{
+		for(  uint32 i = 0;  i < stripes;  i++  ) {
+			vector_tpl<koord> emptied;
+			FOR(table_t, const& entry, tables[i]) {
+				entry.value->prune(keys, direction_bits);
+				if(  entry.value->count == 0  ) {
+					emptied.append(entry.key);
+				}
+			}
+			FOR(vector_tpl<koord>, const& destination, emptied) {
+				delete tables[i].remove(destination);
+			}
+		}
+	}
+
+	/// The tables in the order of their destinations, which is the same on all clients.
+	void get_sorted(vector_tpl<koord> &destinations) const
+	{
+		for(  uint32 i = 0;  i < stripes;  i++  ) {
+			FOR(table_t, const& entry, tables[i]) {
+				destinations.append(entry.key);
+			}
+		}
+		std::sort(destinations.begin(), destinations.end(), [](const koord &a, const koord &b) {
+			return a.y < b.y  ||  (a.y == b.y  &&  a.x < b.x);
+		});
+	}
+
+	void rdwr(loadsave_t *file, uint8 direction_bits)
+	{
+		if(  file->is_saving()  ) {
+			merge_all(direction_bits);
+			vector_tpl<koord> destinations;
+			get_sorted(destinations);
+			uint32 destination_count = destinations.get_count();
+			file->rdwr_long(destination_count);
+			FOR(vector_tpl<koord>, destination, destinations) {
+				const destination_routes_t *routes = get(destination);
+				destination.rdwr(file);
+				uint32 count = routes->count;
+				file->rdwr_long(count);
+				for(  uint32 i = 0;  i < count;  i++  ) {
+					sint64 step = (sint64)routes->steps[i];
+					file->rdwr_longlong(step);
+				}
+			}
+		}
+		else {
+			clear();
+			uint32 destination_count = 0;
+			file->rdwr_long(destination_count);
+			for(  uint32 j = 0;  j < destination_count;  j++  ) {
+				koord destination;
+				destination.rdwr(file);
+				uint32 count = 0;
+				file->rdwr_long(count);
+				destination_routes_t *routes = new destination_routes_t();
+				routes->capacity = count;
+				routes->steps = count ? MALLOCN(uint64, count) : NULL;
+				for(  uint32 i = 0;  i < count;  i++  ) {
+					sint64 step = 0;
+					file->rdwr_longlong(step);
+					routes->steps[i] = (uint64)step;
+				}
+				routes->count = count;
+				routes->sorted_count = count;
+				tables[get_stripe(destination)].put(destination, routes);
+			}
+		}
+	}
+
+	table_t tables[stripes];
+
+private:
+#ifdef MULTI_THREAD
+	pthread_mutex_t mutexes[stripes];
+#endif
+};
+
+
+static route_table_set_t route_sets[2];
+
+// During an update, the routes of the cities checked again. They replace the directions which the
+// writing set holds for their tiles when the sets are swapped, as the old directions together with
+// the new ones could lead round in circles.
+static route_table_set_t updated_routes;
+static bool updating = false;
+
+
+// Games saved before 14.43 may share one list of destinations between several ways and
+// directions. These are resolved once all ways have been read.
+struct legacy_link_t
+{
+	koord3d pos;
+	uint8 direction;
+	uint32 idx;
+};
+
+static vector_tpl<legacy_link_t> legacy_links[2];
+static vector_tpl<vector_tpl<koord> > legacy_route_maps[2];
+
+// the link mode of a legacy list which holds the destinations
+static const uint8 legacy_link_mode_master = 5;
+
+
+uint8 private_car_routes_t::get_direction_index(const koord3d &pos, const koord3d &next_tile)
+{
+	if(  next_tile != koord3d::invalid  ) {
+		const ribi_t::ribi dir = ribi_type(pos, next_tile);
+		for(  uint8 j = 0;  j < 4;  j++  ) {
+			if(  dir == ribi_t::nesw[j]  ) {
+				return j;
+			}
+		}
+	}
+	return 4;
+}
+
+
+void private_car_routes_t::add_route(koord destination, const vector_tpl<uint64> &steps)
+{
+	if(  !steps.empty()  ) {
+		route_table_set_t &set = updating ? updated_routes : route_sets[1 - reading_element];
+		set.add(destination, steps.begin(), steps.get_count(), direction_bits);
+	}
+}
+
+
+uint8 private_car_routes_t::get_directions(koord destination, const koord3d &pos)
+{
+	const destination_routes_t *routes = route_sets[reading_element].get(destination);
+	if(  routes == NULL  ) {
+		return 0;
+	}
+	const uint32 found = routes->find(get_key(pos), direction_bits);
+	return found == UINT32_MAX_VALUE ? 0 : (uint8)(routes->steps[found] & ((1 << direction_bits) - 1));
+}
+
+
+void private_car_routes_t::get_destinations(const koord3d &pos, vector_tpl<koord> &destinations)
+{
+	const route_table_set_t &set = route_sets[reading_element];
+	const uint64 key = get_key(pos);
+	vector_tpl<koord> all_destinations;
+	set.get_sorted(all_destinations);
+	FOR(vector_tpl<koord>, destination, all_destinations) {
+		if(  set.get(destination)->find(key, direction_bits) != UINT32_MAX_VALUE  ) {
+			destinations.append(destination);
+		}
+	}
+}
+
+
+void private_car_routes_t::swap()
+{
+	route_table_set_t &writing_set = route_sets[1 - reading_element];
+	if(  updating  ) {
+		updated_routes.merge_all(direction_bits);
+		vector_tpl<koord> destinations;
+		updated_routes.get_sorted(destinations);
+		FOR(vector_tpl<koord>, destination, destinations) {
+			const destination_routes_t *routes = updated_routes.get(destination);
+			writing_set.add(destination, routes->steps, routes->count, direction_bits, true);
+		}
+		updated_routes.clear();
+		updating = false;
+	}
+	writing_set.merge_all(direction_bits);
+	reading_element = 1 - reading_element;
+	route_sets[1 - reading_element].clear();
+}
+
+
+void private_car_routes_t::reset()
+{
+	route_sets[0].clear();
+	route_sets[1].clear();
+	reading_element = 0;
+	begin_full_refresh();
+	for(  uint32 i = 0;  i < 2;  i++  ) {
+		legacy_links[i].clear();
+		legacy_route_maps[i].clear();
+	}
+}
+
+
+void private_car_routes_t::set_road_changed(const koord3d &pos, bool removed)
+{
+	if(  too_many_road_changes  ) {
+		return;
+	}
+	if(  changed_roads.get_count() >= max_road_changes  ) {
+		too_many_road_changes = true;
+		changed_roads.clear();
+		removed_roads.clear();
+		return;
+	}
+	changed_roads.append_unique(pos);
+	if(  removed  ) {
+		removed_roads.append_unique(pos);
+	}
+}
+
+
+void private_car_routes_t::begin_update(vector_tpl<koord3d> &changed_tiles)
+{
+	route_table_set_t &writing_set = route_sets[1 - reading_element];
+	writing_set.copy_from(route_sets[reading_element]);
+
+	vector_tpl<uint64> removed_keys(removed_roads.get_count());
+	FOR(vector_tpl<koord3d>, const& pos, removed_roads) {
+		removed_keys.append(get_key(pos));
+	}
+	if(  !removed_keys.empty()  ) {
+		writing_set.prune(removed_keys, direction_bits);
+	}
+
+	FOR(vector_tpl<koord3d>, const& pos, changed_roads) {
+		changed_tiles.append(pos);
+	}
+	begin_full_refresh();
+	updating = true;
+}
+
+
+void private_car_routes_t::begin_full_refresh()
+{
+	updated_routes.clear();
+	updating = false;
+	changed_roads.clear();
+	removed_roads.clear();
+	too_many_road_changes = false;
+}
+
+
+void private_car_routes_t::rdwr(loadsave_t *file)
+{
+	if(  file->get_extended_version() >= 15  ||  (file->get_extended_version() == 14  &&  file->get_extended_revision() >= 20)  ) {
+		file->rdwr_long(reading_element);
+		if(  reading_element > 1  ) {
+			dbg->error("private_car_routes_t::rdwr()", "Invalid reading set %u", reading_element);
+			reading_element = 0;
+		}
+	}
+
+	if(  file->is_version_ex_atleast(14, 43)  ) {
+		route_sets[0].rdwr(file, direction_bits);
+		route_sets[1].rdwr(file, direction_bits);
+	}
+	else if(  file->is_loading()  ) {
+		finish_legacy_loading();
+	}
+
+	if(  file->is_version_ex_atleast(14, 45)  ) {
+		// the roads changed since the current update began, so that the next one checks the same cities
+		file->rdwr_bool(too_many_road_changes);
+		for(  uint32 i = 0;  i < 2;  i++  ) {
+			vector_tpl<koord3d> &roads = i == 0 ? changed_roads : removed_roads;
+			uint32 count = roads.get_count();
+			file->rdwr_long(count);
+			if(  file->is_loading()  ) {
+				roads.clear();
+				roads.resize(count);
+			}
+			for(  uint32 j = 0;  j < count;  j++  ) {
+				koord3d pos = file->is_saving() ? roads[j] : koord3d::invalid;
+				pos.rdwr(file);
+				if(  file->is_loading()  ) {
+					roads.append(pos);
+				}
+			}
+		}
+		// the routes found so far by the current update
+		file->rdwr_bool(updating);
+		updated_routes.rdwr(file, direction_bits);
+	}
+	else if(  file->is_loading()  ) {
+		// the ways have just been built
+		begin_full_refresh();
+	}
+}
+
+
+void private_car_routes_t::rdwr_legacy_way(loadsave_t *file, const koord3d &pos)
+{
+	const uint32 route_array_number = file->get_extended_version() >= 15 || file->get_extended_revision() >= 20 ? 2 : 1;
+	for(  uint32 i = 0;  i < route_array_number;  i++  ) {
+		// Unfortunately, the way private car routes were stored changed a number of times in an effort to save memory.
+		if(  file->is_version_ex_less(14, 37)  ) {
+			uint32 private_car_routes_count = 0;
+			file->rdwr_long(private_car_routes_count);
+			for(  uint32 j = 0;  j < private_car_routes_count;  j++  ) {
+				koord destination;
+				destination.rdwr(file);
+				koord3d next_tile;
+				if(  file->is_version_ex_less(14, 33)  ) {
+					// Koord3d representation
+					next_tile.rdwr(file);
+				}
+				else {
+					// Integer-neighbour representation
+					uint8 next_tile_neighbour;
+					file->rdwr_byte(next_tile_neighbour);
+					next_tile = private_car_t::neighbour_from_int(pos, next_tile_neighbour);
+				}
+				const uint64 step = get_step(pos, get_direction_index(pos, next_tile));
+				route_sets[i].add(destination, &step, 1, direction_bits);
+			}
+		}
+		else {
+			// Container membership representation
+			for(  uint8 j = 0;  j < 5;  j++  ) {
+				// Correct for nsew->nesw change
+				const uint8 direction = file->is_version_ex_less(14, 39)  &&  (j == 1  ||  j == 2) ? 3 - j : j;
+				rdwr_legacy_route_map(file, i, pos, direction);
+			}
+		}
+	}
+}
+
+
+void private_car_routes_t::rdwr_legacy_route_map(loadsave_t *file, uint32 element, const koord3d &pos, uint8 direction)
+{
+	uint32 count = 0;
+	file->rdwr_long(count);
+	if(  count == 0  ) {
+		return;
+	}
+
+	const uint64 step = get_step(pos, direction);
+	koord destination;
+	destination.rdwr(file);
+	if(  count == 1  ) {
+		route_sets[element].add(destination, &step, 1, direction_bits);
+		return;
+	}
+
+	koord second;
+	second.rdwr(file);
+	if(  destination.x == -2  ) {
+		// negative coordinates hold the index of a shared list and the link mode
+		legacy_link_t link;
+		link.pos = pos;
+		link.direction = direction;
+		link.idx = (uint32(static_cast<uint16>(destination.y)) << 16) | uint32(static_cast<uint16>(second.y));
+		legacy_links[element].append(link);
+		if(  (uint8)(-1 - second.x) == legacy_link_mode_master  ) {
+			vector_tpl<koord> destinations(count - 2);
+			for(  uint32 k = 2;  k < count;  k++  ) {
+				koord dest;
+				dest.rdwr(file);
+				destinations.append(dest);
+			}
+			legacy_route_maps[element].store_at(link.idx, destinations);
+		}
+	}
+	else {
+		// older file, just a list of destinations
+		route_sets[element].add(destination, &step, 1, direction_bits);
+		route_sets[element].add(second, &step, 1, direction_bits);
+		for(  uint32 k = 2;  k < count;  k++  ) {
+			koord dest;
+			dest.rdwr(file);
+			route_sets[element].add(dest, &step, 1, direction_bits);
+		}
+	}
+}
+
+
+void private_car_routes_t::finish_legacy_loading()
+{
+	for(  uint32 i = 0;  i < 2;  i++  ) {
+		FOR(vector_tpl<legacy_link_t>, const& link, legacy_links[i]) {
+			if(  link.idx < legacy_route_maps[i].get_count()  ) {
+				const uint64 step = get_step(link.pos, link.direction);
+				FOR(vector_tpl<koord>, const& destination, legacy_route_maps[i][link.idx]) {
+					route_sets[i].add(destination, &step, 1, direction_bits);
+				}
+			}
+		}
+		legacy_links[i].clear();
+		legacy_route_maps[i].clear();
+		route_sets[i].merge_all(direction_bits);
+	}
+}
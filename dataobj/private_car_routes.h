@@ -0,0 +1,118 @@
+/*
+ * This file is part of the Simutrans-Extended project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef DATAOBJ_PRIVATE_CAR_ROUTES_H
+#define DATAOBJ_PRIVATE_CAR_ROUTES_H
+
+
+#include "../simtypes.h"
+#include "koord.h"
+#include "koord3d.h"
+#include "../tpl/vector_tpl.h"
+
+class loadsave_t;
+
+/**
+ * The routes which private cars follow, as a table of next hops for each destination.
+ *
+ * A destination is the road tile of a building, an industry or a town hall. For each
+ * destination, the road tiles from which it is reached are kept in one array sorted by tile,
+ * each entry holding the directions in which to leave that tile towards the destination.
+ * A car thus finds its next hop with a hash lookup of the destination and a binary search
+ * for its tile. Since routes to a destination converge, each tile is stored once per
+ * destination however many cities route through it.
+ *
+ * There are two sets of tables: the reading set, which the cars follow, and the writing set,
+ * to which stadt_t::check_all_private_car_routes adds the routes found for each city. When all
+ * cities have been checked, the writing set becomes the reading set and a new one is begun.
+ * The writing set is divided by destination into stripes, each with its own mutex, so that the
+ * city threads only wait for each other when they add routes to destinations of the same stripe.
+ *
+ * Between full refreshes, only the cities whose routes may be affected by changed roads are
+ * checked again. Their new routes are kept apart until all of them are checked. They then
+ * replace the directions of their tiles in a copy of the reading set, from which the branches
+ * leading through removed roads have been cut.
+ */
+class private_car_routes_t
+{
+public:
+	/// The direction index of the hop from @p pos to @p next_tile: 0-3 for ribi_t::nesw, 4 if the destination is reached at @p pos
+	static uint8 get_direction_index(const koord3d &pos, const koord3d &next_tile);
+
+	/// @returns the route step leaving @p pos in direction index @p direction, as passed to add_route()
+	static inline uint64 get_step(const koord3d &pos, uint8 direction)
+	{
+		return (get_key(pos) << direction_bits) | (uint64)(1 << direction);
+	}
+
+	/// Adds the route of @p steps towards @p destination to the writing set. Thread safe.
+	static void add_route(koord destination, const vector_tpl<uint64> &steps);
+
+	/// @returns the directions to leave @p pos towards @p destination in the reading set, as bit i for direction index i
+	static uint8 get_directions(koord destination, const koord3d &pos);
+
+	/// Appends all destinations which are reached from @p pos in the reading set to @p destinations
+	static void get_destinations(const koord3d &pos, vector_tpl<koord> &destinations);
+
+	/// The writing set, with the routes of an update, becomes the reading set, and an empty writing set is begun. The city threads must be suspended.
+	static void swap();
+
+	/// Discards all routes, for a new or loaded world.
+	static void reset();
+
+	/**
+	 * The road at @p pos has been built or connected, or (if @p removed) removed or disconnected.
+	 * Called from the single threaded parts of the game.
+	 */
+	static void set_road_changed(const koord3d &pos, bool removed);
+
+	static bool has_road_changes() { return !changed_roads.empty()  ||  too_many_road_changes; }
+
+	/// Whether so many roads have changed that all routes should be found again.
+	static bool has_too_many_road_changes() { return too_many_road_changes; }
+
+	/**
+	 * Begins to update the routes after roads have changed: the writing set becomes a copy of the
+	 * reading set, without the branches which lead through removed roads. The changed tiles are
+	 * moved to @p changed_tiles, so that the cities whose routes they may affect are checked again.
+	 * The city threads must be suspended.
+	 */
+	static void begin_update(vector_tpl<koord3d> &changed_tiles);
+
+	/// Begins to find all routes again, into the empty writing set left by swap(). Ends an update.
+	static void begin_full_refresh();
+
+	static uint32 get_reading_element() { return reading_element; }
+
+	static void rdwr(loadsave_t *file);
+
+	/**
+	 * Before 14.43, the routes were saved with each way. This reads the routes of the way at
+	 * @p pos from such a game, which are moved into the tables when rdwr() is reached.
+	 * When saving in such a version, no routes are written and they are found again after loading.
+	 */
+	static void rdwr_legacy_way(loadsave_t *file, const koord3d &pos);
+
+private:
+	enum { direction_bits = 5 };
+
+	static inline uint64 get_key(const koord3d &pos)
+	{
+		return ((uint64)(uint16)pos.x << 24) | ((uint64)(uint16)pos.y << 8) | (uint8)pos.z;
+	}
+
+	// index of the set which the cars read; the other one is written
+	static uint32 reading_element;
+
+	// roads changed since the current update began; removed_roads is a subset of changed_roads
+	static vector_tpl<koord3d> changed_roads;
+	static vector_tpl<koord3d> removed_roads;
+	static bool too_many_road_changes;
+
+	static void rdwr_legacy_route_map(loadsave_t *file, uint32 element, const koord3d &pos, uint8 direction);
+	static void finish_legacy_loading();
+};
+
+#endif
@@ -17,6 +17,8 @@
 #include "../boden/grund.h"
 #include "../boden/wasser.h"
 #include "../dataobj/marker.h"
+#include "../dataobj/route_landmarks.h"
+#include "../dataobj/private_car_routes.h"
 #include "../ifc/simtestdriver.h"
 #include "loadsave.h"
 #include "route.h"
@@ -125,6 +127,7 @@ thread_local uint32 route_t::MAX_STEP=0;
 thread_local uint32 route_t::max_used_steps=0;
 thread_local route_t::ANode *route_t::_nodes[MAX_NODES_ARRAY];
 thread_local bool route_t::_nodes_in_use[MAX_NODES_ARRAY]; // semaphores, since we only have few nodes arrays in memory
+thread_local binary_heap_tpl<route_t::ANode *> *route_t::_queues[MAX_NODES_ARRAY];
 
 void route_t::INIT_NODES(uint32 max_route_steps, const koord &world_size)
 {
@@ -132,6 +135,10 @@ void route_t::INIT_NODES(uint32 max_route_steps, const koord &world_size)
 	{
 		_nodes[i] = NULL;
 		_nodes_in_use[i] = false;
+		if (!_queues[i])
+		{
+			_queues[i] = new binary_heap_tpl<ANode *>();
+		}
 	}
 
 	// may need very much memory => configurable
@@ -153,6 +160,8 @@ void route_t::TERM_NODES(void *)
 			delete [] _nodes[i];
 			_nodes[i] = NULL;
 			_nodes_in_use[i] = false;
+			delete _queues[i];
+			_queues[i] = NULL;
 		}
 	}
 }
@@ -177,6 +186,13 @@ void route_t::RELEASE_NODES(uint8 nodes_index)
 	_nodes_in_use[nodes_index] = false;
 }
 
+binary_heap_tpl<route_t::ANode *> &route_t::GET_QUEUE(uint8 nodes_index)
+{
+	binary_heap_tpl<ANode *> &queue = *_queues[nodes_index];
+	queue.clear();
+	return queue;
+}
+
 /**
  * find the route to an unknown location
  */
@@ -204,11 +220,6 @@ bool route_t::find_route(karte_t *welt, const koord3d start, test_driver_t *tdri
 	// nothing in lists
 	marker_t& marker = marker_t::instance(welt->get_size().x, welt->get_size().y, karte_t::marker_index);
 
-	binary_heap_tpl <ANode *> queue;
-
-	// nothing in lists
-	queue.clear();
-
 	// we clear it here probably twice: does not hurt ...
 	route.clear();
 
@@ -221,6 +232,9 @@ bool route_t::find_route(karte_t *welt, const koord3d start, test_driver_t *tdri
 	ANode *nodes;
 	uint8 ni = GET_NODES(&nodes);
 
+	// nothing in lists
+	binary_heap_tpl <ANode *> &queue = GET_QUEUE(ni);
+
 #ifdef USE_VALGRIND_MEMCHECK
 	VALGRIND_MAKE_MEM_UNDEFINED(nodes, sizeof(ANode)*MAX_STEP);
 #endif
@@ -250,6 +264,9 @@ bool route_t::find_route(karte_t *welt, const koord3d start, test_driver_t *tdri
 	const stadt_t* current_city;
 	stadt_t* origin_city = NULL;
 	bool reached_target = false;
+	// the area explored from the origin city, so that changed roads outside it need not re-check the city
+	koord explored_min = koord(SHRT_MAX, SHRT_MAX);
+	koord explored_max = koord(SHRT_MIN, SHRT_MIN);
 
 	if (flags == private_car_checker)
 	{
@@ -284,6 +301,15 @@ bool route_t::find_route(karte_t *welt, const koord3d start, test_driver_t *tdri
 		gr = tmp->gr;
 		marker.mark(gr);
 
+		if (origin_city)
+		{
+			const koord k = gr->get_pos().get_2d();
+			explored_min.x = min(explored_min.x, k.x);
+			explored_min.y = min(explored_min.y, k.y);
+			explored_max.x = max(explored_max.x, k.x);
+			explored_max.y = max(explored_max.y, k.y);
+		}
+
 		// already there
 		if(tdriver->is_target(gr, tmp->parent == NULL ? NULL : tmp->parent->gr))
 		{
@@ -484,36 +510,17 @@ bool route_t::find_route(karte_t *welt, const koord3d start, test_driver_t *tdri
 				}
 
 				koord3d previous = koord3d::invalid;
-				weg_t* w;
 				if(fresh_destination && tmp != NULL){
-					weg_t::private_car_backtrace_begin();
+					// The route is iterated here *backwards*, and added to the set of routes
+					// which is not currently being read.
+					vector_tpl<uint64> steps;
 					while (fresh_destination && tmp != NULL)
 					{
 						private_car_route_step_counter++;
-						w = tmp->gr->get_weg(road_wt);
-
-						if (w)
+						if (tmp->gr->get_weg(road_wt))
 						{
-							// The route is added here in a different array index to the set of routes
-							// that are currently being read.
-
-							// Also, the route is iterated here *backwards*.
-
-							if (industry_destination_pos != koord::invalid)
-							{
-								w->private_car_backtrace_add(industry_destination_pos, previous);
-							}
-
-							if (attraction_destination_pos != koord::invalid)
-							{
-								w->private_car_backtrace_add(attraction_destination_pos, previous);
-							}
-
-							if (city_destination_pos != koord::invalid)
-							{
-								w->private_car_backtrace_add(city_destination_pos, previous);
-							}
-							w->private_car_backtrace_inc(previous);
+							const koord3d pos = tmp->gr->get_pos();
+							steps.append(private_car_routes_t::get_step(pos, private_car_routes_t::get_direction_index(pos, previous)));
 						}
 
 						// Old route storage - we probably no longer need this.
@@ -522,7 +529,21 @@ bool route_t::find_route(karte_t *welt, const koord3d start, test_driver_t *tdri
 						previous = tmp->gr->get_pos();
 						tmp = tmp->parent;
 					}
-					weg_t::private_car_backtrace_end();
+
+					if (industry_destination_pos != koord::invalid)
+					{
+						private_car_routes_t::add_route(industry_destination_pos, steps);
+					}
+
+					if (attraction_destination_pos != koord::invalid)
+					{
+						private_car_routes_t::add_route(attraction_destination_pos, steps);
+					}
+
+					if (city_destination_pos != koord::invalid)
+					{
+						private_car_routes_t::add_route(city_destination_pos, steps);
+					}
 				}
 #ifdef MULTI_THREAD
 				uint32 max_steps;
@@ -718,6 +739,7 @@ bool route_t::find_route(karte_t *welt, const koord3d start, test_driver_t *tdri
 	}
 	if (origin_city)
 	{
+		origin_city->set_private_car_route_area(explored_min, explored_max);
 		origin_city->set_private_car_route_finding_in_progress(false);
 	}
 	RELEASE_NODES(ni);
@@ -783,6 +805,13 @@ route_t::route_result_t route_t::intern_calc_route(karte_t *welt, const koord3d
 	const bool use_jps     = tdriver->get_waytype()==water_wt;
 	//const bool use_jps     = false;
 
+	// Where the ways must detour, the landmarks give a much better estimate of the distance left than the straight line.
+	const route_landmarks_t *landmarks = route_landmarks_t::get_landmarks(wegtyp);
+	const uint32 landmark_ziel = landmarks ? landmarks->find_node(ziel) : UINT32_MAX_VALUE;
+	if(  landmark_ziel == UINT32_MAX_VALUE  ) {
+		landmarks = NULL;
+	}
+
 	bool ziel_erreicht=false;
 
 	// memory in static list ...
@@ -791,10 +820,9 @@ route_t::route_result_t route_t::intern_calc_route(karte_t *welt, const koord3d
 		INIT_NODES(welt->get_settings().get_max_route_steps(), welt->get_size());
 	}
 
-	binary_heap_tpl <ANode *> queue;
-
 	ANode *nodes;
 	uint8 ni = GET_NODES(&nodes);
+	binary_heap_tpl <ANode *> &queue = GET_QUEUE(ni);
 
 #ifdef USE_VALGRIND_MEMCHECK
 	VALGRIND_MAKE_MEM_UNDEFINED(nodes, sizeof(ANode)*MAX_STEP);
@@ -821,8 +849,6 @@ route_t::route_result_t route_t::intern_calc_route(karte_t *welt, const koord3d
 	const grund_t* avoid_ground = welt->lookup(avoid_tile);
 	marker.mark(avoid_ground);
 
-	// clear the queue (should be empty anyhow)
-	queue.clear();
 	queue.insert(tmp);
 	ANode* new_top = NULL;
 
@@ -1083,7 +1109,15 @@ route_t::route_result_t route_t::intern_calc_route(karte_t *welt, const koord3d
 					costup = cost_upslope * max(ziel.z - to->get_vmove(next_ribi[r]), 0);
 				}
 
-				const uint32 new_f = (new_g + dist + turns * 3 + costup) * 10;
+				uint32 heuristic = dist;
+				if(  landmarks  ) {
+					const uint32 node = landmarks->find_node(to->get_pos());
+					if(  node != UINT32_MAX_VALUE  ) {
+						heuristic = max(heuristic, landmarks->get_lower_bound(node, landmark_ziel));
+					}
+				}
+
+				const uint32 new_f = (new_g + heuristic + turns * 3 + costup) * 10;
 
 				// add new
 				ANode* k = &nodes[step];
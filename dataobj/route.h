@@ -18,6 +18,7 @@
 class karte_t;
 class test_driver_t;
 class grund_t;
+template <class T> class binary_heap_tpl;
 
 /**
  * Route, e.g. for vehicles
@@ -87,12 +88,16 @@ private:
 	static const uint8 MAX_NODES_ARRAY = 2;
 	static thread_local ANode *_nodes[MAX_NODES_ARRAY];
 	static thread_local bool _nodes_in_use[MAX_NODES_ARRAY]; // semaphores, since we only have few nodes arrays in memory
+	// open lists belonging to the nodes arrays, kept so that their memory is reused from one search to the next
+	static thread_local binary_heap_tpl<ANode *> *_queues[MAX_NODES_ARRAY];
 public:
 	static thread_local uint32 MAX_STEP;
 	static thread_local uint32 max_used_steps;
 	static void INIT_NODES(uint32 max_route_steps, const koord &world_size);
 	static uint8 GET_NODES(ANode **nodes);
 	static void RELEASE_NODES(uint8 nodes_index);
+	/// @returns the empty open list for the nodes array obtained by GET_NODES
+	static binary_heap_tpl<ANode *> &GET_QUEUE(uint8 nodes_index);
 	static void TERM_NODES(void* args = NULL);
 
 	static bool suspend_private_car_routing;
@@ -0,0 +1,251 @@
+/*
+ * This file is part of the Simutrans-Extended project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include "route_landmarks.h"
+
+#include "../simworld.h"
+#include "../simdebug.h"
+#include "../boden/grund.h"
+#include "../boden/wege/weg.h"
+#include "../sys/simsys.h"
+#include "ribi.h"
+
+#include <algorithm>
+
+
+route_landmarks_t *route_landmarks_t::networks[MAX_NETWORKS];
+volatile bool route_landmarks_t::network_changed[MAX_NETWORKS];
+bool route_landmarks_t::network_dirty[MAX_NETWORKS];
+sint64 route_landmarks_t::network_dirty_since[MAX_NETWORKS];
+
+// a network is rebuilt once it has been changed for this fraction of a month (as a shift)
+static const uint32 rebuild_delay_shift = 5;
+
+
+sint8 route_landmarks_t::get_network(waytype_t wt)
+{
+	switch(  wt  ) {
+		case road_wt:        return network_road;
+		case track_wt:       return network_track;
+		case tram_wt:        return network_track; // trams run on a subset of the tracks
+		case monorail_wt:    return network_monorail;
+		case maglev_wt:      return network_maglev;
+		case narrowgauge_wt: return network_narrowgauge;
+		default:             return -1;
+	}
+}
+
+
+static const waytype_t network_waytype[] = { road_wt, track_wt, monorail_wt, maglev_wt, narrowgauge_wt };
+
+
+const route_landmarks_t *route_landmarks_t::get_landmarks(waytype_t wt)
+{
+	const sint8 network = get_network(wt);
+	if(  network < 0  ||  networks[network] == NULL  ||  networks[network]->landmark_count == 0  ) {
+		return NULL;
+	}
+	return networks[network];
+}
+
+
+void route_landmarks_t::set_network_changed(waytype_t wt)
+{
+	const sint8 network = get_network(wt);
+	if(  network >= 0  ) {
+		network_changed[network] = true;
+	}
+}
+
+
+void route_landmarks_t::reset()
+{
+	for(  int i = 0;  i < MAX_NETWORKS;  i++  ) {
+		delete networks[i];
+		networks[i] = NULL;
+		network_changed[i] = false;
+		network_dirty[i] = true;
+		network_dirty_since[i] = -1; // build at the first step
+	}
+}
+
+
+void route_landmarks_t::step(karte_t *welt)
+{
+	const uint8 landmark_count = welt->get_settings().get_route_landmarks();
+	const sint64 now = welt->get_ticks();
+	const sint64 delay = welt->ticks_per_world_month >> rebuild_delay_shift;
+
+	for(  int i = 0;  i < MAX_NETWORKS;  i++  ) {
+		if(  network_changed[i]  ) {
+			network_changed[i] = false;
+			if(  !network_dirty[i]  ) {
+				network_dirty[i] = true;
+				network_dirty_since[i] = now;
+			}
+		}
+	}
+
+	for(  int i = 0;  i < MAX_NETWORKS;  i++  ) {
+		if(  landmark_count == 0  ) {
+			delete networks[i];
+			networks[i] = NULL;
+			network_dirty[i] = true;
+			network_dirty_since[i] = -1;
+			continue;
+		}
+
+		const bool settled = network_dirty_since[i] < 0  ||  now < network_dirty_since[i]  ||  now - network_dirty_since[i] >= delay;
+		if(  (network_dirty[i] && settled)  ||  networks[i] == NULL  ||  networks[i]->requested_landmark_count != landmark_count  ) {
+			delete networks[i];
+			networks[i] = new route_landmarks_t(welt, network_waytype[i], landmark_count);
+			network_dirty[i] = false;
+			// at most one network per step, as building one takes a while on large maps
+			return;
+		}
+	}
+}
+
+
+route_landmarks_t::route_landmarks_t(karte_t *welt, waytype_t wt, uint8 count)
+{
+#ifdef DEBUG
+	const uint32 start = dr_time();
+#endif
+
+	requested_landmark_count = count;
+
+	// Collect the ways of this network, in the order of their positions rather than that of the list of
+	// all ways, which differs after loading. The landmarks, which are chosen by node, must be the same
+	// on all clients of a network game, since different bounds may give different routes of equal length.
+	vector_tpl<weg_t *> ways;
+	FOR(vector_tpl<weg_t *>, const w, weg_t::get_alle_wege()) {
+		if(  w->get_waytype() == wt  ) {
+			ways.append(w);
+		}
+	}
+	std::sort(ways.begin(), ways.end(), [](const weg_t *a, const weg_t *b) { return get_key(a->get_pos()) < get_key(b->get_pos()); });
+	node_count = ways.get_count();
+
+	uint32 table_size = 16;
+	while(  table_size < node_count * 2  ) {
+		table_size *= 2;
+	}
+	node_table_mask = table_size - 1;
+	nodes = new node_entry_t[table_size];
+	for(  uint32 i = 0;  i < table_size;  i++  ) {
+		nodes[i].key = UINT64_MAX_VALUE;
+		nodes[i].node = UINT32_MAX_VALUE;
+	}
+	for(  uint32 i = 0;  i < node_count;  i++  ) {
+		const uint64 key = get_key(ways[i]->get_pos());
+		uint32 entry = (uint32)((key * 0x9E3779B97F4A7C15ull) >> 32) & node_table_mask;
+		while(  nodes[entry].key != UINT64_MAX_VALUE  ) {
+			entry = (entry + 1) & node_table_mask;
+		}
+		nodes[entry].key = key;
+		nodes[entry].node = i;
+	}
+
+	// connect the nodes in both directions, so that the bounds hold whichever way the ways may be used
+	neighbours = new uint32[(size_t)node_count * 4];
+	for(  size_t i = 0;  i < (size_t)node_count * 4;  i++  ) {
+		neighbours[i] = UINT32_MAX_VALUE;
+	}
+	for(  uint32 i = 0;  i < node_count;  i++  ) {
+		const grund_t *gr = welt->lookup(ways[i]->get_pos());
+		const ribi_t::ribi ribi = ways[i]->get_ribi_unmasked();
+		if(  gr == NULL  ) {
+			continue;
+		}
+		for(  int r = 0;  r < 4;  r++  ) {
+			grund_t *to;
+			if(  (ribi & ribi_t::nesw[r])  &&  gr->get_neighbour(to, wt, ribi_t::nesw[r])  ) {
+				const uint32 neighbour = find_node(to->get_pos());
+				if(  neighbour != UINT32_MAX_VALUE  ) {
+					neighbours[(size_t)i * 4 + r] = neighbour;
+					neighbours[(size_t)neighbour * 4 + ((r + 2) & 3)] = i;
+				}
+			}
+		}
+	}
+
+	// Choose landmarks spread out over the network: each is the node farthest from those chosen
+	// before, beginning with the node farthest from the first. Nodes of networks not yet reached
+	// are farthest of all, so every separate network receives a landmark in turn.
+	landmark_count = (uint8)min<uint32>(count, node_count);
+	distances = new uint32[(size_t)node_count * max<uint32>(landmark_count, 1)];
+	uint32 *queue = new uint32[node_count];
+	uint32 *nearest = new uint32[node_count];
+	if(  landmark_count  ) {
+		measure_from(0, 0, queue);
+		for(  uint32 i = 0;  i < node_count;  i++  ) {
+			nearest[i] = distances[(size_t)i * landmark_count];
+		}
+		for(  uint8 landmark = 0;  landmark < landmark_count;  landmark++  ) {
+			uint32 source = 0;
+			for(  uint32 i = 1;  i < node_count;  i++  ) {
+				if(  nearest[i] > nearest[source]  ) {
+					source = i;
+				}
+			}
+			measure_from(source, landmark, queue);
+			for(  uint32 i = 0;  i < node_count;  i++  ) {
+				const uint32 distance = distances[(size_t)i * landmark_count + landmark];
+				nearest[i] = landmark == 0 ? distance : min(nearest[i], distance);
+			}
+		}
+	}
+	delete [] nearest;
+	delete [] queue;
+
+#ifdef DEBUG
+	DBG_MESSAGE("route_landmarks_t::route_landmarks_t()", "%u landmarks for %u tiles of waytype %i in %u ms", landmark_count, node_count, wt, dr_time() - start);
+#endif
+}
+
+
+route_landmarks_t::~route_landmarks_t()
+{
+	delete [] nodes;
+	delete [] neighbours;
+	delete [] distances;
+}
+
+
+void route_landmarks_t::measure_from(uint32 source, uint8 landmark, uint32 *queue)
+{
+	for(  uint32 i = 0;  i < node_count;  i++  ) {
+		distances[(size_t)i * landmark_count + landmark] = UINT32_MAX_VALUE;
+	}
+	distances[(size_t)source * landmark_count + landmark] = 0;
+	uint32 head = 0, tail = 0;
+	queue[tail++] = source;
+	while(  head < tail  ) {
+		const uint32 node = queue[head++];
+		const uint32 distance = distances[(size_t)node * landmark_count + landmark] + 1;
+		for(  int r = 0;  r < 4;  r++  ) {
+			const uint32 neighbour = neighbours[(size_t)node * 4 + r];
+			if(  neighbour != UINT32_MAX_VALUE  &&  distances[(size_t)neighbour * landmark_count + landmark] == UINT32_MAX_VALUE  ) {
+				distances[(size_t)neighbour * landmark_count + landmark] = distance;
+				queue[tail++] = neighbour;
+			}
+		}
+	}
+}
+
+
+uint32 route_landmarks_t::find_node(const koord3d &pos) const
+{
+	const uint64 key = get_key(pos);
+	uint32 entry = (uint32)((key * 0x9E3779B97F4A7C15ull) >> 32) & node_table_mask;
+	while(  nodes[entry].key != key  ) {
+		if(  nodes[entry].key == UINT64_MAX_VALUE  ) {
+			return UINT32_MAX_VALUE;
+		}
+		entry = (entry + 1) & node_table_mask;
+	}
+	return nodes[entry].node;
+}
@@ -0,0 +1,108 @@
+/*
+ * This file is part of the Simutrans-Extended project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef DATAOBJ_ROUTE_LANDMARKS_H
+#define DATAOBJ_ROUTE_LANDMARKS_H
+
+
+#include "../simtypes.h"
+#include "koord3d.h"
+
+class karte_t;
+
+/**
+ * Landmark lower bounds for the A* search of route_t::intern_calc_route (the "ALT" heuristic).
+ *
+ * For a few landmark tiles of a way network, the number of tiles between the landmark and every
+ * tile of the network is stored. By the triangle inequality, |d(L,target) - d(L,tile)| is then a
+ * lower bound on the number of tiles between a tile and the target. Where routes must detour
+ * around water or mountains, this is far tighter than the straight line distance, so that the
+ * search expands far fewer tiles.
+ *
+ * The tiles are counted in both directions along the ways, ignoring one way signs and all other
+ * restrictions, so the bounds hold for every vehicle. Ways which are removed only lengthen routes,
+ * so old bounds remain valid; new connexions can shorten routes, so the networks are rebuilt in
+ * the single threaded part of the world step some time after ways have been connected.
+ */
+class route_landmarks_t
+{
+public:
+	/// @returns the node of the tile @p pos, or UINT32_MAX_VALUE if it is not part of this network
+	uint32 find_node(const koord3d &pos) const;
+
+	/// @returns a lower bound on the number of tiles from node @p node to node @p target
+	inline uint32 get_lower_bound(const uint32 node, const uint32 target) const
+	{
+		const uint32 *node_distances = distances + (size_t)node * landmark_count;
+		const uint32 *target_distances = distances + (size_t)target * landmark_count;
+		uint32 bound = 0;
+		for(  uint8 i = 0;  i < landmark_count;  i++  ) {
+			const uint32 a = node_distances[i];
+			const uint32 b = target_distances[i];
+			if(  a != UINT32_MAX_VALUE  &&  b != UINT32_MAX_VALUE  ) {
+				const uint32 difference = a > b ? a - b : b - a;
+				bound = difference > bound ? difference : bound;
+			}
+		}
+		return bound;
+	}
+
+	/**
+	 * @returns the landmarks for routes of waytype @p wt, or NULL if there are none.
+	 * Safe to call from the convoy threads, since networks are only rebuilt while these are waiting.
+	 */
+	static const route_landmarks_t *get_landmarks(waytype_t wt);
+
+	/// The network of waytype @p wt has gained a connexion between ways.
+	static void set_network_changed(waytype_t wt);
+
+	/// Rebuilds at most one network which has changed, if it has been unchanged for long enough.
+	static void step(karte_t *welt);
+
+	/// Discards all networks, to be rebuilt from the ways of a new or loaded world.
+	static void reset();
+
+private:
+	route_landmarks_t(karte_t *welt, waytype_t wt, uint8 landmark_count);
+	~route_landmarks_t();
+
+	// breadth-first search from node @p source, writing the distances for landmark @p landmark
+	void measure_from(uint32 source, uint8 landmark, uint32 *queue);
+
+	struct node_entry_t
+	{
+		uint64 key;
+		uint32 node;
+	};
+
+	static inline uint64 get_key(const koord3d &pos)
+	{
+		return ((uint64)(uint16)pos.x << 24) | ((uint64)(uint16)pos.y << 8) | (uint8)pos.z;
+	}
+
+	// open addressing hash table from tile to node; empty entries have the key UINT64_MAX_VALUE
+	node_entry_t *nodes;
+	uint32 node_table_mask;
+	uint32 node_count;
+
+	// up to four neighbours of each node, UINT32_MAX_VALUE where there is none
+	uint32 *neighbours;
+
+	// node * landmark_count + landmark; UINT32_MAX_VALUE where the landmark cannot be reached
+	uint32 *distances;
+	uint8 landmark_count;
+	uint8 requested_landmark_count;
+
+	// the way networks for which landmarks are kept, and their state
+	enum { network_road = 0, network_track, network_monorail, network_maglev, network_narrowgauge, MAX_NETWORKS };
+	static sint8 get_network(waytype_t wt);
+
+	static route_landmarks_t *networks[MAX_NETWORKS];
+	static volatile bool network_changed[MAX_NETWORKS];
+	static bool network_dirty[MAX_NETWORKS];
+	static sint64 network_dirty_since[MAX_NETWORKS];
+};
+
+#endif
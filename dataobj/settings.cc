@@ -543,6 +543,8 @@ settings_t::settings_t() :
 
 	path_explorer_time_midpoint = 64;
 	save_path_explorer_data = true;
+	path_explorer_backend = PATH_EXPLORER_MATRIX;
+	route_landmarks = 0;
 
 	show_future_vehicle_info = true;
 }
@@ -1894,6 +1896,29 @@ void settings_t::rdwr(loadsave_t *file)
 			file->rdwr_bool(do_not_record_private_car_routes_to_distant_non_consumer_industries);
 			file->rdwr_bool(do_not_record_private_car_routes_to_city_buildings);
 		}
+
+		if (file->is_version_ex_atleast(14, 42))
+		{
+			file->rdwr_byte(path_explorer_backend);
+		}
+		else if (file->is_loading())
+		{
+			path_explorer_backend = PATH_EXPLORER_MATRIX;
+		}
+
+		if (file->is_version_ex_atleast(14, 43))
+		{
+			file->rdwr_short(private_car_route_full_refresh_months);
+		}
+
+		if (file->is_version_ex_atleast(14, 45))
+		{
+			file->rdwr_byte(route_landmarks);
+		}
+		else if (file->is_loading())
+		{
+			route_landmarks = 0;
+		}
 		// otherwise the default values of the last one will be used
 	}
 
@@ -2014,6 +2039,7 @@ void settings_t::parse_simuconf( tabfile_t& simuconf, sint16& disp_width, sint16
 	env_t::num_threads = clamp( contents.get_int( "threads", env_t::num_threads ), 1, MAX_THREADS );
 	env_t::simple_drawing_default = contents.get_int( "simple_drawing_tile_size", env_t::simple_drawing_default );
 	env_t::simple_drawing_fast_forward = contents.get_int( "simple_drawing_fast_forward", env_t::simple_drawing_fast_forward );
+	env_t::redraw_changes_only = contents.get_int( "redraw_changes_only", env_t::redraw_changes_only ) != 0;
 	env_t::visualize_schedule = contents.get_int( "visualize_schedule", env_t::visualize_schedule ) != 0;
 	env_t::show_vehicle_states = contents.get_int( "show_vehicle_states", env_t::show_vehicle_states );
 	env_t::follow_convoi_underground = contents.get_int( "follow_convoi_underground", env_t::follow_convoi_underground );
@@ -2063,6 +2089,7 @@ void settings_t::parse_simuconf( tabfile_t& simuconf, sint16& disp_width, sint16
 	env_t::server_save_game_on_quit         =        contents.get_int( "server_save_game_on_quit",        env_t::server_save_game_on_quit ) != 0;
 	env_t::reload_and_save_on_quit          =        contents.get_int( "reload_and_save_on_quit",         env_t::reload_and_save_on_quit )  != 0;
 	env_t::server_runs_background_tasks_when_paused = contents.get_int("server_runs_background_tasks_when_paused", env_t::server_runs_background_tasks_when_paused);
+	env_t::server_streamed_join             =        contents.get_int( "server_streamed_join",            env_t::server_streamed_join ) != 0;
 
 	env_t::server_announce = contents.get_int( "announce_server", env_t::server_announce );
 	if( !env_t::server ) {
@@ -2257,6 +2284,7 @@ void settings_t::parse_simuconf( tabfile_t& simuconf, sint16& disp_width, sint16
 	}
 
 	env_t::autosave = (contents.get_int( "autosave", env_t::autosave ));
+	env_t::background_autosave = contents.get_int( "background_autosave", env_t::background_autosave ) != 0;
 
 	// routing stuff
 	max_route_steps = contents.get_int( "max_route_steps", max_route_steps );
@@ -2798,6 +2826,8 @@ void settings_t::parse_simuconf( tabfile_t& simuconf, sint16& disp_width, sint16
 
 	path_explorer_time_midpoint = contents.get_int("path_explorer_time_midpoint", path_explorer_time_midpoint);
 	save_path_explorer_data = contents.get_int("save_path_explorer_data", save_path_explorer_data);
+	path_explorer_backend = clamp(contents.get_int("path_explorer_backend", path_explorer_backend), 0, MAX_PATH_EXPLORER_BACKEND - 1);
+	route_landmarks = clamp(contents.get_int("route_landmarks", route_landmarks), 0, 32);
 
 	show_future_vehicle_info = contents.get_int("show_future_vehicle_information", show_future_vehicle_info);
 
@@ -2805,6 +2835,7 @@ void settings_t::parse_simuconf( tabfile_t& simuconf, sint16& disp_width, sint16
 	private_car_route_to_industry_visitor_demand_threshold = contents.get_int("private_car_route_to_industry_visitor_demand_threshold", private_car_route_to_industry_visitor_demand_threshold);
 	do_not_record_private_car_routes_to_distant_non_consumer_industries = contents.get_int("do_not_record_private_car_routes_to_distant_non_consumer_industries", do_not_record_private_car_routes_to_distant_non_consumer_industries);
 	do_not_record_private_car_routes_to_city_buildings = contents.get_int("do_not_record_private_car_routes_to_city_buildings", do_not_record_private_car_routes_to_city_buildings);
+	private_car_route_full_refresh_months = contents.get_int("private_car_route_full_refresh_months", private_car_route_full_refresh_months);
 
 	uint32 max_routes_to_process_in_a_step = contents.get_int("max_routes_to_process_in_a_step", 0);
 	const uint32 old_max_route_tiles_extrapolated = max_routes_to_process_in_a_step * 1024;
@@ -372,6 +372,14 @@ private:
 	bool do_not_record_private_car_routes_to_distant_non_consumer_industries = true;
 	bool do_not_record_private_car_routes_to_city_buildings = true;
 
+	/**
+	* Between full refreshes of the private car routes, only the cities whose routes
+	* may have been affected by changed roads are checked again. This is the number of
+	* months between full refreshes, which also take account of changed congestion and
+	* new buildings. If 0, all cities are checked again continuously.
+	*/
+	uint16 private_car_route_full_refresh_months = 3;
+
 	/**
 	* This modifies the base journey time tolerance for passenger
 	* trips to allow more fine grained control of the journey time
@@ -772,6 +780,15 @@ public:
 	uint32 path_explorer_time_midpoint;
 	bool save_path_explorer_data;
 
+	// How the path explorer answers routing queries between halts:
+	// either from a complete matrix of all halt pairs, or from hub labels, which need far less memory
+	// on large maps at the cost of slightly slower queries.
+	enum path_explorer_backend_t { PATH_EXPLORER_MATRIX = 0, PATH_EXPLORER_HUB_LABELS, MAX_PATH_EXPLORER_BACKEND };
+	uint8 path_explorer_backend;
+
+	// Number of landmarks per way network for the lower bounds of convoy route searches; 0 disables these.
+	uint8 route_landmarks;
+
 	// Whether players can know in advance the vehicle production end date and upgrade availability date
 	// If false, only information up to one year ahead
 	bool show_future_vehicle_info;
@@ -1285,6 +1302,8 @@ public:
 
 	uint32 get_path_explorer_time_midpoint() const { return path_explorer_time_midpoint; }
 	bool get_save_path_explorer_data() const { return save_path_explorer_data; }
+	uint8 get_path_explorer_backend() const { return path_explorer_backend; }
+	uint8 get_route_landmarks() const { return route_landmarks; }
 
 	bool get_show_future_vehicle_info() const { return show_future_vehicle_info; }
 	//void set_show_future_vehicle_info(bool yesno) { show_future_vehicle_info = yesno; }
@@ -1302,6 +1321,7 @@ public:
 	void set_do_not_record_private_car_routes_to_distant_non_consumer_industries(bool value) { do_not_record_private_car_routes_to_distant_non_consumer_industries = value; }
 	bool get_do_not_record_private_car_routes_to_city_buildings() const { return do_not_record_private_car_routes_to_city_buildings; }
 	void set_do_not_record_private_car_routes_to_city_buildings(bool value) { do_not_record_private_car_routes_to_city_buildings = value; }
+	uint16 get_private_car_route_full_refresh_months() const { return private_car_route_full_refresh_months; }
 };
 
 #endif
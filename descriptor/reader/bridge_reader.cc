@@ -26,16 +26,11 @@ void bridge_reader_t::register_obj(obj_desc_t *&data)
 }
 
 
-obj_desc_t * bridge_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t * bridge_reader_t::read_node(char *desc_buf, obj_node_info_t &)
 {
 	// DBG_DEBUG("bridge_reader_t::read_node()", "called");
-	ALLOCA(char, desc_buf, node.size);
-
 	bridge_desc_t *desc = new bridge_desc_t();
 
-	// Read data
-	fread(desc_buf, node.size, 1, fp);
-
 	char * p = desc_buf;
 
 	// old versions of PAK files have no version stamp.
@@ -23,7 +23,7 @@ public:
 	/**
 	 * Read a node. Does version check and compatibility transformations.
 	 */
-	obj_desc_t* read_node(FILE*, obj_node_info_t&) OVERRIDE;
+	obj_desc_t* read_node(char*, obj_node_info_t&) OVERRIDE;
 };
 
 
@@ -44,7 +44,7 @@ public:
 	/**
 	 * Read a node. Does version check and compatibility transformations.
 	 */
-	obj_desc_t* read_node(FILE*, obj_node_info_t&) OVERRIDE;
+	obj_desc_t* read_node(char*, obj_node_info_t&) OVERRIDE;
 
 };
 
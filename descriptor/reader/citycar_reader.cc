@@ -36,15 +36,10 @@ bool citycar_reader_t::successfully_loaded() const
 }
 
 
-obj_desc_t * citycar_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t * citycar_reader_t::read_node(char *desc_buf, obj_node_info_t &)
 {
-	ALLOCA(char, desc_buf, node.size);
-
 	citycar_desc_t *desc = new citycar_desc_t();
 
-	// Read data
-	fread(desc_buf, node.size, 1, fp);
-
 	char * p = desc_buf;
 
 	// old versions of PAK files have no version stamp.
@@ -22,7 +22,7 @@ class factory_field_class_reader_t : public obj_reader_t {
 public:
 	static factory_field_class_reader_t *instance() { return &the_instance; }
 
-	obj_desc_t* read_node(FILE*, obj_node_info_t&) OVERRIDE;
+	obj_desc_t* read_node(char*, obj_node_info_t&) OVERRIDE;
 
 	obj_type get_type() const OVERRIDE { return obj_ffldclass; }
 	char const* get_type_name() const OVERRIDE { return "factory field class"; }
@@ -42,7 +42,7 @@ protected:
 public:
 	static factory_field_group_reader_t *instance() { return &the_instance; }
 
-	obj_desc_t* read_node(FILE*, obj_node_info_t&) OVERRIDE;
+	obj_desc_t* read_node(char*, obj_node_info_t&) OVERRIDE;
 
 	obj_type get_type() const OVERRIDE { return obj_ffield; }
 	char const* get_type_name() const OVERRIDE { return "factory field"; }
@@ -57,7 +57,7 @@ class factory_smoke_reader_t : public obj_reader_t {
 public:
 	static factory_smoke_reader_t*instance() { return &the_instance; }
 
-	obj_desc_t* read_node(FILE*, obj_node_info_t&) OVERRIDE;
+	obj_desc_t* read_node(char*, obj_node_info_t&) OVERRIDE;
 
 	obj_type get_type() const OVERRIDE { return obj_fsmoke; }
 	char const* get_type_name() const OVERRIDE { return "factory smoke"; }
@@ -71,7 +71,7 @@ class factory_supplier_reader_t : public obj_reader_t {
 public:
 	static factory_supplier_reader_t*instance() { return &the_instance; }
 
-	obj_desc_t* read_node(FILE*, obj_node_info_t&) OVERRIDE;
+	obj_desc_t* read_node(char*, obj_node_info_t&) OVERRIDE;
 
 	obj_type get_type() const OVERRIDE { return obj_fsupplier; }
 	char const* get_type_name() const OVERRIDE { return "factory supplier"; }
@@ -89,7 +89,7 @@ public:
 	 * Read a factory product node. Does version check and
 	 * compatibility transformations.
 	 */
-	obj_desc_t* read_node(FILE*, obj_node_info_t&) OVERRIDE;
+	obj_desc_t* read_node(char*, obj_node_info_t&) OVERRIDE;
 
 	obj_type get_type() const OVERRIDE { return obj_fproduct; }
 	char const* get_type_name() const OVERRIDE { return "factory product"; }
@@ -108,7 +108,7 @@ public:
 
 	static factory_reader_t*instance() { return &the_instance; }
 
-	obj_desc_t* read_node(FILE*, obj_node_info_t&) OVERRIDE;
+	obj_desc_t* read_node(char*, obj_node_info_t&) OVERRIDE;
 
 	obj_type get_type() const OVERRIDE { return obj_factory; }
 	char const* get_type_name() const OVERRIDE { return "factory"; }
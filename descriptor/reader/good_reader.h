@@ -27,7 +27,7 @@ public:
 	 * Read a goods info node. Does version check and
 	 * compatibility transformations.
 	 */
-	obj_desc_t* read_node(FILE*, obj_node_info_t&) OVERRIDE;
+	obj_desc_t* read_node(char*, obj_node_info_t&) OVERRIDE;
 };
 
 #endif
@@ -20,7 +20,7 @@ protected:
 public:
 	static ground_reader_t*instance() { return &the_instance; }
 
-	obj_desc_t* read_node(FILE*, obj_node_info_t&) OVERRIDE;
+	obj_desc_t* read_node(char*, obj_node_info_t&) OVERRIDE;
 
 	obj_type get_type() const OVERRIDE { return obj_ground; }
 	char const* get_type_name() const OVERRIDE { return "ground"; }
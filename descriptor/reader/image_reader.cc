@@ -24,13 +24,10 @@
 #define skip_reading_pixels_if_no_graphics goto adjust_image
 #endif
 
-obj_desc_t *image_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t *image_reader_t::read_node(char *desc_buf, obj_node_info_t &node)
 {
-	ALLOCA(char, desc_buf, node.size);
 	image_t* desc=NULL;
 
-	// Read data
-	fread(desc_buf, node.size, 1, fp);
 	char * p = desc_buf+6;
 
 	// always zero in old version, since length was always less than 65535
@@ -161,6 +158,14 @@ adjust_image:
 		}
 	}
 
+	return desc;
+}
+
+
+void image_reader_t::register_obj(obj_desc_t *&data)
+{
+	image_t *desc = static_cast<image_t *>(data);
+
 	if (desc->len != 0) {
 		// get the adler hash (since we have zlib on board anyway ... )
 		bool do_register_image = true;
@@ -193,9 +198,7 @@ adjust_image:
 		else {
 			// no need to load doubles ...
 			delete desc;
-			desc = same;
+			data = same;
 		}
 	}
-
-	return desc;
 }
@@ -19,7 +19,12 @@ public:
 
 	obj_type get_type() const OVERRIDE { return obj_image; }
 	char const* get_type_name() const OVERRIDE { return "image"; }
-	obj_desc_t* read_node(FILE*, obj_node_info_t&) OVERRIDE;
+	obj_desc_t* read_node(char*, obj_node_info_t&) OVERRIDE;
+
+	/// Registers the image with the graphics, unless the same image is already there
+	void register_obj(obj_desc_t*&) OVERRIDE;
+
+	bool is_read_thread_safe() const OVERRIDE { return true; }
 };
 
 #endif
@@ -20,7 +20,8 @@ public:
 	obj_type get_type() const OVERRIDE { return obj_imagelist; }
 	char const* get_type_name() const OVERRIDE { return "imagelist"; }
 
-	obj_desc_t* read_node(FILE*, obj_node_info_t&) OVERRIDE;
+	obj_desc_t* read_node(char*, obj_node_info_t&) OVERRIDE;
+	bool is_read_thread_safe() const OVERRIDE { return true; }
 };
 
 #endif
@@ -27,13 +27,57 @@
 #include "../../tpl/inthashtable_tpl.h"
 #include "../../tpl/ptrhashtable_tpl.h"
 #include "../../tpl/stringhashtable_tpl.h"
+#include "../../tpl/vector_tpl.h"
 #include "../../simdebug.h"
+#include "../../simmem.h"
 
 #include "../obj_desc.h"
 #include "../obj_node_info.h"
 
 #include "obj_reader.h"
 
+#ifdef MULTI_THREAD
+#include "../../utils/simthread.h"
+#endif
+
+
+/// A pak file in memory
+struct pak_file_t
+{
+	enum status_t { NOT_READ, OK, NOT_FOUND, NO_HEADER, TOO_NEW };
+
+	std::string name;
+	status_t status;
+	uint32 version;
+
+	char *data;  ///< the whole file
+	char *nodes; ///< the first node, after the header
+	char *pos;   ///< the next node to read
+	char *end;
+
+	/// nodes of thread safe readers decoded by read_pak(), in file order
+	vector_tpl<obj_desc_t *> decoded;
+	uint32 next_decoded;
+
+	bool ready; ///< read_pak() has finished
+
+	pak_file_t() : status(NOT_READ), version(0), data(NULL), nodes(NULL), pos(NULL), end(NULL), next_decoded(0), ready(false) {}
+	~pak_file_t() { free(data); }
+};
+
+
+#ifdef MULTI_THREAD
+// each thread reads at most this many files ahead of those being registered
+#define PAK_READ_AHEAD (4)
+
+static pthread_mutex_t read_ahead_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  read_ahead_cond  = PTHREAD_COND_INITIALIZER;
+static pak_file_t *read_ahead_paks;
+static uint32 read_ahead_count; // number of files
+static uint32 read_ahead_next;  // next file to read
+static uint32 read_ahead_limit; // files from here on wait until more are registered
+#endif
+
 
 obj_reader_t::obj_map*                                        obj_reader_t::obj_reader;
 inthashtable_tpl<obj_type, stringhashtable_tpl<obj_desc_t*, N_BAGS_LARGE>, N_BAGS_LARGE> obj_reader_t::loaded;
@@ -147,15 +191,63 @@ DBG_MESSAGE("obj_reader_t::load()","big logo %p", skinverwaltung_t::biglogosymbo
 
 DBG_MESSAGE("obj_reader_t::load()", "reading from '%s'", name.c_str());
 
+		// the files are read and partly decoded in parallel, but registered in order
+		pak_file_t *paks = new pak_file_t[max];
 		uint n = 0;
 		FORX(searchfolder_t, const& i, find, ++n) {
-			read_file(i);
+			paks[n].name = i;
+		}
+
+#ifdef MULTI_THREAD
+		const int wanted_read_threads = env_t::num_threads > 1 ? env_t::num_threads : 0;
+		pthread_t *read_threads = new pthread_t[wanted_read_threads];
+		read_ahead_paks = paks;
+		read_ahead_count = max;
+		read_ahead_next = 0;
+		read_ahead_limit = wanted_read_threads * PAK_READ_AHEAD;
+		// the threads take the next file in turn, so any that started will read all of them
+		int num_read_threads = 0;
+		while(  num_read_threads < wanted_read_threads  &&  pthread_create( &read_threads[num_read_threads], NULL, read_pak_thread, NULL ) == 0  ) {
+			num_read_threads++;
+		}
+		if(  num_read_threads < wanted_read_threads  ) {
+			dbg->warning("obj_reader_t::load()", "Could only start %d of %d threads to read the files", num_read_threads, wanted_read_threads);
+		}
+#endif
+
+		for(  n = 0;  n < (uint)max;  n++  ) {
+#ifdef MULTI_THREAD
+			if(  num_read_threads > 0  ) {
+				pthread_mutex_lock( &read_ahead_mutex );
+				while(  !paks[n].ready  ) {
+					pthread_cond_wait( &read_ahead_cond, &read_ahead_mutex );
+				}
+				read_ahead_limit = n + 1 + num_read_threads * PAK_READ_AHEAD;
+				pthread_cond_broadcast( &read_ahead_cond );
+				pthread_mutex_unlock( &read_ahead_mutex );
+			}
+			else
+#endif
+			{
+				read_pak( paks[n] );
+			}
+			register_pak( paks[n] );
+
 			if ((n & step) == 0 && drawing) {
 				ls.set_progress(n);
 			}
 		}
 		ls.set_progress(max);
 
+#ifdef MULTI_THREAD
+		for(  int t = 0;  t < num_read_threads;  t++  ) {
+			pthread_join( read_threads[t], NULL );
+		}
+		delete [] read_threads;
+		read_ahead_paks = NULL;
+#endif
+		delete [] paks;
+
 		return find.begin()!=find.end();
 	}
 	return false;
@@ -164,82 +256,187 @@ DBG_MESSAGE("obj_reader_t::load()", "reading from '%s'", name.c_str());
 
 void obj_reader_t::read_file(const char *name)
 {
-	// added trace
-	DBG_DEBUG("obj_reader_t::read_file()", "filename='%s'", name);
-
-	if (FILE* const fp = dr_fopen(name, "rb")) {
-		sint32 n = 0;
+	pak_file_t pak;
+	pak.name = name;
+	read_pak(pak);
+	register_pak(pak);
+}
 
-		// This is the normal header reading code
-		int c;
-		do {
-			c = fgetc(fp);
-			n ++;
-		} while(!feof(fp) && c != 0x1a);
 
-		if(feof(fp)) {
-			dbg->error("obj_reader_t::read_file()", "unexpected end of file after %d bytes while reading '%s'!",n, name);
+#ifdef MULTI_THREAD
+void *obj_reader_t::read_pak_thread(void *ptr)
+{
+	pthread_mutex_lock( &read_ahead_mutex );
+	while(  true  ) {
+		while(  read_ahead_next < read_ahead_count  &&  read_ahead_next >= read_ahead_limit  ) {
+			pthread_cond_wait( &read_ahead_cond, &read_ahead_mutex );
 		}
-		else {
-//			DBG_DEBUG("obj_reader_t::read_file()", "skipped %d header bytes", n);
+		if(  read_ahead_next >= read_ahead_count  ) {
+			break;
 		}
+		pak_file_t &pak = read_ahead_paks[read_ahead_next++];
+		pthread_mutex_unlock( &read_ahead_mutex );
 
-		// Compiled Version
-		uint32 version = 0;
-		char dummy[4], *p;
-		p = dummy;
+		read_pak( pak );
 
-		n = fread(dummy, 4, 1, fp);
-		version = decode_uint32(p);
+		pthread_mutex_lock( &read_ahead_mutex );
+		pak.ready = true;
+		pthread_cond_broadcast( &read_ahead_cond );
+	}
+	pthread_mutex_unlock( &read_ahead_mutex );
+	return ptr;
+}
+#endif
 
-		DBG_DEBUG("obj_reader_t::read_file()", "read %d blocks, file version is %x", n, version);
 
-		if(version <= COMPILER_VERSION_CODE) {
-			obj_desc_t *data = NULL;
-			read_nodes(fp, data, 0, version );
-		}
-		else {
-			DBG_DEBUG("obj_reader_t::read_file()","version of '%s' is too old, %d instead of %d", name, version, COMPILER_VERSION_CODE );
-		}
-		fclose(fp);
+void obj_reader_t::read_pak(pak_file_t &pak)
+{
+	FILE* const fp = dr_fopen(pak.name.c_str(), "rb");
+	if(  !fp  ) {
+		pak.status = pak_file_t::NOT_FOUND;
+		return;
 	}
-	else {
-		dbg->error("obj_reader_t::read_file()", "reading '%s' failed!", name);
+
+	// the whole file at once; the nodes are decoded from memory
+	fseek(fp, 0, SEEK_END);
+	const long len = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	pak.data = MALLOCN(char, max(len, 1L));
+	const size_t len_read = fread(pak.data, 1, max(len, 0L), fp);
+	fclose(fp);
+	pak.end = pak.data + len_read;
+
+	// This is the normal header reading code
+	char *p = (char *)memchr(pak.data, 0x1a, len_read);
+	if(  !p  ||  pak.end - ++p < 4  ) {
+		pak.status = pak_file_t::NO_HEADER;
+		return;
+	}
+
+	// Compiled Version
+	pak.version = decode_uint32(p);
+	if(  pak.version > COMPILER_VERSION_CODE  ) {
+		pak.status = pak_file_t::TOO_NEW;
+		return;
 	}
+	pak.status = pak_file_t::OK;
+	pak.nodes = p;
+
+	pak.pos = pak.nodes;
+	decode_nodes(pak);
+	pak.pos = pak.nodes;
 }
 
 
-static void read_node_info(obj_node_info_t& node, FILE* const f, uint32 const version)
+void obj_reader_t::register_pak(pak_file_t &pak)
 {
-	char data[EXT_OBJ_NODE_INFO_SIZE];
+	// added trace
+	DBG_DEBUG("obj_reader_t::read_file()", "filename='%s'", pak.name.c_str());
 
-	char* p = data;
-	fread(p, OBJ_NODE_INFO_SIZE, 1, f);
+	switch(  pak.status  ) {
+		case pak_file_t::OK: {
+			DBG_DEBUG("obj_reader_t::read_file()", "file version is %x", pak.version);
+			obj_desc_t *data = NULL;
+			read_nodes(pak, data, 0);
+			break;
+		}
+		case pak_file_t::TOO_NEW:
+			DBG_DEBUG("obj_reader_t::read_file()","version of '%s' is too old, %d instead of %d", pak.name.c_str(), pak.version, COMPILER_VERSION_CODE );
+			break;
+		case pak_file_t::NO_HEADER:
+			dbg->error("obj_reader_t::read_file()", "unexpected end of file while reading '%s'!", pak.name.c_str());
+			break;
+		default:
+			dbg->error("obj_reader_t::read_file()", "reading '%s' failed!", pak.name.c_str());
+			break;
+	}
+
+	free(pak.data);
+	pak.data = NULL;
+}
+
+
+/// Reads the node info at @p pak.pos and advances to the node data. @returns false if the file ends before the node.
+static bool read_node_info(obj_node_info_t& node, pak_file_t &pak)
+{
+	if(  pak.end - pak.pos < OBJ_NODE_INFO_SIZE  ) {
+		return false;
+	}
+	char* p = pak.pos;
 	node.type     = decode_uint32(p);
 	node.children = decode_uint16(p);
 	node.size     = decode_uint16(p);
 	// can have larger records
-	if (version != COMPILER_VERSION_CODE_11 && node.size == LARGE_RECORD_SIZE) {
-		fread(p, sizeof(data) - OBJ_NODE_INFO_SIZE, 1, f);
+	if (pak.version != COMPILER_VERSION_CODE_11 && node.size == LARGE_RECORD_SIZE) {
+		if(  pak.end - p < EXT_OBJ_NODE_INFO_SIZE - OBJ_NODE_INFO_SIZE  ) {
+			return false;
+		}
 		node.size = decode_uint32(p);
 	}
+	if(  (size_t)(pak.end - p) < node.size  ) {
+		return false;
+	}
+	pak.pos = p;
+	return true;
 }
 
 
-void obj_reader_t::read_nodes(FILE* fp, obj_desc_t*& data, int register_nodes, uint32 version )
+bool obj_reader_t::decode_nodes(pak_file_t &pak)
 {
 	obj_node_info_t node;
-	read_node_info(node, fp, version);
+	if(  !read_node_info(node, pak)  ) {
+		return false;
+	}
+	char *data = pak.pos;
+	pak.pos += node.size;
+
+	obj_reader_t *reader = obj_reader->get(static_cast<obj_type>(node.type));
+	if(  !reader  ) {
+		// read_nodes() will skip these as well
+		for(  int i = 0;  i < node.children;  i++  ) {
+			if(  !skip_nodes(pak)  ) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	if(  reader->is_read_thread_safe()  ) {
+		pak.decoded.append(reader->read_node(data, node));
+	}
+	for(  int i = 0;  i < node.children;  i++  ) {
+		if(  !decode_nodes(pak)  ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+
+void obj_reader_t::read_nodes(pak_file_t &pak, obj_desc_t*& data, int register_nodes)
+{
+	obj_node_info_t node;
+	if(  !read_node_info(node, pak)  ) {
+		dbg->fatal("obj_reader_t::read_nodes()", "unexpected end of file while reading '%s'!", pak.name.c_str());
+	}
+	char *node_data = pak.pos;
+	pak.pos += node.size;
 
 	obj_reader_t *reader = obj_reader->get(static_cast<obj_type>(node.type));
 	if(reader) {
 
 //DBG_DEBUG("obj_reader_t::read_nodes()","Reading %.4s-node of length %d with '%s'", reinterpret_cast<const char *>(&node.type), node.size, reader->get_type_name());
-		data = reader->read_node(fp, node);
+		if(  reader->is_read_thread_safe()  &&  pak.next_decoded < pak.decoded.get_count()  ) {
+			// already decoded by read_pak()
+			data = pak.decoded[pak.next_decoded++];
+		}
+		else {
+			data = reader->read_node(node_data, node);
+		}
 		if (node.children != 0) {
 			data->children = new obj_desc_t*[node.children];
 			for (int i = 0; i < node.children; i++) {
-				read_nodes(fp, data->children[i], register_nodes + 1, version);
+				read_nodes(pak, data->children[i], register_nodes + 1);
 			}
 		}
 
@@ -252,24 +449,30 @@ void obj_reader_t::read_nodes(FILE* fp, obj_desc_t*& data, int register_nodes, u
 	else {
 		// no reader found ...
 		dbg->warning("obj_reader_t::read_nodes()","skipping unknown %.4s-node\n",reinterpret_cast<const char *>(&node.type));
-		fseek(fp, node.size, SEEK_CUR);
 		for(int i = 0; i < node.children; i++) {
-			skip_nodes(fp,version);
+			if(  !skip_nodes(pak)  ) {
+				dbg->fatal("obj_reader_t::read_nodes()", "unexpected end of file while reading '%s'!", pak.name.c_str());
+			}
 		}
 		data = NULL;
 	}
 }
 
 
-void obj_reader_t::skip_nodes(FILE *fp,uint32 version)
+bool obj_reader_t::skip_nodes(pak_file_t &pak)
 {
 	obj_node_info_t node;
-	read_node_info(node, fp, version);
+	if(  !read_node_info(node, pak)  ) {
+		return false;
+	}
 
-	fseek(fp, node.size, SEEK_CUR);
+	pak.pos += node.size;
 	for(int i = 0; i < node.children; i++) {
-		skip_nodes(fp,version);
+		if(  !skip_nodes(pak)  ) {
+			return false;
+		}
 	}
+	return true;
 }
 
 
@@ -21,6 +21,7 @@ template<class key_t, class value_t, size_t n_bags> class inthashtable_tpl;
 template<class value_t, size_t n_bags> class stringhashtable_tpl;
 template<class key_t, class value_t, size_t n_bags> class ptrhashtable_tpl;
 template<class T> class slist_tpl;
+struct pak_file_t;
 
 
 
@@ -80,8 +81,19 @@ class obj_reader_t
 	static unresolved_map unresolved;
 	static ptrhashtable_tpl<obj_desc_t **, int, N_BAGS_SMALL>  fatals;
 
-	static void read_nodes(FILE* fp, obj_desc_t*& data, int register_nodes,uint32 version);
-	static void skip_nodes(FILE *fp,uint32 version);
+	static void read_nodes(pak_file_t &pak, obj_desc_t*& data, int register_nodes);
+	static bool skip_nodes(pak_file_t &pak);
+
+	/// Reads a file into memory and decodes the nodes of thread safe readers. Can run on any thread.
+	static void read_pak(pak_file_t &pak);
+	static bool decode_nodes(pak_file_t &pak);
+
+	/// Decodes the remaining nodes of a file read by read_pak() and registers all of them.
+	static void register_pak(pak_file_t &pak);
+
+#ifdef MULTI_THREAD
+	static void *read_pak_thread(void *ptr);
+#endif
 
 protected:
 	obj_reader_t() { /* Beware: Cannot register here! */}
@@ -91,8 +103,15 @@ protected:
 	static void xref_to_resolve(obj_type type, const char *name, obj_desc_t **dest, bool fatal);
 	static void resolve_xrefs();
 
-	virtual obj_desc_t* read_node(FILE* fp, obj_node_info_t& node) = 0;
+	/// Decodes a node from its @p node.size bytes at @p data.
+	virtual obj_desc_t* read_node(char *data, obj_node_info_t& node) = 0;
 	virtual void register_obj(obj_desc_t *&/*data*/) {}
+
+	/**
+	 * Whether read_node() only creates the node, without touching anything else.
+	 * Such nodes are decoded on several threads while the pak files are read.
+	 */
+	virtual bool is_read_thread_safe() const { return false; }
 	virtual bool successfully_loaded() const { return true; }
 
 	void register_reader();
@@ -14,7 +14,7 @@ void root_reader_t::register_obj(obj_desc_t *&data)
 }
 
 
-obj_desc_t* root_reader_t::read_node(FILE*, obj_node_info_t& info)
+obj_desc_t* root_reader_t::read_node(char*, obj_node_info_t& info)
 {
 	return obj_reader_t::read_node<obj_desc_t>(info);
 }
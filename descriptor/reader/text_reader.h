@@ -16,7 +16,8 @@ class text_reader_t : public obj_reader_t {
 public:
 	static text_reader_t*instance() { return &the_instance; }
 
-	obj_desc_t* read_node(FILE*, obj_node_info_t&) OVERRIDE;
+	obj_desc_t* read_node(char*, obj_node_info_t&) OVERRIDE;
+	bool is_read_thread_safe() const OVERRIDE { return true; }
 
 	obj_type get_type() const OVERRIDE { return obj_text; }
 	char const* get_type_name() const OVERRIDE { return "text"; }
@@ -55,17 +55,13 @@ void tunnel_reader_t::convert_old_tunnel(tunnel_desc_t *desc)
 }
 
 
-obj_desc_t * tunnel_reader_t::read_node(FILE *fp, obj_node_info_t &node)
+obj_desc_t * tunnel_reader_t::read_node(char *desc_buf, obj_node_info_t &node)
 {
 	tunnel_desc_t *desc = new tunnel_desc_t();
 	desc->topspeed = 0; // indicate, that we have to convert this to reasonable date, when read completely
 
 	if(node.size>0) {
 		// newer versioned node
-		ALLOCA(char, desc_buf, node.size);
-
-		fread(desc_buf, node.size, 1, fp);
-
 		char * p = desc_buf;
 
 		const uint16 v = decode_uint16(p);
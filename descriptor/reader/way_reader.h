@@ -25,7 +25,7 @@ public:
 	 * Read a way info node. Does version check and
 	 * compatibility transformations.
 	 */
-	obj_desc_t* read_node(FILE*, obj_node_info_t&) OVERRIDE;
+	obj_desc_t* read_node(char*, obj_node_info_t&) OVERRIDE;
 
 	obj_type get_type() const OVERRIDE { return obj_way; }
 	char const* get_type_name() const OVERRIDE { return "way"; }
@@ -171,6 +171,8 @@ void display_mark_img_dirty( image_id image, scr_coord_val x, scr_coord_val y );
 void mark_rect_dirty_wc(scr_coord_val x1, scr_coord_val y1, scr_coord_val x2, scr_coord_val y2); // clips to screen only
 void mark_rect_dirty_clip(scr_coord_val x1, scr_coord_val y1, scr_coord_val x2, scr_coord_val y2  CLIP_NUM_DEF); // clips to clip_rect
 void mark_screen_dirty();
+/// bounding box of what has changed or was drawn dirty since the last frame within area; false if nothing
+bool display_get_dirty_rect(scr_rect area, scr_rect &dirty);
 
 scr_coord_val display_get_width();
 scr_coord_val display_get_height();
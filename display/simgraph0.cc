@@ -70,6 +70,12 @@ void mark_screen_dirty()
 {
 }
 
+bool display_get_dirty_rect(scr_rect area, scr_rect &dirty)
+{
+	dirty = area;
+	return area.w > 0  &&  area.h > 0;
+}
+
 void display_mark_img_dirty(image_id, scr_coord_val, scr_coord_val)
 {
 }
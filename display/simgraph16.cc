@@ -36,12 +36,17 @@
 #	include <unistd.h>
 #endif
 
+// SSE2 is part of every x86-64 cpu, so it needs no check at run time
+#if !defined(NO_SIMD)  &&  (defined(__SSE2__)  ||  defined(_M_X64)  ||  (defined(_M_IX86_FP)  &&  _M_IX86_FP >= 2))
+#	define USE_SSE2
+#	include <emmintrin.h>
+#endif
+
 #ifdef MULTI_THREAD
 #include "../utils/simthread.h"
 
-// currently just redrawing/rezooming
+// currently just redrawing/rezooming and recoding; image n is guarded by rezoom_img_mutex[n % num_threads]
 static pthread_mutex_t rezoom_img_mutex[MAX_THREADS];
-static pthread_mutex_t recode_img_mutex;
 #endif
 
 // to pass the extra clipnum when not needed use this
@@ -315,6 +320,22 @@ static uint8 transparent_map_day_night_rgb[(MAX_PLAYER_COUNT+LIGHT_COUNT+1024)*4
 static uint8 player_offsets[MAX_PLAYER_COUNT][2];
 
 
+// number of earlier zoom levels of which each image keeps its zoomed data
+#define ZOOM_CACHE_SIZE (2)
+
+/*
+ * Zoomed data of an image at an earlier zoom level, so zooming back does not need to rezoom again
+ */
+struct zoom_cache_t {
+	PIXVAL* data; // NULL if unused
+	uint32 len;
+	sint16 x;
+	sint16 y;
+	sint16 w;
+	sint16 h;
+	sint8 zoom;
+};
+
 /*
  * Image map descriptor structure
  */
@@ -331,6 +352,9 @@ struct imd {
 
 	PIXVAL* zoom_data; // zoomed original data
 	uint32 len;    // current zoom image data size (or base if not zoomed) (used for allocation purposes only)
+	sint8 zoom;    // zoom factor of zoom_data
+
+	zoom_cache_t zoom_cache[ZOOM_CACHE_SIZE]; // most recent first
 
 	sint16 base_x; // min x offset
 	sint16 base_y; // min y offset
@@ -1083,6 +1107,49 @@ void mark_screen_dirty()
 }
 
 
+/**
+ * Finds the bounding box of the dirty tiles within @p area, i.e. of what has changed
+ * since the last frame or was drawn dirty in it (and so must be drawn over again).
+ * @returns false if nothing in @p area is dirty
+ */
+bool display_get_dirty_rect(scr_rect area, scr_rect &dirty)
+{
+	const scr_coord_val left   = max( area.x, (scr_coord_val)0 );
+	const scr_coord_val top    = max( area.y, (scr_coord_val)0 );
+	const scr_coord_val right  = min( area.get_right(), disp_width );
+	const scr_coord_val bottom = min( area.get_bottom(), disp_height );
+	if(  left >= right  ||  top >= bottom  ) {
+		return false;
+	}
+	const int x1 = left >> DIRTY_TILE_SHIFT;
+	const int y1 = top >> DIRTY_TILE_SHIFT;
+	const int x2 = (right - 1) >> DIRTY_TILE_SHIFT;
+	const int y2 = (bottom - 1) >> DIRTY_TILE_SHIFT;
+
+	int min_x = x2 + 1, max_x = -1, min_y = y2 + 1, max_y = -1;
+	for(  int y = y1;  y <= y2;  y++  ) {
+		int bit = y * tile_buffer_per_line + x1;
+		for(  int x = x1;  x <= x2;  x++, bit++  ) {
+			if(  ((tile_dirty[bit >> 5] | tile_dirty_old[bit >> 5]) >> (bit & 31)) & 1  ) {
+				min_x = min( min_x, x );
+				max_x = max( max_x, x );
+				min_y = min( min_y, y );
+				max_y = y;
+			}
+		}
+	}
+	if(  max_x < 0  ) {
+		return false;
+	}
+	const scr_coord_val dirty_left = max( (scr_coord_val)(min_x << DIRTY_TILE_SHIFT), left );
+	const scr_coord_val dirty_top  = max( (scr_coord_val)(min_y << DIRTY_TILE_SHIFT), top );
+	dirty = scr_rect( dirty_left, dirty_top,
+		min( (scr_coord_val)((max_x + 1) << DIRTY_TILE_SHIFT), right ) - dirty_left,
+		min( (scr_coord_val)((max_y + 1) << DIRTY_TILE_SHIFT), bottom ) - dirty_top );
+	return true;
+}
+
+
 /**
  * the area of this image need update
  */
@@ -1221,14 +1288,15 @@ static void recode()
 
 
 // to switch between 15 bit and 16 bit recoding ...
-typedef void (*display_recode_img_src_target_proc)(scr_coord_val h, PIXVAL *src, PIXVAL *target);
+// player_colors are the 16 day/night colours of the player, since rgbmap_day_night holds those of the last activated player only
+typedef void (*display_recode_img_src_target_proc)(scr_coord_val h, PIXVAL *src, PIXVAL *target, const PIXVAL *player_colors);
 static display_recode_img_src_target_proc recode_img_src_target = NULL;
 
 
 /**
  * Convert a certain image data to actual output data
  */
-static void recode_img_src_target_15(scr_coord_val h, PIXVAL *src, PIXVAL *target)
+static void recode_img_src_target_15(scr_coord_val h, PIXVAL *src, PIXVAL *target, const PIXVAL *player_colors)
 {
 	if(  h > 0  ) {
 		do {
@@ -1242,7 +1310,7 @@ static void recode_img_src_target_15(scr_coord_val h, PIXVAL *src, PIXVAL *targe
 					while(  runlen--  ) {
 						if(  *src < 0x8020+(31*16)  ) {
 							// expand transparent player color
-							PIXVAL rgb555 = rgbmap_day_night[(*src-0x8020)/31+0x8000];
+							PIXVAL rgb555 = player_colors[(*src-0x8020)/31];
 							PIXVAL alpha = (*src-0x8020) % 31;
 							PIXVAL pix = ((rgb555 >> 6) & 0x0380) | ((rgb555 >>  4) & 0x0038) | ((rgb555 >> 2) & 0x07);
 							*target++ = 0x8020 + 31*31 + pix*31 + alpha;
@@ -1256,7 +1324,8 @@ static void recode_img_src_target_15(scr_coord_val h, PIXVAL *src, PIXVAL *targe
 				else {
 					// now just convert the color pixels
 					while(  runlen--  ) {
-						*target++ = rgbmap_day_night[*src++];
+						const PIXVAL pix = *src++;
+						*target++ = (pix & 0xFFF0) == 0x8000 ? player_colors[pix & 0x0F] : rgbmap_day_night[pix];
 					}
 				}
 				// next clear run or zero = end
@@ -1265,7 +1334,7 @@ static void recode_img_src_target_15(scr_coord_val h, PIXVAL *src, PIXVAL *targe
 	}
 }
 
-static void recode_img_src_target_16(scr_coord_val h, PIXVAL *src, PIXVAL *target)
+static void recode_img_src_target_16(scr_coord_val h, PIXVAL *src, PIXVAL *target, const PIXVAL *player_colors)
 {
 	if(  h > 0  ) {
 		do {
@@ -1279,7 +1348,7 @@ static void recode_img_src_target_16(scr_coord_val h, PIXVAL *src, PIXVAL *targe
 					while(  runlen--  ) {
 						if(  *src < 0x8020+(31*16)  ) {
 							// expand transparent player color
-							PIXVAL rgb565 = rgbmap_day_night[(*src-0x8020)/31+0x8000];
+							PIXVAL rgb565 = player_colors[(*src-0x8020)/31];
 							PIXVAL alpha = (*src-0x8020) % 31;
 							PIXVAL pix = ((rgb565 >> 6) & 0x0380) | ((rgb565 >>  3) & 0x0078) | ((rgb565 >> 2) & 0x07);
 							*target++ = 0x8020 + 31*31 + pix*31 + alpha;
@@ -1293,7 +1362,8 @@ static void recode_img_src_target_16(scr_coord_val h, PIXVAL *src, PIXVAL *targe
 				else {
 					// now just convert the color pixels
 					while(  runlen--  ) {
-						*target++ = rgbmap_day_night[*src++];
+						const PIXVAL pix = *src++;
+						*target++ = (pix & 0xFFF0) == 0x8000 ? player_colors[pix & 0x0F] : rgbmap_day_night[pix];
 					}
 				}
 				// next clear run or zero = end
@@ -1316,10 +1386,10 @@ static void recode_img(const image_id n, const sint8 player_nr)
 {
 	// may this image be zoomed
 #ifdef MULTI_THREAD
-	pthread_mutex_lock( &recode_img_mutex );
+	pthread_mutex_lock( &rezoom_img_mutex[n % env_t::num_threads] );
 	if(  (images[n].player_flags & (1<<player_nr)) == 0  ) {
 		// other thread did already the re-code...
-		pthread_mutex_unlock( &recode_img_mutex );
+		pthread_mutex_unlock( &rezoom_img_mutex[n % env_t::num_threads] );
 		return;
 	}
 #endif
@@ -1328,12 +1398,16 @@ static void recode_img(const image_id n, const sint8 player_nr)
 	if(  images[n].data[player_nr] == NULL  ) {
 		images[n].data[player_nr] = MALLOCN( PIXVAL, images[n].len );
 	}
-	// contains now the player color ...
-	activate_player_color( player_nr, true );
-	recode_img_src_target( images[n].h, src, images[n].data[player_nr] );
+	// the player colours are passed on instead of activated, so other images can be recoded at the same time
+	PIXVAL player_colors[16];
+	for(  int i = 0;  i < 8;  i++  ) {
+		player_colors[i] = specialcolormap_day_night[player_offsets[player_nr][0]+i];
+		player_colors[i+8] = specialcolormap_day_night[player_offsets[player_nr][1]+i];
+	}
+	recode_img_src_target( images[n].h, src, images[n].data[player_nr], player_colors );
 	images[n].player_flags &= ~(1<<player_nr);
 #ifdef MULTI_THREAD
-	pthread_mutex_unlock( &recode_img_mutex );
+	pthread_mutex_unlock( &rezoom_img_mutex[n % env_t::num_threads] );
 #endif
 }
 
@@ -1392,6 +1466,68 @@ PIXVAL inline zoomin_pixel(uint8 *p, uint8* pab, uint8 *prl, uint8* pdia)
 }
 
 
+/**
+ * Moves the zoomed data of an image into its zoom cache, dropping the oldest entry
+ */
+static void push_zoom_cache(imd &image)
+{
+	zoom_cache_t &oldest = image.zoom_cache[ZOOM_CACHE_SIZE-1];
+	if(  oldest.data != NULL  ) {
+		free( oldest.data );
+	}
+	for(  int i = ZOOM_CACHE_SIZE-1;  i > 0;  i--  ) {
+		image.zoom_cache[i] = image.zoom_cache[i-1];
+	}
+	zoom_cache_t &entry = image.zoom_cache[0];
+	entry.data = image.zoom_data;
+	entry.len = image.len;
+	entry.x = image.x;
+	entry.y = image.y;
+	entry.w = image.w;
+	entry.h = image.h;
+	entry.zoom = image.zoom;
+	image.zoom_data = NULL;
+}
+
+
+/**
+ * Takes the zoomed data for zoom factor @p zoom from the zoom cache of an image
+ * @returns false if there is none
+ */
+static bool pop_zoom_cache(imd &image, sint8 zoom)
+{
+	for(  int i = 0;  i < ZOOM_CACHE_SIZE;  i++  ) {
+		zoom_cache_t &entry = image.zoom_cache[i];
+		if(  entry.data != NULL  &&  entry.zoom == zoom  ) {
+			image.zoom_data = entry.data;
+			image.len = entry.len;
+			image.x = entry.x;
+			image.y = entry.y;
+			image.w = entry.w;
+			image.h = entry.h;
+			image.zoom = zoom;
+			for(  ;  i < ZOOM_CACHE_SIZE-1;  i++  ) {
+				image.zoom_cache[i] = image.zoom_cache[i+1];
+			}
+			image.zoom_cache[ZOOM_CACHE_SIZE-1].data = NULL;
+			return true;
+		}
+	}
+	return false;
+}
+
+
+static void free_zoom_cache(imd &image)
+{
+	for(  int i = 0;  i < ZOOM_CACHE_SIZE;  i++  ) {
+		if(  image.zoom_cache[i].data != NULL  ) {
+			free( image.zoom_cache[i].data );
+			image.zoom_cache[i].data = NULL;
+		}
+	}
+}
+
+
 /**
  * Convert base image data to actual image size
  * Uses averages of all sampled points to get the "real" value
@@ -1413,10 +1549,9 @@ static void rezoom_img(const image_id n)
 		images[n].player_flags = 0xFFFF; // recode all player colors
 
 		//  we recalculate the len (since it may be larger than before)
-		// thus we have to free the old caches
+		// thus we have to free the old caches; the zoomed data is kept for zooming back
 		if(  images[n].zoom_data != NULL  ) {
-			free( images[n].zoom_data );
-			images[n].zoom_data = NULL;
+			push_zoom_cache( images[n] );
 		}
 		for(  uint8 i = 0;  i < MAX_PLAYER_COUNT;  i++  ) {
 			if(  images[n].data[i] != NULL  ) {
@@ -1453,6 +1588,15 @@ static void rezoom_img(const image_id n)
 			return;
 		}
 
+		// zoomed to this level before?
+		if(  pop_zoom_cache( images[n], zoom_factor )  ) {
+			images[n].recode_flags &= ~FLAG_REZOOM;
+#ifdef MULTI_THREAD
+			pthread_mutex_unlock( &rezoom_img_mutex[n % env_t::num_threads] );
+#endif
+			return;
+		}
+
 		// now we want to downsize the image
 		// just divide the sizes
 		images[n].x = (images[n].base_x * zoom_num[zoom_factor]) / zoom_den[zoom_factor];
@@ -1858,6 +2002,7 @@ static void rezoom_img(const image_id n)
 				const size_t zoom_len = (size_t)(((uint8 *)dest) - ((uint8 *)rezoom_baseimage[n % env_t::num_threads]));
 				images[n].len = (uint32)(zoom_len / sizeof(PIXVAL));
 				images[n].zoom_data = MALLOCN(PIXVAL, images[n].len);
+				images[n].zoom = zoom_factor;
 				assert( images[n].zoom_data );
 				memcpy( images[n].zoom_data, rezoom_baseimage[n % env_t::num_threads], zoom_len );
 			}
@@ -2153,6 +2298,9 @@ void register_image(image_t *image_in)
 
 	image->zoom_data = NULL;
 	image->len = image_in->len;
+	for(  int i = 0;  i < ZOOM_CACHE_SIZE;  i++  ) {
+		image->zoom_cache[i].data = NULL;
+	}
 
 	image->base_x = image_in->x;
 	image->base_w = image_in->w;
@@ -2176,6 +2324,7 @@ void display_free_all_images_above( image_id above )
 		if(  images[anz_images].zoom_data != NULL  ) {
 			free( images[anz_images].zoom_data );
 		}
+		free_zoom_cache( images[anz_images] );
 		for(  uint8 i = 0;  i < MAX_PLAYER_COUNT;  i++  ) {
 			if(  images[anz_images].data[i] != NULL  ) {
 				free( images[anz_images].data[i] );
@@ -2216,9 +2365,9 @@ void display_get_base_image_offset(image_id image, scr_coord_val *xoff, scr_coor
  */
 static inline void pixcopy(PIXVAL *dest, const PIXVAL *src, const PIXVAL * const end)
 {
-	// for gcc this seems to produce the optimal code ...
-	while (src < end) {
-		*dest++ = *src++;
+	// the library copies long runs with the widest vector instructions of the cpu
+	if(  src < end  ) {
+		memcpy( dest, src, (end - src) * sizeof(PIXVAL) );
 	}
 }
 
@@ -3081,9 +3230,78 @@ PIXVAL display_blend_colors(PIXVAL background, PIXVAL foreground, int percent_bl
 /* from here code for transparent images */
 typedef void (*blend_proc)(PIXVAL *dest, const PIXVAL *src, const PIXVAL colour, const PIXVAL len);
 
+#ifdef USE_SSE2
+/*
+ * The blending below is done on eight pixels at once where SSE2 is available.
+ * Each span function returns the number of pixels it has done;
+ * the remaining (at most seven) are left to the plain loop of the caller.
+ */
+typedef __m128i (*blend_sse2_op)(const __m128i src, const __m128i dest, const __m128i mask);
+
+static inline __m128i blend75_sse2(const __m128i src, const __m128i dest, const __m128i two_out)
+{
+	const __m128i s = _mm_and_si128( _mm_srli_epi16( src, 2 ), two_out );
+	return _mm_add_epi16( _mm_add_epi16( _mm_add_epi16( s, s ), s ), _mm_and_si128( _mm_srli_epi16( dest, 2 ), two_out ) );
+}
+
+static inline __m128i blend50_sse2(const __m128i src, const __m128i dest, const __m128i one_out)
+{
+	return _mm_add_epi16( _mm_and_si128( _mm_srli_epi16( src, 1 ), one_out ), _mm_and_si128( _mm_srli_epi16( dest, 1 ), one_out ) );
+}
+
+static inline __m128i blend25_sse2(const __m128i src, const __m128i dest, const __m128i two_out)
+{
+	const __m128i d = _mm_and_si128( _mm_srli_epi16( dest, 2 ), two_out );
+	return _mm_add_epi16( _mm_and_si128( _mm_srli_epi16( src, 2 ), two_out ), _mm_add_epi16( _mm_add_epi16( d, d ), d ) );
+}
+
+template<blend_sse2_op op> static inline PIXVAL blend_span_sse2(PIXVAL *dest, const PIXVAL *src, const PIXVAL mask, const PIXVAL len)
+{
+	const __m128i m = _mm_set1_epi16( mask );
+	PIXVAL i = 0;
+	for(  ;  i + 8 <= len;  i += 8  ) {
+		const __m128i s = _mm_loadu_si128( (const __m128i *)(src + i) );
+		const __m128i d = _mm_loadu_si128( (const __m128i *)(dest + i) );
+		_mm_storeu_si128( (__m128i *)(dest + i), op( s, d, m ) );
+	}
+	return i;
+}
+
+template<blend_sse2_op op> static inline PIXVAL blend_recode_span_sse2(PIXVAL *dest, const PIXVAL *src, const PIXVAL mask, const PIXVAL len)
+{
+	const __m128i m = _mm_set1_epi16( mask );
+	PIXVAL i = 0;
+	for(  ;  i + 8 <= len;  i += 8  ) {
+		// there is no gather in SSE2, so the colours are looked up one by one
+		const __m128i s = _mm_setr_epi16( rgbmap_current[src[i]], rgbmap_current[src[i+1]], rgbmap_current[src[i+2]], rgbmap_current[src[i+3]],
+			rgbmap_current[src[i+4]], rgbmap_current[src[i+5]], rgbmap_current[src[i+6]], rgbmap_current[src[i+7]] );
+		const __m128i d = _mm_loadu_si128( (const __m128i *)(dest + i) );
+		_mm_storeu_si128( (__m128i *)(dest + i), op( s, d, m ) );
+	}
+	return i;
+}
+
+template<blend_sse2_op op> static inline PIXVAL outline_span_sse2(PIXVAL *dest, const PIXVAL colour, const PIXVAL mask, const PIXVAL len)
+{
+	const __m128i m = _mm_set1_epi16( mask );
+	const __m128i s = _mm_set1_epi16( colour );
+	PIXVAL i = 0;
+	for(  ;  i + 8 <= len;  i += 8  ) {
+		const __m128i d = _mm_loadu_si128( (const __m128i *)(dest + i) );
+		_mm_storeu_si128( (__m128i *)(dest + i), op( s, d, m ) );
+	}
+	return i;
+}
+#endif
+
 static void pix_blend75_15(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	const PIXVAL done = blend_span_sse2<blend75_sse2>( dest, src, TWO_OUT_15, len );
+	dest += done;
+	src += done;
+#endif
 	while (dest < end) {
 		*dest = (3*(((*src)>>2) & TWO_OUT_15)) + (((*dest)>>2) & TWO_OUT_15);
 		dest++;
@@ -3095,6 +3313,11 @@ static void pix_blend75_15(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const
 static void pix_blend75_16(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	const PIXVAL done = blend_span_sse2<blend75_sse2>( dest, src, TWO_OUT_16, len );
+	dest += done;
+	src += done;
+#endif
 	while (dest < end) {
 		*dest = (3*(((*src)>>2) & TWO_OUT_16)) + (((*dest)>>2) & TWO_OUT_16);
 		dest++;
@@ -3106,6 +3329,11 @@ static void pix_blend75_16(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const
 static void pix_blend50_15(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	const PIXVAL done = blend_span_sse2<blend50_sse2>( dest, src, ONE_OUT_15, len );
+	dest += done;
+	src += done;
+#endif
 	while (dest < end) {
 		*dest = (((*src)>>1) & ONE_OUT_15) + (((*dest)>>1) & ONE_OUT_15);
 		dest++;
@@ -3117,6 +3345,11 @@ static void pix_blend50_15(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const
 static void pix_blend50_16(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	const PIXVAL done = blend_span_sse2<blend50_sse2>( dest, src, ONE_OUT_16, len );
+	dest += done;
+	src += done;
+#endif
 	while (dest < end) {
 		*dest = (((*src)>>1) & ONE_OUT_16) + (((*dest)>>1) & ONE_OUT_16);
 		dest++;
@@ -3128,6 +3361,11 @@ static void pix_blend50_16(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const
 static void pix_blend25_15(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	const PIXVAL done = blend_span_sse2<blend25_sse2>( dest, src, TWO_OUT_15, len );
+	dest += done;
+	src += done;
+#endif
 	while (dest < end) {
 		*dest = (((*src)>>2) & TWO_OUT_15) + (3*(((*dest)>>2) & TWO_OUT_15));
 		dest++;
@@ -3139,6 +3377,11 @@ static void pix_blend25_15(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const
 static void pix_blend25_16(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	const PIXVAL done = blend_span_sse2<blend25_sse2>( dest, src, TWO_OUT_16, len );
+	dest += done;
+	src += done;
+#endif
 	while (dest < end) {
 		*dest = (((*src)>>2) & TWO_OUT_16) + (3*(((*dest)>>2) & TWO_OUT_16));
 		dest++;
@@ -3151,6 +3394,11 @@ static void pix_blend25_16(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const
 static void pix_blend_recode75_15(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	const PIXVAL done = blend_recode_span_sse2<blend75_sse2>( dest, src, TWO_OUT_15, len );
+	dest += done;
+	src += done;
+#endif
 	while (dest < end) {
 		*dest = (3*(((rgbmap_current[*src])>>2) & TWO_OUT_15)) + (((*dest)>>2) & TWO_OUT_15);
 		dest++;
@@ -3162,6 +3410,11 @@ static void pix_blend_recode75_15(PIXVAL *dest, const PIXVAL *src, const PIXVAL
 static void pix_blend_recode75_16(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	const PIXVAL done = blend_recode_span_sse2<blend75_sse2>( dest, src, TWO_OUT_16, len );
+	dest += done;
+	src += done;
+#endif
 	while (dest < end) {
 		*dest = (3*(((rgbmap_current[*src])>>2) & TWO_OUT_16)) + (((*dest)>>2) & TWO_OUT_16);
 		dest++;
@@ -3173,6 +3426,11 @@ static void pix_blend_recode75_16(PIXVAL *dest, const PIXVAL *src, const PIXVAL
 static void pix_blend_recode50_15(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	const PIXVAL done = blend_recode_span_sse2<blend50_sse2>( dest, src, ONE_OUT_15, len );
+	dest += done;
+	src += done;
+#endif
 	while (dest < end) {
 		*dest = (((rgbmap_current[*src])>>1) & ONE_OUT_15) + (((*dest)>>1) & ONE_OUT_15);
 		dest++;
@@ -3184,6 +3442,11 @@ static void pix_blend_recode50_15(PIXVAL *dest, const PIXVAL *src, const PIXVAL
 static void pix_blend_recode50_16(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	const PIXVAL done = blend_recode_span_sse2<blend50_sse2>( dest, src, ONE_OUT_16, len );
+	dest += done;
+	src += done;
+#endif
 	while (dest < end) {
 		*dest = (((rgbmap_current[*src])>>1) & ONE_OUT_16) + (((*dest)>>1) & ONE_OUT_16);
 		dest++;
@@ -3195,6 +3458,11 @@ static void pix_blend_recode50_16(PIXVAL *dest, const PIXVAL *src, const PIXVAL
 static void pix_blend_recode25_15(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	const PIXVAL done = blend_recode_span_sse2<blend25_sse2>( dest, src, TWO_OUT_15, len );
+	dest += done;
+	src += done;
+#endif
 	while (dest < end) {
 		*dest = (((rgbmap_current[*src])>>2) & TWO_OUT_15) + (3*(((*dest)>>2) & TWO_OUT_15));
 		dest++;
@@ -3206,6 +3474,11 @@ static void pix_blend_recode25_15(PIXVAL *dest, const PIXVAL *src, const PIXVAL
 static void pix_blend_recode25_16(PIXVAL *dest, const PIXVAL *src, const PIXVAL , const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	const PIXVAL done = blend_recode_span_sse2<blend25_sse2>( dest, src, TWO_OUT_16, len );
+	dest += done;
+	src += done;
+#endif
 	while (dest < end) {
 		*dest = (((rgbmap_current[*src])>>2) & TWO_OUT_16) + (3*(((*dest)>>2) & TWO_OUT_16));
 		dest++;
@@ -3217,6 +3490,9 @@ static void pix_blend_recode25_16(PIXVAL *dest, const PIXVAL *src, const PIXVAL
 static void pix_outline75_15(PIXVAL *dest, const PIXVAL *, const PIXVAL colour, const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	dest += outline_span_sse2<blend75_sse2>( dest, colour, TWO_OUT_15, len );
+#endif
 	while (dest < end) {
 		*dest = (3*((colour>>2) & TWO_OUT_15)) + (((*dest)>>2) & TWO_OUT_15);
 		dest++;
@@ -3227,6 +3503,9 @@ static void pix_outline75_15(PIXVAL *dest, const PIXVAL *, const PIXVAL colour,
 static void pix_outline75_16(PIXVAL *dest, const PIXVAL *, const PIXVAL colour, const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	dest += outline_span_sse2<blend75_sse2>( dest, colour, TWO_OUT_16, len );
+#endif
 	while (dest < end) {
 		*dest = (3*((colour>>2) & TWO_OUT_16)) + (((*dest)>>2) & TWO_OUT_16);
 		dest++;
@@ -3237,6 +3516,9 @@ static void pix_outline75_16(PIXVAL *dest, const PIXVAL *, const PIXVAL colour,
 static void pix_outline50_15(PIXVAL *dest, const PIXVAL *, const PIXVAL colour, const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	dest += outline_span_sse2<blend50_sse2>( dest, colour, ONE_OUT_15, len );
+#endif
 	while (dest < end) {
 		*dest = ((colour>>1) & ONE_OUT_15) + (((*dest)>>1) & ONE_OUT_15);
 		dest++;
@@ -3247,6 +3529,9 @@ static void pix_outline50_15(PIXVAL *dest, const PIXVAL *, const PIXVAL colour,
 static void pix_outline50_16(PIXVAL *dest, const PIXVAL *, const PIXVAL colour, const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	dest += outline_span_sse2<blend50_sse2>( dest, colour, ONE_OUT_16, len );
+#endif
 	while (dest < end) {
 		*dest = ((colour>>1) & ONE_OUT_16) + (((*dest)>>1) & ONE_OUT_16);
 		dest++;
@@ -3257,6 +3542,9 @@ static void pix_outline50_16(PIXVAL *dest, const PIXVAL *, const PIXVAL colour,
 static void pix_outline25_15(PIXVAL *dest, const PIXVAL *, const PIXVAL colour, const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	dest += outline_span_sse2<blend25_sse2>( dest, colour, TWO_OUT_15, len );
+#endif
 	while (dest < end) {
 		*dest = ((colour>>2) & TWO_OUT_15) + (3*(((*dest)>>2) & TWO_OUT_15));
 		dest++;
@@ -3267,6 +3555,9 @@ static void pix_outline25_15(PIXVAL *dest, const PIXVAL *, const PIXVAL colour,
 static void pix_outline25_16(PIXVAL *dest, const PIXVAL *, const PIXVAL colour, const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	dest += outline_span_sse2<blend25_sse2>( dest, colour, TWO_OUT_16, len );
+#endif
 	while (dest < end) {
 		*dest = ((colour>>2) & TWO_OUT_16) + (3*(((*dest)>>2) & TWO_OUT_16));
 		dest++;
@@ -3414,10 +3705,76 @@ typedef void (*alpha_proc)(PIXVAL *dest, const PIXVAL *src, const PIXVAL *alpham
 static alpha_proc alpha;
 static alpha_proc alpha_recode;
 
+#ifdef USE_SSE2
+// one colour channel of (src * alpha + dest * (32 - alpha)) / 32
+template<int shift, PIXVAL max> static inline __m128i alpha_channel_sse2(const __m128i src, const __m128i dest, const __m128i alpha, const __m128i inv_alpha)
+{
+	const __m128i m = _mm_set1_epi16( max );
+	const __m128i s = _mm_and_si128( _mm_srli_epi16( src, shift ), m );
+	const __m128i d = _mm_and_si128( _mm_srli_epi16( dest, shift ), m );
+	const __m128i c = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( s, alpha ), _mm_mullo_epi16( d, inv_alpha ) ), 5 );
+	return _mm_slli_epi16( c, shift );
+}
+
+/*
+ * The same as the loops of pix_alpha_xx() for blocks of eight pixels, but without branches:
+ * an alpha value above 30 becomes 32 and selects the source, and an alpha value of 0 keeps the destination.
+ */
+template<bool rgb565, bool recode> static inline PIXVAL alpha_span_sse2(PIXVAL *dest, const PIXVAL *src, const PIXVAL *alphamap, const unsigned alpha_flags, const PIXVAL len)
+{
+	const __m128i rmask = _mm_set1_epi16( alpha_flags & ALPHA_RED ? 0x7c00 : 0 );
+	const __m128i gmask = _mm_set1_epi16( alpha_flags & ALPHA_GREEN ? 0x03e0 : 0 );
+	const __m128i bmask = _mm_set1_epi16( alpha_flags & ALPHA_BLUE ? 0x001f : 0 );
+	const __m128i thirtyone = _mm_set1_epi16( 31 );
+	const __m128i fifteen = _mm_set1_epi16( 15 );
+	const __m128i thirtytwo = _mm_set1_epi16( 32 );
+
+	PIXVAL i = 0;
+	for(  ;  i + 8 <= len;  i += 8  ) {
+		// read mask components - always 15bpp
+		const __m128i m = _mm_loadu_si128( (const __m128i *)(alphamap + i) );
+		__m128i a = _mm_add_epi16( _mm_and_si128( m, bmask ), _mm_add_epi16( _mm_srli_epi16( _mm_and_si128( m, gmask ), 5 ), _mm_srli_epi16( _mm_and_si128( m, rmask ), 10 ) ) );
+		a = _mm_min_epi16( a, thirtyone );
+		a = _mm_sub_epi16( a, _mm_cmpgt_epi16( a, fifteen ) ); // comparison is -1 where true
+		const __m128i inv_a = _mm_sub_epi16( thirtytwo, a );
+
+		__m128i s;
+		if(  recode  ) {
+			s = _mm_setr_epi16( rgbmap_current[src[i]], rgbmap_current[src[i+1]], rgbmap_current[src[i+2]], rgbmap_current[src[i+3]],
+				rgbmap_current[src[i+4]], rgbmap_current[src[i+5]], rgbmap_current[src[i+6]], rgbmap_current[src[i+7]] );
+		}
+		else {
+			s = _mm_loadu_si128( (const __m128i *)(src + i) );
+		}
+		const __m128i d = _mm_loadu_si128( (const __m128i *)(dest + i) );
+
+		__m128i result;
+		if(  rgb565  ) {
+			result = _mm_or_si128( alpha_channel_sse2<11, 0x1f>( s, d, a, inv_a ), _mm_or_si128( alpha_channel_sse2<5, 0x3f>( s, d, a, inv_a ), alpha_channel_sse2<0, 0x1f>( s, d, a, inv_a ) ) );
+		}
+		else {
+			result = _mm_or_si128( alpha_channel_sse2<10, 0x1f>( s, d, a, inv_a ), _mm_or_si128( alpha_channel_sse2<5, 0x1f>( s, d, a, inv_a ), alpha_channel_sse2<0, 0x1f>( s, d, a, inv_a ) ) );
+		}
+		// where alpha is 0 or 32, take the pixel unchanged, like the plain loop (matters for the unused top bit in 555)
+		const __m128i keep_dest = _mm_cmpeq_epi16( a, _mm_setzero_si128() );
+		const __m128i copy_src = _mm_cmpeq_epi16( a, thirtytwo );
+		result = _mm_or_si128( _mm_andnot_si128( _mm_or_si128( keep_dest, copy_src ), result ), _mm_or_si128( _mm_and_si128( keep_dest, d ), _mm_and_si128( copy_src, s ) ) );
+		_mm_storeu_si128( (__m128i *)(dest + i), result );
+	}
+	return i;
+}
+#endif
+
 
 static void pix_alpha_15(PIXVAL *dest, const PIXVAL *src, const PIXVAL *alphamap, const unsigned alpha_flags, const PIXVAL , const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	const PIXVAL done = alpha_span_sse2<false, false>( dest, src, alphamap, alpha_flags, len );
+	dest += done;
+	src += done;
+	alphamap += done;
+#endif
 
 	const uint16 rmask = alpha_flags & ALPHA_RED ? 0x7c00 : 0;
 	const uint16 gmask = alpha_flags & ALPHA_GREEN ? 0x03e0 : 0;
@@ -3458,6 +3815,12 @@ static void pix_alpha_15(PIXVAL *dest, const PIXVAL *src, const PIXVAL *alphamap
 static void pix_alpha_16(PIXVAL *dest, const PIXVAL *src, const PIXVAL *alphamap, const unsigned alpha_flags, const PIXVAL , const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	const PIXVAL done = alpha_span_sse2<true, false>( dest, src, alphamap, alpha_flags, len );
+	dest += done;
+	src += done;
+	alphamap += done;
+#endif
 
 	const uint16 rmask = alpha_flags & ALPHA_RED ? 0x7c00 : 0;
 	const uint16 gmask = alpha_flags & ALPHA_GREEN ? 0x03e0 : 0;
@@ -3498,6 +3861,12 @@ static void pix_alpha_16(PIXVAL *dest, const PIXVAL *src, const PIXVAL *alphamap
 static void pix_alpha_recode_15(PIXVAL *dest, const PIXVAL *src, const PIXVAL *alphamap, const unsigned alpha_flags, const PIXVAL , const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	const PIXVAL done = alpha_span_sse2<false, true>( dest, src, alphamap, alpha_flags, len );
+	dest += done;
+	src += done;
+	alphamap += done;
+#endif
 
 	const uint16 rmask = alpha_flags & ALPHA_RED ? 0x7c00 : 0;
 	const uint16 gmask = alpha_flags & ALPHA_GREEN ? 0x03e0 : 0;
@@ -3538,6 +3907,12 @@ static void pix_alpha_recode_15(PIXVAL *dest, const PIXVAL *src, const PIXVAL *a
 static void pix_alpha_recode_16(PIXVAL *dest, const PIXVAL *src, const PIXVAL *alphamap, const unsigned alpha_flags, const PIXVAL , const PIXVAL len)
 {
 	const PIXVAL *const end = dest + len;
+#ifdef USE_SSE2
+	const PIXVAL done = alpha_span_sse2<true, true>( dest, src, alphamap, alpha_flags, len );
+	dest += done;
+	src += done;
+	alphamap += done;
+#endif
 
 	const uint16 rmask = alpha_flags & ALPHA_RED ? 0x7c00 : 0;
 	const uint16 gmask = alpha_flags & ALPHA_GREEN ? 0x03e0 : 0;
@@ -5354,10 +5729,6 @@ void simgraph_init(scr_size window_size, bool full_screen)
 	disp_actual_width = window_size.w;
 	disp_height = window_size.h;
 
-#ifdef MULTI_THREAD
-	pthread_mutex_init( &recode_img_mutex, NULL );
-#endif
-
 	// init rezoom_img()
 	for(  int i = 0;  i < MAX_THREADS;  i++  ) {
 #ifdef MULTI_THREAD
@@ -5484,7 +5855,6 @@ void simgraph_exit()
 	tile_dirty = tile_dirty_old = NULL;
 	images = NULL;
 #ifdef MULTI_THREAD
-	pthread_mutex_destroy( &recode_img_mutex );
 	for(  int i = 0;  i < MAX_THREADS;  i++  ) {
 		pthread_mutex_destroy( &rezoom_img_mutex[i] );
 	}
@@ -4,6 +4,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 
 #include "../simworld.h"
 #include "simview.h"
@@ -47,6 +48,8 @@ static const sint8 hours2night[] =
 #endif
 
 #ifdef MULTI_THREAD
+#include <chrono>
+
 #include "../utils/simthread.h"
 
 bool spawned_threads=false; // global job indicator array
@@ -66,14 +69,90 @@ typedef struct{
 // now the parameters
 static display_region_param_t ka[MAX_THREADS];
 
+/*
+ * The screen is divided into one vertical strip per thread. Since the cost of drawing
+ * is very uneven (open water against a dense city), the strips are not of equal width:
+ * after each frame their edges are moved so that each strip would have taken the same time.
+ */
+static uint32 strip_cost[MAX_THREADS]; // time taken to draw each strip in the last frame, in microseconds
+
+static inline uint32 get_strip_time()
+{
+	return (uint32)std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+#if COLOUR_DEPTH != 0
+static scr_coord_val strip_lt_x[MAX_THREADS+1]; // left edge of each strip; strip_lt_x[num_strips] is the display width
+static int num_strips = 0;
+
+static void reset_display_strips( scr_coord_val disp_width, int strips )
+{
+	num_strips = strips;
+	for(  int t = 0;  t <= strips;  t++  ) {
+		strip_lt_x[t] = (scr_coord_val)( (sint32)disp_width * t / strips );
+	}
+	for(  int t = 0;  t < strips;  t++  ) {
+		strip_cost[t] = 0;
+	}
+}
+
+// moves the strip edges for the next frame, assuming the cost is spread evenly within each strip
+static void balance_display_strips( scr_coord_val min_width )
+{
+	const scr_coord_val disp_width = strip_lt_x[num_strips];
+	uint64 total_cost = 0;
+	for(  int t = 0;  t < num_strips;  t++  ) {
+		total_cost += strip_cost[t];
+	}
+	if(  total_cost < (uint64)num_strips * 100  ||  disp_width < min_width * num_strips  ) {
+		// too little was drawn to tell, or no room to move
+		return;
+	}
+
+	scr_coord_val new_lt_x[MAX_THREADS+1];
+	new_lt_x[0] = 0;
+	new_lt_x[num_strips] = disp_width;
+
+	int s = 0;
+	uint64 cost_before = 0; // cost of the strips left of strip s
+	for(  int t = 1;  t < num_strips;  t++  ) {
+		const uint64 target = total_cost * t / num_strips;
+		while(  s < num_strips - 1  &&  cost_before + strip_cost[s] < target  ) {
+			cost_before += strip_cost[s];
+			s++;
+		}
+		const sint64 width = strip_lt_x[s+1] - strip_lt_x[s];
+		const sint64 x = strip_lt_x[s] + (sint64)min( target - cost_before, (uint64)strip_cost[s] ) * width / max( strip_cost[s], 1u );
+		// only go halfway, so the edges do not swing back and forth with the noise of the timing
+		new_lt_x[t] = (scr_coord_val)( (strip_lt_x[t] + x) / 2 );
+	}
+
+	// keep every strip at least min_width wide
+	for(  int t = 1;  t < num_strips;  t++  ) {
+		new_lt_x[t] = max( new_lt_x[t], (scr_coord_val)(new_lt_x[t-1] + min_width) );
+	}
+	for(  int t = num_strips - 1;  t > 0;  t--  ) {
+		new_lt_x[t] = min( new_lt_x[t], (scr_coord_val)(new_lt_x[t+1] - min_width) );
+	}
+
+	for(  int t = 1;  t < num_strips;  t++  ) {
+		strip_lt_x[t] = new_lt_x[t];
+	}
+}
+#endif
+
 void *display_region_thread( void *ptr )
 {
 	display_region_param_t *view = reinterpret_cast<display_region_param_t *>(ptr);
 	while(true) {
 		simthread_barrier_wait( &display_barrier_start ); // wait for all to start
-		clear_all_poly_clip( view->thread_num );
-		display_set_clip_wh( view->lt_cl.x, view->lt_cl.y, view->wh_cl.x, view->wh_cl.y, view->thread_num );
-		view->show_routine->display_region( view->lt, view->wh, view->y_min, view->y_max, false, true, view->thread_num );
+		const uint32 start = get_strip_time();
+		if(  view->wh_cl.x > 0  ) {
+			clear_all_poly_clip( view->thread_num );
+			display_set_clip_wh( view->lt_cl.x, view->lt_cl.y, view->wh_cl.x, view->wh_cl.y, view->thread_num );
+			view->show_routine->display_region( view->lt, view->wh, view->y_min, view->y_max, false, true, view->thread_num );
+		}
+		strip_cost[view->thread_num] = get_strip_time() - start;
 		simthread_barrier_wait( &display_barrier_end ); // wait for all to finish
 	}
 	return ptr;
@@ -149,14 +228,64 @@ void main_view_t::display(bool force_dirty)
 		display_day_night_shift(hours2night[hours2]+env_t::daynight_level);
 	}
 
+	// While the view stands still, only what has changed since the last frame needs to be drawn again.
+	// Any move or zoom marks the screen dirty anyway; this also catches those which do not.
+	static sint32 last_view[7];
+	const sint32 view[7] = { i_off, j_off, const_x_off, const_y_off, IMG_SIZE, disp_width, disp_height };
+	const bool view_moved = memcmp( view, last_view, sizeof(view) ) != 0;
+	memcpy( last_view, view, sizeof(view) );
+	const bool changes_only = env_t::redraw_changes_only  &&  !view_moved  &&  !env_t::hide_under_cursor;
+
+	obj_t *zeiger = welt->get_zeiger();
+	if(  changes_only  &&  zeiger  &&  zeiger->get_pos() != koord3d::invalid  ) {
+		// the cursor is blended onto the ground, so it must be drawn on a freshly drawn tile
+		const scr_coord pos = viewport->get_screen_coord( zeiger->get_pos() );
+		mark_rect_dirty_wc( pos.x, pos.y - IMG_SIZE, pos.x + IMG_SIZE - 1, pos.y + 2 * IMG_SIZE - 1 );
+	}
+
+	// the parts of the view to draw, one strip for each thread
+	int num_parts = 1;
+#ifdef MULTI_THREAD
+	if(  can_multithreading  ) {
+		num_parts = env_t::num_threads;
+		if(  num_strips != env_t::num_threads  ||  strip_lt_x[num_strips] != disp_width  ) {
+			reset_display_strips( disp_width, env_t::num_threads );
+		}
+	}
+#endif
+	// Drawing is clipped to redraw_rect, but the tiles are chosen over the full height of the view:
+	// trees, buildings and vehicles may reach far above the tile on which they stand.
+	scr_rect redraw_rect[MAX_THREADS];
+	scr_rect tiles_rect[MAX_THREADS];
+	for(  int t = 0;  t < num_parts;  t++  ) {
+		scr_rect part( 0, menu_height, disp_width, disp_height - menu_height );
+#ifdef MULTI_THREAD
+		if(  num_parts > 1  ) {
+			part.x = strip_lt_x[t];
+			part.w = strip_lt_x[t+1] - strip_lt_x[t];
+		}
+#endif
+		if(  !changes_only  ) {
+			redraw_rect[t] = part;
+		}
+		else if(  !display_get_dirty_rect( part, redraw_rect[t] )  ) {
+			redraw_rect[t] = scr_rect( part.x, part.y, 0, 0 );
+		}
+		tiles_rect[t] = scr_rect( redraw_rect[t].x, part.y, redraw_rect[t].w, part.h );
+	}
+
 	// not very elegant, but works:
 	// fill everything with black for Underground mode ...
 	if( grund_t::underground_mode ) {
-		display_fillbox_wh_rgb(0, menu_height, disp_width, disp_height-menu_height, color_idx_to_rgb(COL_BLACK), force_dirty);
+		for(  int t = 0;  t < num_parts;  t++  ) {
+			display_fillbox_wh_rgb( redraw_rect[t].x, redraw_rect[t].y, redraw_rect[t].w, redraw_rect[t].h, color_idx_to_rgb(COL_BLACK), force_dirty );
+		}
 	}
 	else if( welt->is_background_dirty()  &&  outside_visible  ) {
 		// we check if background will be visible, no need to clear screen if it's not.
-		display_background(0, menu_height, disp_width, disp_height-menu_height, force_dirty);
+		for(  int t = 0;  t < num_parts;  t++  ) {
+			display_background( redraw_rect[t].x, redraw_rect[t].y, redraw_rect[t].w, redraw_rect[t].h, force_dirty );
+		}
 		welt->unset_background_dirty();
 		// reset
 		outside_visible = false;
@@ -212,18 +341,15 @@ void main_view_t::display(bool force_dirty)
 		}
 
 		// set parameter for each thread
-		const scr_coord_val wh_x = disp_width / env_t::num_threads;
-		scr_coord_val lt_x = 0;
 		for(  int t = 0;  t < env_t::num_threads - 1;  t++  ) {
 			ka[t].show_routine = this;
-			ka[t].lt_cl = koord( lt_x, menu_height );
-			ka[t].wh_cl = koord( wh_x, disp_height - menu_height );
-			ka[t].lt = ka[t].lt_cl - koord( IMG_SIZE/2, 0 ); // process tiles IMG_SIZE/2 outside clipping range for correct tree display at thread seams
-			ka[t].wh = ka[t].wh_cl + koord( IMG_SIZE, 0 );
+			ka[t].lt_cl = koord( redraw_rect[t].x, redraw_rect[t].y );
+			ka[t].wh_cl = koord( redraw_rect[t].w, redraw_rect[t].h );
+			ka[t].lt = koord( tiles_rect[t].x - IMG_SIZE/2, tiles_rect[t].y ); // process tiles IMG_SIZE/2 outside clipping range for correct tree display at thread seams
+			ka[t].wh = koord( tiles_rect[t].w + IMG_SIZE, tiles_rect[t].h );
 			ka[t].y_min = y_min;
 			ka[t].y_max = dpy_height + 4 * 4;
 			ka[t].thread_num = t;
-			lt_x += wh_x;
 		}
 
 		// init variables required to draw smart cursor
@@ -233,52 +359,78 @@ void main_view_t::display(bool force_dirty)
 		// and start drawing
 		simthread_barrier_wait( &display_barrier_start );
 
-		// the last we can run ourselves, setting clip_wh to the screen edge instead of wh_x (in case disp_width % num_threads != 0)
-		clear_all_poly_clip( env_t::num_threads - 1 );
-		display_set_clip_wh( lt_x, menu_height, disp_width - lt_x, disp_height - menu_height, env_t::num_threads - 1 );
- 		display_region( koord( lt_x - IMG_SIZE / 2, menu_height ), koord( disp_width - lt_x + IMG_SIZE, disp_height - menu_height ), y_min, dpy_height + 4 * 4, false, true, env_t::num_threads - 1 );
+		// the last we can run ourselves, up to the screen edge
+		const uint32 start = get_strip_time();
+		const scr_rect &last = redraw_rect[env_t::num_threads - 1];
+		const scr_rect &last_tiles = tiles_rect[env_t::num_threads - 1];
+		if(  last.w > 0  ) {
+			clear_all_poly_clip( env_t::num_threads - 1 );
+			display_set_clip_wh( last.x, last.y, last.w, last.h, env_t::num_threads - 1 );
+			display_region( koord( last_tiles.x - IMG_SIZE / 2, last_tiles.y ), koord( last_tiles.w + IMG_SIZE, last_tiles.h ), y_min, dpy_height + 4 * 4, false, true, env_t::num_threads - 1 );
+		}
+		strip_cost[env_t::num_threads - 1] = get_strip_time() - start;
 
 		simthread_barrier_wait( &display_barrier_end );
 
+		balance_display_strips( IMG_SIZE );
+
 		clear_all_poly_clip( 0 );
 		display_set_clip_wh( 0, menu_height, disp_width, disp_height-menu_height );
 	}
 	else {
 		// slow serial way of display
-		clear_all_poly_clip( 0 );
-		display_region( koord( 0, menu_height ), koord( disp_width, disp_height - menu_height ), y_min, dpy_height + 4 * 4, false, false, 0 );
+		if(  redraw_rect[0].w > 0  ) {
+			clear_all_poly_clip( 0 );
+			display_set_clip_wh( redraw_rect[0].x, redraw_rect[0].y, redraw_rect[0].w, redraw_rect[0].h );
+			display_region( koord( tiles_rect[0].x, tiles_rect[0].y ), koord( tiles_rect[0].w, tiles_rect[0].h ), y_min, dpy_height + 4 * 4, false, false, 0 );
+		}
 	}
 #else
-	clear_all_poly_clip();
-	display_region( koord( 0, menu_height ), koord( disp_width, disp_height - menu_height ), y_min, dpy_height + 4 * 4, false );
+	if(  redraw_rect[0].w > 0  ) {
+		clear_all_poly_clip();
+		display_set_clip_wh( redraw_rect[0].x, redraw_rect[0].y, redraw_rect[0].w, redraw_rect[0].h );
+		display_region( koord( tiles_rect[0].x, tiles_rect[0].y ), koord( tiles_rect[0].w, tiles_rect[0].h ), y_min, dpy_height + 4 * 4, false );
+	}
 #endif
 
 	// and finally overlays (station coverage and signs)
-	bool plotted = false; // display overlays even on very large mountains
-	for(sint16 y=y_min; y<dpy_height+4*4  ||  plotted; y++) {
-		const sint16 ypos = y*(IMG_SIZE/4) + const_y_off;
-		plotted = false;
-
-		for(sint16 x=-2-((y+dpy_width) & 1); (x*(IMG_SIZE/2) + const_x_off)<disp_width; x+=2) {
-			const int i = ((y+x) >> 1) + i_off;
-			const int j = ((y-x) >> 1) + j_off;
-			const int xpos = x*(IMG_SIZE/2) + const_x_off;
-
-			if(  xpos+IMG_SIZE>0  ) {
-				const planquadrat_t *plan=welt->access(i,j);
-				if(plan  &&  plan->get_kartenboden()) {
-					const grund_t *gr = plan->get_kartenboden();
-					sint16 yypos = ypos - tile_raster_scale_y( min(gr->get_hoehe(),hmax_ground)*TILE_HEIGHT_STEP, IMG_SIZE);
-					if(  yypos-IMG_SIZE<disp_real_height  &&  yypos+IMG_SIZE>=menu_height  ) {
-						plan->display_overlay( xpos, yypos );
-						plotted = true;
+	// they are blended, so they must not be drawn again where the world was not
+	if(  !changes_only  ) {
+		num_parts = 1;
+		redraw_rect[0] = scr_rect( 0, menu_height, disp_width, disp_height - menu_height );
+	}
+	for(  int t = 0;  t < num_parts;  t++  ) {
+		if(  redraw_rect[t].w <= 0  ) {
+			continue;
+		}
+		display_set_clip_wh( redraw_rect[t].x, redraw_rect[t].y, redraw_rect[t].w, redraw_rect[t].h );
+
+		bool plotted = false; // display overlays even on very large mountains
+		for(sint16 y=y_min; y<dpy_height+4*4  ||  plotted; y++) {
+			const sint16 ypos = y*(IMG_SIZE/4) + const_y_off;
+			plotted = false;
+
+			for(sint16 x=-2-((y+dpy_width) & 1); (x*(IMG_SIZE/2) + const_x_off)<disp_width; x+=2) {
+				const int i = ((y+x) >> 1) + i_off;
+				const int j = ((y-x) >> 1) + j_off;
+				const int xpos = x*(IMG_SIZE/2) + const_x_off;
+
+				if(  xpos+IMG_SIZE>0  ) {
+					const planquadrat_t *plan=welt->access(i,j);
+					if(plan  &&  plan->get_kartenboden()) {
+						const grund_t *gr = plan->get_kartenboden();
+						sint16 yypos = ypos - tile_raster_scale_y( min(gr->get_hoehe(),hmax_ground)*TILE_HEIGHT_STEP, IMG_SIZE);
+						if(  yypos-IMG_SIZE<disp_real_height  &&  yypos+IMG_SIZE>=menu_height  ) {
+							plan->display_overlay( xpos, yypos );
+							plotted = true;
+						}
 					}
 				}
 			}
 		}
 	}
+	display_set_clip_wh( 0, menu_height, disp_width, disp_height-menu_height );
 
-	obj_t *zeiger = welt->get_zeiger();
 	DBG_DEBUG4("main_view_t::display", "display pointer");
 	if( zeiger  &&  zeiger->get_pos() != koord3d::invalid ) {
 		bool dirty = zeiger->get_flag(obj_t::dirty);
@@ -11,6 +11,7 @@
 #include "../simcolor.h"
 #include "../dataobj/settings.h"
 #include "../dataobj/environment.h"
+#include "../dataobj/private_car_routes.h"
 #include "../dataobj/translator.h"
 #include "../obj/baum.h"
 #include "../obj/zeiger.h"
@@ -169,6 +170,12 @@ gui_settings_t::gui_settings_t()
 		status_label.update();
 		add_component(&status_label);
 
+		new_component<gui_label_t>("Path matrix memory:");
+		path_matrix_memory_label.buf().printf("-");
+		path_matrix_memory_label.set_color(SYSCOL_TEXT_TITLE);
+		path_matrix_memory_label.update();
+		add_component(&path_matrix_memory_label);
+
 		// Private cars hereafter
 
 		new_component<gui_label_t>("Private car routes reading index:");
@@ -250,7 +257,10 @@ void gui_settings_t::draw(scr_coord offset)
 	reroute_goods_label.buf().printf("%lu", path_explorer_t::get_limit_reroute_goods());
 	reroute_goods_label.update();
 
-	reading_index_label.buf().printf("%lu", weg_t::private_car_routes_currently_reading_element);
+	path_matrix_memory_label.buf().printf(translator::translate("%lu KiB (%lu KiB saved)"), (unsigned long)(path_explorer_t::get_finished_matrix_memory() >> 10), (unsigned long)(path_explorer_t::get_finished_matrix_memory_saved() >> 10));
+	path_matrix_memory_label.update();
+
+	reading_index_label.buf().printf("%lu", private_car_routes_t::get_reading_element());
 	reading_index_label.update();
 
 	cities_awaiting_private_car_route_check_label.buf().printf("%lu", world()->get_cities_awaiting_private_car_route_check_count());
@@ -33,6 +33,7 @@ private:
 		explore_path_label,
 		reroute_goods_label,
 		status_label,
+		path_matrix_memory_label,
 
 		reading_index_label,
 		cities_awaiting_private_car_route_check_label,
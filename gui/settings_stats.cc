@@ -125,7 +125,9 @@ static const char *revision_ex[] =
 	"40",
 	"41",
 	"42",
-	"43"
+	"43",
+	"44",
+	"45"
 };
 
 
@@ -233,11 +235,14 @@ void settings_extended_general_stats_t::init( settings_t *sets )
 
 	INIT_NUM("path_explorer_time_midpoint", sets->get_path_explorer_time_midpoint(), 1, 2048, gui_numberinput_t::PLAIN, false);
 	INIT_BOOL("save_path_explorer_data", sets->get_save_path_explorer_data());
+	INIT_NUM("path_explorer_backend", sets->get_path_explorer_backend(), 0, settings_t::MAX_PATH_EXPLORER_BACKEND - 1, gui_numberinput_t::PLAIN, false);
+	INIT_NUM("route_landmarks", sets->get_route_landmarks(), 0, 32, gui_numberinput_t::PLAIN, false);
 
 	SEPERATOR;
 
 	INIT_BOOL("pause_server_no_clients", env_t::pause_server_no_clients);
 	INIT_BOOL("server_runs_background_tasks_when_paused", env_t::server_runs_background_tasks_when_paused);
+	INIT_BOOL("server_streamed_join", env_t::server_streamed_join);
 
 	SEPERATOR;
 
@@ -253,6 +258,7 @@ void settings_extended_general_stats_t::init( settings_t *sets )
 	INIT_NUM("do_not_record_private_car_routes_to_city_industries", sets->get_do_not_record_private_car_routes_to_city_industries(), 0, 65535, gui_numberinput_t::PLAIN, false);
 	INIT_BOOL("do_not_record_private_car_routes_to_distant_non_consumer_industries ", sets->get_do_not_record_private_car_routes_to_distant_non_consumer_industries());
 	INIT_BOOL("do_not_record_private_car_routes_to_city_buildings", sets->get_do_not_record_private_car_routes_to_city_buildings());
+	INIT_NUM("private_car_route_full_refresh_months", sets->get_private_car_route_full_refresh_months(), 0, 1200, gui_numberinput_t::PLAIN, false);
 
 	INIT_END
 }
@@ -353,9 +359,12 @@ void settings_extended_general_stats_t::read(settings_t *sets)
 
 	READ_NUM_VALUE(sets->path_explorer_time_midpoint);
 	READ_BOOL_VALUE(sets->save_path_explorer_data);
+	READ_NUM_VALUE(sets->path_explorer_backend);
+	READ_NUM_VALUE(sets->route_landmarks);
 
 	READ_BOOL_VALUE(env_t::pause_server_no_clients);
 	READ_BOOL_VALUE(env_t::server_runs_background_tasks_when_paused);
+	READ_BOOL_VALUE(env_t::server_streamed_join);
 
 	READ_BOOL_VALUE(sets->show_future_vehicle_info);
 
@@ -365,6 +374,7 @@ void settings_extended_general_stats_t::read(settings_t *sets)
 	READ_NUM_VALUE(sets->private_car_route_to_industry_visitor_demand_threshold);
 	READ_BOOL_VALUE(sets->do_not_record_private_car_routes_to_distant_non_consumer_industries);
 	READ_BOOL_VALUE(sets->do_not_record_private_car_routes_to_city_buildings);
+	READ_NUM_VALUE(sets->private_car_route_full_refresh_months);
 
 	path_explorer_t::set_absolute_limits_external();
 }
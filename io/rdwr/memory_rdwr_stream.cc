@@ -0,0 +1,72 @@
+/*
+ * This file is part of the Simutrans-Extended project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#include "memory_rdwr_stream.h"
+
+#include "../../macros.h"
+#include "../../simmem.h"
+
+#include <cassert>
+#include <cstring>
+
+
+#define MEMORY_BLOCK_SIZE (4 * 1024 * 1024)
+
+
+memory_rdwr_stream_t::memory_rdwr_stream_t() :
+	rdwr_stream_t(true),
+	last_block_len(MEMORY_BLOCK_SIZE)
+{
+	status = STATUS_OK;
+}
+
+
+memory_rdwr_stream_t::~memory_rdwr_stream_t()
+{
+	for (uint32 i = 0; i < blocks.get_count(); i++) {
+		free(blocks[i]);
+	}
+}
+
+
+size_t memory_rdwr_stream_t::read(void *, size_t)
+{
+	assert(false);
+	status = STATUS_ERR_CORRUPT;
+	return 0;
+}
+
+
+size_t memory_rdwr_stream_t::write(const void *buf, size_t len)
+{
+	assert(is_writing());
+
+	const char *src = (const char *)buf;
+	size_t left = len;
+	while (left > 0) {
+		if (last_block_len == MEMORY_BLOCK_SIZE) {
+			blocks.append(MALLOCN(char, MEMORY_BLOCK_SIZE));
+			last_block_len = 0;
+		}
+		const size_t n = min(left, (size_t)(MEMORY_BLOCK_SIZE - last_block_len));
+		memcpy(blocks.back() + last_block_len, src, n);
+		last_block_len += n;
+		src += n;
+		left -= n;
+	}
+	return len;
+}
+
+
+bool memory_rdwr_stream_t::write_to(rdwr_stream_t *dest) const
+{
+	for (uint32 i = 0; i < blocks.get_count(); i++) {
+		const size_t len = (i + 1 == blocks.get_count()) ? last_block_len : MEMORY_BLOCK_SIZE;
+		if (len > 0  &&  dest->write(blocks[i], len) != len) {
+			return false;
+		}
+	}
+	return dest->get_status() == STATUS_OK;
+}
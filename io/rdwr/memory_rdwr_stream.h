@@ -0,0 +1,41 @@
+/*
+ * This file is part of the Simutrans-Extended project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef IO_RDWR_MEMORY_RDWR_STREAM_H
+#define IO_RDWR_MEMORY_RDWR_STREAM_H
+
+
+#include "rdwr_stream.h"
+
+#include "../../tpl/vector_tpl.h"
+
+
+/**
+ * Collects the written data in memory, so that it can be passed on to another stream later.
+ * The data is kept in blocks, so it is never copied while growing. Cannot be read from.
+ */
+class memory_rdwr_stream_t : public rdwr_stream_t
+{
+public:
+	memory_rdwr_stream_t();
+	~memory_rdwr_stream_t();
+
+public:
+	/// @copydoc rdwr_stream_t::read
+	size_t read(void *buf, size_t len) OVERRIDE;
+
+	/// @copydoc rdwr_stream_t::write
+	size_t write(const void *buf, size_t len) OVERRIDE;
+
+	/// Writes all data collected so far to @p dest. @returns false if @p dest failed.
+	bool write_to(rdwr_stream_t *dest) const;
+
+private:
+	vector_tpl<char *> blocks;
+	size_t last_block_len; ///< bytes used in the last block
+};
+
+
+#endif
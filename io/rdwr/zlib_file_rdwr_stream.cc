@@ -8,13 +8,80 @@
 #include "../../sys/simsys.h"
 #include "../../macros.h"
 #include "../../simdebug.h"
+#include "../../simmem.h"
+
+#ifdef MULTI_THREAD
+#include "../../dataobj/environment.h"
+#endif
 
 #include <cassert>
+#include <cstring>
+
+
+// uncompressed size of a gzip member when compressing in parallel
+#define ZLIB_CHUNK_SIZE (1024 * 1024)
 
 
 zlib_file_rdwr_stream_t::zlib_file_rdwr_stream_t(const std::string &filename, bool writing, int compression) :
 	rdwr_stream_t(writing)
 {
+	gzfp = NULL;
+#ifdef MULTI_THREAD
+	fp = NULL;
+	chunks = NULL;
+	num_chunks = 0;
+	filled = 0;
+	anything_written = false;
+	finishing = false;
+	workers = NULL;
+	threads = NULL;
+
+	if (is_writing()  &&  env_t::num_threads > 1) {
+		fp = dr_fopen(filename.c_str(), "wb");
+		if (!fp) {
+			status = STATUS_ERR_NOT_EXISTING;
+			return;
+		}
+
+		// chunk 0 is compressed by the thread which writes, one more for each thread that could be started
+		workers = MALLOCN(worker_t, env_t::num_threads);
+		threads = MALLOCN(pthread_t, env_t::num_threads);
+		pthread_mutex_init(&start_mutex, NULL);
+		pthread_mutex_lock(&start_mutex);
+		num_chunks = 1;
+		while (num_chunks < env_t::num_threads) {
+			workers[num_chunks].stream = this;
+			workers[num_chunks].index = num_chunks;
+			if (pthread_create(&threads[num_chunks], NULL, compress_thread, &workers[num_chunks]) != 0) {
+				dbg->warning("zlib_file_rdwr_stream_t::zlib_file_rdwr_stream_t", "Could only start %d compression threads", num_chunks - 1);
+				break;
+			}
+			num_chunks++;
+		}
+		simthread_barrier_init(&barrier, NULL, num_chunks);
+
+		compression = clamp( compression, 1, 9 );
+		chunks = MALLOCN(chunk_t, num_chunks);
+		for (int i = 0; i < num_chunks; i++) {
+			chunk_t &chunk = chunks[i];
+			memset(&chunk.zs, 0, sizeof(z_stream));
+			// windowBits 15+16: deflate with gzip header and trailer
+			if (deflateInit2(&chunk.zs, compression, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+				dbg->fatal("zlib_file_rdwr_stream_t::zlib_file_rdwr_stream_t", "Cannot init deflate");
+			}
+			chunk.in = MALLOCN(char, ZLIB_CHUNK_SIZE);
+			chunk.in_len = 0;
+			chunk.out = MALLOCN(char, deflateBound(&chunk.zs, ZLIB_CHUNK_SIZE));
+			chunk.out_len = 0;
+			chunk.ok = true;
+		}
+		pthread_mutex_unlock(&start_mutex);
+
+		status = STATUS_OK;
+		return;
+	}
+#endif
+
 	if (is_writing()) {
 		compression = clamp( compression, 1, 9 );
 		char compr[4] = { 'w', 'b', (char)('0' + compression), 0 };
@@ -30,6 +97,39 @@ zlib_file_rdwr_stream_t::zlib_file_rdwr_stream_t(const std::string &filename, bo
 
 zlib_file_rdwr_stream_t::~zlib_file_rdwr_stream_t()
 {
+#ifdef MULTI_THREAD
+	if (chunks) {
+		// the last, partly filled chunk; an empty file still needs one (empty) member
+		if (chunks[filled].in_len > 0  ||  !anything_written) {
+			filled++;
+		}
+		if (filled > 0) {
+			compress_chunks();
+		}
+
+		finishing = true;
+		simthread_barrier_wait(&barrier);
+		for (int i = 1; i < num_chunks; i++) {
+			pthread_join(threads[i], NULL);
+		}
+		simthread_barrier_destroy(&barrier);
+		pthread_mutex_destroy(&start_mutex);
+
+		for (int i = 0; i < num_chunks; i++) {
+			deflateEnd(&chunks[i].zs);
+			free(chunks[i].in);
+			free(chunks[i].out);
+		}
+		free(chunks);
+		free(workers);
+		free(threads);
+	}
+	if (fp) {
+		fclose(fp);
+		return;
+	}
+#endif
+
 	if (is_writing()) {
 		gzflush(gzfp, Z_FINISH);
 	}
@@ -38,6 +138,64 @@ zlib_file_rdwr_stream_t::~zlib_file_rdwr_stream_t()
 }
 
 
+#ifdef MULTI_THREAD
+void zlib_file_rdwr_stream_t::compress_chunk(chunk_t &chunk)
+{
+	deflateReset(&chunk.zs);
+	chunk.zs.next_in = (Bytef *)chunk.in;
+	chunk.zs.avail_in = (uInt)chunk.in_len;
+	chunk.zs.next_out = (Bytef *)chunk.out;
+	chunk.zs.avail_out = (uInt)deflateBound(&chunk.zs, ZLIB_CHUNK_SIZE);
+	chunk.ok = deflate(&chunk.zs, Z_FINISH) == Z_STREAM_END;
+	chunk.out_len = (size_t)((char *)chunk.zs.next_out - chunk.out);
+}
+
+
+void *zlib_file_rdwr_stream_t::compress_thread(void *ptr)
+{
+	worker_t *worker = reinterpret_cast<worker_t *>(ptr);
+	zlib_file_rdwr_stream_t *stream = worker->stream;
+
+	// the barrier is set up once all threads are started
+	pthread_mutex_lock(&stream->start_mutex);
+	pthread_mutex_unlock(&stream->start_mutex);
+
+	while (true) {
+		simthread_barrier_wait(&stream->barrier); // wait for full chunks
+		if (stream->finishing) {
+			break;
+		}
+		if (worker->index < stream->filled) {
+			compress_chunk(stream->chunks[worker->index]);
+		}
+		simthread_barrier_wait(&stream->barrier); // all chunks compressed
+	}
+	return ptr;
+}
+
+
+void zlib_file_rdwr_stream_t::compress_chunks()
+{
+	simthread_barrier_wait(&barrier);
+	compress_chunk(chunks[0]);
+	simthread_barrier_wait(&barrier);
+
+	// written in order, since each member must follow the one before
+	for (int i = 0; i < filled; i++) {
+		if (!chunks[i].ok) {
+			dbg->error("zlib_file_rdwr_stream_t::compress_chunks", "Cannot compress data");
+			status = STATUS_ERR_CORRUPT;
+		}
+		else if (fwrite(chunks[i].out, 1, chunks[i].out_len, fp) != chunks[i].out_len) {
+			status = STATUS_ERR_FULL;
+		}
+		chunks[i].in_len = 0;
+	}
+	filled = 0;
+}
+#endif
+
+
 size_t zlib_file_rdwr_stream_t::read(void *buf, size_t len)
 {
 	assert(!is_writing());
@@ -70,6 +228,28 @@ size_t zlib_file_rdwr_stream_t::read(void *buf, size_t len)
 size_t zlib_file_rdwr_stream_t::write(const void *buf, size_t len)
 {
 	assert(is_writing());
+#ifdef MULTI_THREAD
+	if (fp) {
+		const char *src = (const char *)buf;
+		size_t left = len;
+		while (left > 0) {
+			chunk_t &chunk = chunks[filled];
+			const size_t n = min(left, (size_t)(ZLIB_CHUNK_SIZE - chunk.in_len));
+			memcpy(chunk.in + chunk.in_len, src, n);
+			chunk.in_len += n;
+			src += n;
+			left -= n;
+			if (chunk.in_len == ZLIB_CHUNK_SIZE) {
+				filled++;
+				if (filled == num_chunks) {
+					compress_chunks();
+				}
+			}
+		}
+		anything_written = true;
+		return status == STATUS_OK ? len : 0;
+	}
+#endif
 	const int bytes_written = gzwrite(gzfp, const_cast<void *>(buf), len);
 
 	if (bytes_written == 0) {
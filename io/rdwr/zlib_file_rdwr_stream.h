@@ -10,9 +10,20 @@
 #include "rdwr_stream.h"
 
 #include <zlib.h>
+#include <cstdio>
+
+#ifdef MULTI_THREAD
+#include "../../utils/simthread.h"
+#endif
 
 
-/// Reads/writes data from/to a zlib/gzip (deflate) compressed file.
+/**
+ * Reads/writes data from/to a zlib/gzip (deflate) compressed file.
+ *
+ * With several threads, the data is written in chunks which are compressed at the same time,
+ * each into a gzip member of its own. A gzip file may consist of any number of members,
+ * so such files are read like any other (also by older versions).
+ */
 class zlib_file_rdwr_stream_t : public rdwr_stream_t
 {
 public:
@@ -28,6 +39,43 @@ public:
 
 private:
 	gzFile gzfp;
+
+#ifdef MULTI_THREAD
+	struct chunk_t
+	{
+		z_stream zs;
+		char *in;
+		size_t in_len;
+		char *out;
+		size_t out_len;
+		bool ok;
+	};
+
+	struct worker_t
+	{
+		zlib_file_rdwr_stream_t *stream;
+		int index;
+	};
+
+	/// File for the compressed chunks; NULL when gzfp is used instead
+	FILE *fp;
+
+	chunk_t *chunks;
+	int num_chunks;  ///< one for each thread
+	int filled;      ///< number of full chunks
+	bool anything_written;
+	bool finishing;  ///< tells the threads to exit
+
+	worker_t *workers;
+	pthread_t *threads;
+	simthread_barrier_t barrier;
+	pthread_mutex_t start_mutex; ///< holds the threads back until it is known how many started
+
+	/// Compresses chunks[0..filled) in parallel and writes them to the file
+	void compress_chunks();
+	static void compress_chunk(chunk_t &chunk);
+	static void *compress_thread(void *ptr);
+#endif
 };
 
 
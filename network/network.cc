@@ -32,6 +32,20 @@
 
 #include "../utils/simstring.h"
 #include "../tpl/slist_tpl.h"
+#include "../macros.h"
+
+#include <algorithm>
+
+#if !USE_WINSOCK  &&  !defined(__BEOS__)
+#include <poll.h>
+#endif
+
+// Linux: wait for the sockets of socket_list_t with epoll instead of select(), which
+// has to be given all sockets again on every call and cannot take more than FD_SETSIZE
+#if !USE_WINSOCK  &&  defined(__linux__)  &&  !defined(NO_EPOLL)
+#define USE_EPOLL
+#include <sys/epoll.h>
+#endif
 
 static bool network_active = false;
 uint16 network_server_port = 0;
@@ -488,12 +502,153 @@ network_command_t* network_get_received_command()
 }
 
 
+#ifdef USE_EPOLL
+// epoll instance watching the sockets of socket_list_t, -1 if not yet created
+static int epoll_fd = -1;
+// true if epoll failed, then select() is used
+static bool epoll_failed = false;
+#endif
+
+
+void network_watch_socket(SOCKET sock)
+{
+#ifdef USE_EPOLL
+	if (epoll_failed) {
+		return;
+	}
+	if (epoll_fd == -1) {
+		epoll_fd = epoll_create(64);
+	}
+	struct epoll_event ev;
+	ev.events = EPOLLIN;
+	ev.data.u64 = 0;
+	ev.data.fd = sock;
+	if (epoll_fd == -1  ||  (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, sock, &ev) == -1  &&  errno != EEXIST)) {
+		dbg->warning("network_watch_socket()", "epoll failed (%s), using select() instead", strerror(errno));
+		if (epoll_fd != -1) {
+			close(epoll_fd);
+			epoll_fd = -1;
+		}
+		epoll_failed = true;
+	}
+#else
+	(void)sock;
+#endif
+}
+
+
+/**
+ * waits until sock can be read from, or written to if write is true
+ * @return true if the socket is ready (or has an error, which the next recv/send will report)
+ */
+static bool network_wait_socket(SOCKET sock, bool write, int timeout_ms)
+{
+#if USE_WINSOCK  ||  defined(__BEOS__)
+	fd_set fds;
+	FD_ZERO(&fds);
+	FD_SET(sock, &fds);
+	struct timeval tv;
+	tv.tv_sec = timeout_ms / 1000;
+	tv.tv_usec = (timeout_ms % 1000) * 1000ul;
+	return select(FD_SETSIZE, write ? NULL : &fds, write ? &fds : NULL, NULL, &tv) == 1;
+#else
+	// unlike select(), poll() also works for sockets beyond FD_SETSIZE
+	struct pollfd pfd;
+	pfd.fd = sock;
+	pfd.events = write ? POLLOUT : POLLIN;
+	pfd.revents = 0;
+	return poll(&pfd, 1, timeout_ms) == 1;
+#endif
+}
+
+
+// server: accept connection to a new client
+static void network_accept_client(SOCKET accept_sock)
+{
+	struct sockaddr_in client_name;
+	socklen_t size = sizeof(client_name);
+	SOCKET s = accept(accept_sock, (struct sockaddr *)&client_name, &size);
+	if (s != INVALID_SOCKET) {
+#if USE_WINSOCK
+		uint32 ip = ntohl((uint32)client_name.sin_addr.S_un.S_addr);
+#else
+		uint32 ip = ntohl((uint32)client_name.sin_addr.s_addr);
+#endif
+		if (blacklist.contains(net_address_t(ip))) {
+			// refuse connection
+			network_close_socket(s);
+			return;
+		}
+#ifdef  __BEOS__
+		char name[256];
+		sprintf(name, "%lh", client_name.sin_addr.s_addr);
+#else
+		const char *name = inet_ntoa(client_name.sin_addr);
+#endif
+		dbg->message("check_activity()", "Accepted connection from: %s.", name);
+		socket_list_t::add_client(s, ip);
+	}
+}
+
+
+static void network_receive_from_client(SOCKET sender)
+{
+	if (socket_list_t::has_client(sender)) {
+		uint32 client_id = socket_list_t::get_client_id(sender);
+		network_command_t *nwc = socket_list_t::get_client(client_id).receive_nwc();
+		if (nwc) {
+			received_command_queue.append(nwc);
+			dbg->message("network_check_activity()", "received cmd id=%d %s from socket[%d]", nwc->get_id(), nwc->get_name(), sender);
+		}
+		// errors are caught and treated in socket_info_t::receive_nwc
+	}
+}
+
+
 /* do appropriate action for network games:
 * - server: accept connection to a new client
 * - all: receive commands and puts them to the received_command_queue
 */
 network_command_t* network_check_activity(karte_t *, int timeout)
 {
+#ifdef USE_EPOLL
+	if (epoll_fd != -1) {
+		// only the sockets with incoming data are returned, however many are connected
+		struct epoll_event events[64];
+		const int action = epoll_wait(epoll_fd, events, lengthof(events), timeout);
+		if (action <= 0) {
+			// timeout: return command from the queue
+			return network_get_received_command();
+		}
+
+		// handle the sockets in the order of the socket list, as select() does below
+		static vector_tpl<uint32> ready_ids;
+		ready_ids.clear();
+		for (int i = 0; i < action; i++) {
+			const uint32 id = socket_list_t::get_client_id(events[i].data.fd);
+			if (socket_list_t::is_valid_client_id(id)) {
+				ready_ids.append(id);
+			}
+		}
+		std::sort(ready_ids.begin(), ready_ids.end());
+
+		// accept new connections; the server sockets come first in the list
+		FOR(vector_tpl<uint32>, const id, ready_ids) {
+			if (id < socket_list_t::get_server_sockets()) {
+				network_accept_client(socket_list_t::get_socket(id));
+			}
+		}
+		// receive from clients; a client which is closed meanwhile has no socket any more
+		FOR(vector_tpl<uint32>, const id, ready_ids) {
+			const SOCKET sender = socket_list_t::get_socket(id);
+			if (id >= socket_list_t::get_server_sockets()  &&  sender != INVALID_SOCKET) {
+				network_receive_from_client(sender);
+			}
+		}
+		return network_get_received_command();
+	}
+#endif
+
 	fd_set fds;
 	FD_ZERO(&fds);
 
@@ -516,29 +671,7 @@ network_command_t* network_check_activity(karte_t *, int timeout)
 		SOCKET accept_sock = iter_s.get_current();
 
 		if (accept_sock != INVALID_SOCKET) {
-			struct sockaddr_in client_name;
-			socklen_t size = sizeof(client_name);
-			SOCKET s = accept(accept_sock, (struct sockaddr *)&client_name, &size);
-			if (s != INVALID_SOCKET) {
-#if USE_WINSOCK
-				uint32 ip = ntohl((uint32)client_name.sin_addr.S_un.S_addr);
-#else
-				uint32 ip = ntohl((uint32)client_name.sin_addr.s_addr);
-#endif
-				if (blacklist.contains(net_address_t(ip))) {
-					// refuse connection
-					network_close_socket(s);
-					continue;
-				}
-#ifdef  __BEOS__
-				char name[256];
-				sprintf(name, "%lh", client_name.sin_addr.s_addr);
-#else
-				const char *name = inet_ntoa(client_name.sin_addr);
-#endif
-				dbg->message("check_activity()", "Accepted connection from: %s.", name);
-				socket_list_t::add_client(s, ip);
-			}
+			network_accept_client(accept_sock);
 		}
 	}
 
@@ -547,51 +680,19 @@ network_command_t* network_check_activity(karte_t *, int timeout)
 	while (iter_c.next()) {
 		SOCKET sender = iter_c.get_current();
 
-		if (sender != INVALID_SOCKET  &&  socket_list_t::has_client(sender)) {
-			uint32 client_id = socket_list_t::get_client_id(sender);
-			network_command_t *nwc = socket_list_t::get_client(client_id).receive_nwc();
-			if (nwc) {
-				received_command_queue.append(nwc);
-				dbg->message("network_check_activity()", "received cmd id=%d %s from socket[%d]", nwc->get_id(), nwc->get_name(), sender);
-			}
-			// errors are caught and treated in socket_info_t::receive_nwc
+		if (sender != INVALID_SOCKET) {
+			network_receive_from_client(sender);
 		}
 	}
 	return network_get_received_command();
 }
 
 
-void network_process_send_queues(int timeout)
+void network_process_send_queues()
 {
-	fd_set fds;
-	FD_ZERO(&fds);
-
-	socket_list_t::fill_set(&fds);
-
-	// time out
-	struct timeval tv;
-	tv.tv_sec = timeout / 1000;
-	tv.tv_usec = (timeout % 1000) * 1000ul;
-
-	int action = select(FD_SETSIZE, NULL, &fds, NULL, &tv);
-
-	if (action <= 0) {
-		// timeout: return
-		return;
-	}
-
-	// send to clients
-	socket_list_t::client_socket_iterator_t iter_c(&fds);
-	while (iter_c.next() && action>0) {
-		SOCKET sock = iter_c.get_current();
-
-		if (sock != INVALID_SOCKET  &&  socket_list_t::has_client(sock)) {
-			uint32 client_id = socket_list_t::get_client_id(sock);
-			socket_list_t::get_client(client_id).process_send_queue();
-			// errors are caught and treated in socket_info_t::process_send_queue
-		}
-		action--;
-	}
+	// Sending from the queues never blocks, so there is no need to wait until the sockets
+	// can be written to: what a socket cannot take now is sent by a later call.
+	socket_list_t::process_send_queues();
 }
 
 
@@ -678,8 +779,19 @@ bool network_send_data(SOCKET dest, const char *buf, const uint16 size, uint16 &
 	signal(SIGPIPE, SIG_IGN);
 #endif
 
+#ifdef MSG_DONTWAIT
+	// without time-out, never block: a slow client must not stall the game
+	const int flags = timeout_ms <= 0 ? MSG_DONTWAIT : 0;
+#else
+	const int flags = 0;
+	if (timeout_ms <= 0  &&  !network_wait_socket(dest, true, 0)) {
+		// cannot write now, continue sending later
+		return true;
+	}
+#endif
+
 	while (count < size) {
-		int sent = send(dest, buf + count, size - count, 0);
+		int sent = send(dest, buf + count, size - count, flags);
 		if (sent == -1) {
 			int err = GET_LAST_ERROR();
 			if (err != EWOULDBLOCK) {
@@ -692,14 +804,7 @@ bool network_send_data(SOCKET dest, const char *buf, const uint16 size, uint16 &
 			}
 			else {
 				// try again, test whether sending is possible
-				fd_set fds;
-				FD_ZERO(&fds);
-				FD_SET(dest, &fds);
-				struct timeval tv;
-				tv.tv_sec = timeout_ms / 1000;
-				tv.tv_usec = (timeout_ms % 1000) * 1000ul;
-				// can we write?
-				if (select(FD_SETSIZE, NULL, &fds, NULL, &tv) != 1) {
+				if (!network_wait_socket(dest, true, timeout_ms)) {
 					dbg->warning("network_send_data", "could not write to [%s]", dest);
 					return false;
 				}
@@ -737,14 +842,8 @@ bool network_receive_data(SOCKET sender, void *dest, const uint16 len, uint16 &r
 	char *ptr = (char *)dest;
 
 	do {
-		fd_set fds;
-		FD_ZERO(&fds);
-		FD_SET(sender, &fds);
-		struct timeval tv;
-		tv.tv_sec = timeout_ms / 1000;
-		tv.tv_usec = (timeout_ms % 1000) * 1000ul;
 		// can we read?
-		if (select(FD_SETSIZE, &fds, NULL, NULL, &tv) != 1) {
+		if (!network_wait_socket(sender, false, timeout_ms)) {
 			return true;
 		}
 		// now receive
@@ -773,6 +872,12 @@ bool network_receive_data(SOCKET sender, void *dest, const uint16 len, uint16 &r
 void network_close_socket(SOCKET sock)
 {
 	if (sock != INVALID_SOCKET) {
+#ifdef USE_EPOLL
+		if (epoll_fd != -1) {
+			struct epoll_event ev; // must not be NULL before Linux 2.6.9
+			epoll_ctl(epoll_fd, EPOLL_CTL_DEL, sock, &ev);
+		}
+#endif
 #if USE_WINSOCK || defined __BEOS__
 		closesocket(sock);
 #else
@@ -812,6 +917,14 @@ void network_core_shutdown()
 
 	socket_list_t::reset();
 
+#ifdef USE_EPOLL
+	if (epoll_fd != -1) {
+		close(epoll_fd);
+		epoll_fd = -1;
+	}
+	epoll_failed = false;
+#endif
+
 	if (network_active) {
 #if USE_WINSOCK
 		WSACleanup();
@@ -64,7 +64,7 @@ typedef int SOCKET;
 #include "../simtypes.h"
 #include "../utils/cbuffer_t.h"
 // version of network protocol code
-#define NETWORK_VERSION (1)
+#define NETWORK_VERSION (3)
 
 class network_command_t;
 class gameinfo_t;
@@ -121,7 +121,15 @@ bool network_send_data(SOCKET dest, const char *buf, const uint16 size, uint16 &
 */
 bool network_receive_data(SOCKET sender, void *dest, const uint16 len, uint16 &received, const int timeout_ms);
 
-void network_process_send_queues(int timeout);
+/**
+* send as much of the send queues of all clients as the sockets can take now, without waiting
+*/
+void network_process_send_queues();
+
+/**
+* watch sock for incoming data in network_check_activity(); sockets are added by socket_list_t
+*/
+void network_watch_socket(SOCKET sock);
 
 // true, if I can write on the server connection
 bool network_check_server_connection();
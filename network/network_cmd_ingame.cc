@@ -422,7 +422,29 @@ bool nwc_join_t::execute(karte_t *welt)
 		DBG_MESSAGE( "nwc_join_t::execute", "client_id=%i active=%i pending_join_client=%i active=%d", socket_list_t::get_client_id(packet->get_sender()), socket_list_t::get_client(nwj.client_id).is_active(), pending_join_client, nwj.answer );
 		nwj.rdwr();
 		if(  nwj.send( packet->get_sender() )  ) {
-			if(  nwj.answer==1  ) {
+			if(  nwj.answer==1  &&  env_t::server_streamed_join  ) {
+				// the server takes a snapshot at the next sync step, which is sent to the joining client
+				// until then, the joining client receives no broadcasts, and the map counter is kept
+				nwc_sync_t nw_sync(welt->get_sync_steps() + 1, welt->get_map_counter(), nwj.client_id, welt->get_map_counter());
+				nw_sync.streamed = true;
+				nw_sync.rdwr();
+				if(  nw_sync.send( packet->get_sender() )  ) {
+					socket_list_t::get_client(nwj.client_id).awaiting_snapshot = true;
+					// everybody reloads at the same step like the joining client, but keeps the commands still to come
+					nwc_sync_t *nws = new nwc_sync_t(welt->get_sync_steps() + 1, welt->get_map_counter(), nwj.client_id, welt->get_map_counter());
+					nws->streamed = true;
+					network_send_all(nws, false);
+					pending_join_client = packet->get_sender();
+					DBG_MESSAGE( "nwc_join_t::execute", "pending_join_client now %i (streamed)", pending_join_client);
+					if (welt->is_paused()) {
+						welt->set_pause(false);
+					}
+				}
+				else {
+					dbg->warning("nwc_join_t::execute", "send of NWC_SYNC to the joining client failed");
+				}
+			}
+			else if(  nwj.answer==1  ) {
 				// now send sync command
 				const uint32 new_map_counter = welt->generate_new_map_counter();
 				// since network_send_all() does not include non-playing clients -> send sync command separately to the joining client
@@ -482,9 +504,10 @@ bool nwc_ready_t::execute(karte_t *welt)
 		if(  welt->is_checklist_available(sync_step)  &&  checklist!=welt->get_checklist_at(sync_step)  ) {
 			// client has gone out of sync
 			socket_list_t::remove_client( get_sender() );
-			char buf[2048];
-			const int offset = welt->get_checklist_at(sync_step).print(buf, "server");
-			checklist.print(buf + offset, "client");
+			char buf[4096];
+			int offset = welt->get_checklist_at(sync_step).print(buf, "server");
+			offset += checklist.print(buf + offset, "client");
+			welt->get_checklist_at(sync_step).print_divergence(buf + offset, checklist);
 			dbg->warning("nwc_ready_t::execute", "disconnect client due to checklist mismatch : sync_step=%u %s", sync_step, buf);
 			return true;
 		}
@@ -664,6 +687,7 @@ void nwc_sync_t::rdwr()
 	network_world_command_t::rdwr();
 	packet->rdwr_long(client_id);
 	packet->rdwr_long(new_map_counter);
+	packet->rdwr_bool(streamed);
 }
 
 
@@ -686,6 +710,8 @@ void nwc_sync_t::do_command(karte_t *welt)
 			}
 		}
 	}
+	// loading clears the commands, but with a streamed join they are still to be executed
+	slist_tpl<network_world_command_t*> pending_commands;
 	// transfer game, all clients need to sync (save, reload, and pause)
 	// now save and send
 	dr_chdir( env_t::user_dir );
@@ -698,18 +724,30 @@ void nwc_sync_t::do_command(karte_t *welt)
 
 		welt->save( fn, true, SERVER_SAVEGAME_VER_NR, EXTENDED_VER_NR, EXTENDED_REVISION_NR, false );
 		uint32 old_sync_steps = welt->get_sync_steps();
+		if(  streamed  ) {
+			welt->command_queue_detach(pending_commands);
+		}
 		welt->load( fn );
 		env_t::restore_UI = old_restore_UI;
 
-		// pause clients, restore steps
-		welt->network_game_set_pause( true, old_sync_steps);
+		if(  streamed  ) {
+			// the map counter is kept, and the joining client is not waited for
+			FOR(slist_tpl<network_world_command_t*>, const nwc, pending_commands) {
+				welt->command_queue_append(nwc);
+			}
+			welt->network_game_set_pause( false, old_sync_steps);
+		}
+		else {
+			// pause clients, restore steps
+			welt->network_game_set_pause( true, old_sync_steps);
 
-		// apply new map counter
-		welt->set_map_counter(new_map_counter);
+			// apply new map counter
+			welt->set_map_counter(new_map_counter);
 
-		// tell server we are ready
-		network_command_t *nwc = new nwc_ready_t( old_sync_steps, welt->get_map_counter(), welt->get_checklist_at(old_sync_steps) );
-		network_send_server(nwc);
+			// tell server we are ready
+			network_command_t *nwc = new nwc_ready_t( old_sync_steps, welt->get_map_counter(), welt->get_checklist_at(old_sync_steps) );
+			network_send_server(nwc);
+		}
 	}
 	else {
 		char fn[256];
@@ -744,18 +782,25 @@ void nwc_sync_t::do_command(karte_t *welt)
 		env_t::restore_UI = true;
 		welt->save( fn, false, SERVER_SAVEGAME_VER_NR, EXTENDED_VER_NR, EXTENDED_REVISION_NR, false );
 
-		// ok, now sending game
-		// this sends nwc_game_t
-		const char *err = network_send_file( client_id, fn );
-		if (err) {
-			dbg->warning("nwc_sync_t::do_command","send game failed with: %s", err);
+		if(  streamed  ) {
+			// queued with the commands still to be executed, and sent while the game goes on
+			send_snapshot(welt, fn, unlocked_players);
+			welt->command_queue_detach(pending_commands);
 		}
-
 		else {
-			// Knightly : synchronise the iteration limits
-			SOCKET sock = socket_list_t::get_socket(client_id);
-			if(  sock==INVALID_SOCKET  ||  !nwc_routesearch_t::transmit_active_limit_set(sock, welt->get_sync_steps(), new_map_counter)  ) {
-				dbg->warning("nwc_sync_t::do_command", "send of NWC_ROUTESEARCH failed");
+			// ok, now sending game
+			// this sends nwc_game_t
+			const char *err = network_send_file( client_id, fn );
+			if (err) {
+				dbg->warning("nwc_sync_t::do_command","send game failed with: %s", err);
+			}
+
+			else {
+				// Knightly : synchronise the iteration limits
+				SOCKET sock = socket_list_t::get_socket(client_id);
+				if(  sock==INVALID_SOCKET  ||  !nwc_routesearch_t::transmit_active_limit_set(sock, welt->get_sync_steps(), new_map_counter)  ) {
+					dbg->warning("nwc_sync_t::do_command", "send of NWC_ROUTESEARCH failed");
+				}
 			}
 		}
 
@@ -766,29 +811,40 @@ void nwc_sync_t::do_command(karte_t *welt)
 		// restore steps
 		welt->network_game_set_pause( false, old_sync_steps);
 
-		// apply new map counter
-		welt->set_map_counter(new_map_counter);
-
-		// unpause the client that received the game
-		// we do not want to wait for him (maybe loading failed due to pakset-errors)
-		SOCKET sock = socket_list_t::get_socket(client_id);
-		if(  sock != INVALID_SOCKET  ) {
-			nwc_ready_t nwc( old_sync_steps, welt->get_map_counter(), welt->get_checklist_at(old_sync_steps) );
-			if (nwc.send(sock)) {
-				socket_list_t::change_state( client_id, socket_info_t::playing);
-				if (socket_list_t::is_valid_client_id(client_id)) {
-					socket_list_t::get_client(client_id).player_unlocked = unlocked_players;
-					// send information about locked state
-					nwc_auth_player_t nwc;
-					nwc.player_unlocked = unlocked_players;
-					nwc.send(sock);
-
-					// welcome message
-					nwc_nick_t::server_tools(welt, client_id, nwc_nick_t::WELCOME, NULL);
-				}
+		if(  streamed  ) {
+			FOR(slist_tpl<network_world_command_t*>, const nwc, pending_commands) {
+				welt->command_queue_append(nwc);
 			}
-			else {
-				dbg->warning( "nwc_sync_t::do_command", "send of NWC_READY failed" );
+			if(  socket_list_t::get_socket(client_id) != INVALID_SOCKET  ) {
+				// welcome message, which is broadcast and thus follows the snapshot
+				nwc_nick_t::server_tools(welt, client_id, nwc_nick_t::WELCOME, NULL);
+			}
+		}
+		else {
+			// apply new map counter
+			welt->set_map_counter(new_map_counter);
+
+			// unpause the client that received the game
+			// we do not want to wait for him (maybe loading failed due to pakset-errors)
+			SOCKET sock = socket_list_t::get_socket(client_id);
+			if(  sock != INVALID_SOCKET  ) {
+				nwc_ready_t nwc( old_sync_steps, welt->get_map_counter(), welt->get_checklist_at(old_sync_steps) );
+				if (nwc.send(sock)) {
+					socket_list_t::change_state( client_id, socket_info_t::playing);
+					if (socket_list_t::is_valid_client_id(client_id)) {
+						socket_list_t::get_client(client_id).player_unlocked = unlocked_players;
+						// send information about locked state
+						nwc_auth_player_t nwc;
+						nwc.player_unlocked = unlocked_players;
+						nwc.send(sock);
+
+						// welcome message
+						nwc_nick_t::server_tools(welt, client_id, nwc_nick_t::WELCOME, NULL);
+					}
+				}
+				else {
+					dbg->warning( "nwc_sync_t::do_command", "send of NWC_READY failed" );
+				}
 			}
 		}
 		nwc_join_t::pending_join_client = INVALID_SOCKET;
@@ -804,6 +860,77 @@ void nwc_sync_t::do_command(karte_t *welt)
 	}
 }
 
+
+// server: queue the saved game @p fn for the joining client, which cannot be sent from there,
+// as the next join overwrites it
+void nwc_sync_t::send_snapshot(karte_t *welt, const char *fn, uint16 unlocked_players)
+{
+	SOCKET sock = socket_list_t::get_socket(client_id);
+	if(  sock == INVALID_SOCKET  ||  !socket_list_t::get_client(client_id).awaiting_snapshot  ) {
+		dbg->warning("nwc_sync_t::send_snapshot", "client %u left before the game was sent", client_id);
+		return;
+	}
+	socket_info_t &info = socket_list_t::get_client(client_id);
+
+	// a file for each client, as the previous snapshot may still be sent to another one
+	char join_fn[256];
+	sprintf( join_fn, "server%d-join%u.sve", env_t::server, client_id );
+	FILE *in = dr_fopen(fn, "rb");
+	FILE *out = in ? dr_fopen(join_fn, "wb") : NULL;
+	bool copied = out != NULL;
+	if(  copied  ) {
+		char buf[65536];
+		size_t n;
+		while(  copied  &&  (n = fread(buf, 1, sizeof(buf), in)) > 0  ) {
+			copied = fwrite(buf, 1, n, out) == n;
+		}
+		copied = copied  &&  !ferror(in);
+		copied = fclose(out) == 0  &&  copied;
+	}
+	if(  in  ) {
+		fclose(in);
+	}
+	FILE *fp = copied ? dr_fopen(join_fn, "rb") : NULL;
+	if(  fp == NULL  ) {
+		dbg->warning("nwc_sync_t::send_snapshot", "could not copy the game to %s", join_fn);
+		dr_remove(join_fn);
+		socket_list_t::remove_client(sock);
+		return;
+	}
+	fseek(fp, 0, SEEK_END);
+	const uint32 length = (uint32)ftell(fp);
+	rewind(fp);
+
+	// the client expects the same sequence as in a reloaded game, but all of it is queued:
+	// game, routesearch limits, ready
+	nwc_game_t nwg(length);
+	nwg.prepare_to_send();
+	info.send_queue_append(nwg.copy_packet());
+	// removed once sent, by then the working directory may have changed
+	cbuffer_t path;
+	path.printf("%s%s", env_t::user_dir, join_fn);
+	info.send_queue_append_file(fp, path);
+
+	nwc_routesearch_t::transmit_active_limit_set(sock, get_sync_step(), new_map_counter, true);
+
+	nwc_ready_t nwr(get_sync_step(), welt->get_map_counter(), welt->get_checklist_at(get_sync_step()));
+	nwr.prepare_to_send();
+	info.send_queue_append(nwr.copy_packet());
+
+	socket_list_t::change_state(client_id, socket_info_t::playing);
+	info.player_unlocked = unlocked_players;
+	nwc_auth_player_t nwa;
+	nwa.player_unlocked = unlocked_players;
+	nwa.prepare_to_send();
+	info.send_queue_append(nwa.copy_packet());
+
+	// then the commands which the others still execute after this sync step
+	welt->command_queue_send_to(info);
+	info.awaiting_snapshot = false;
+
+	dbg->message("nwc_sync_t::send_snapshot", "queued %u bytes for client %u", length, client_id);
+}
+
 slist_tpl<nwc_routesearch_t::client_entry_t> nwc_routesearch_t::client_entries;
 path_explorer_t::limit_set_t nwc_routesearch_t::active_limit_set;
 path_explorer_t::limit_set_t nwc_routesearch_t::min_limit_set;
@@ -896,7 +1023,7 @@ void nwc_routesearch_t::check_for_transmission(karte_t *world)
 }
 
 
-bool nwc_routesearch_t::transmit_active_limit_set(SOCKET client_socket, uint32 sync_step, uint32 map_counter)
+bool nwc_routesearch_t::transmit_active_limit_set(SOCKET client_socket, uint32 sync_step, uint32 map_counter, bool queued)
 {
 	// check if the active limit set is valid -> if not, initialise the active limit set
 	if(  active_limit_set==path_explorer_t::limit_set_t()  ) {
@@ -904,7 +1031,15 @@ bool nwc_routesearch_t::transmit_active_limit_set(SOCKET client_socket, uint32 s
 	}
 	// now send out the active limit set
 	nwc_routesearch_t nwrs(sync_step, map_counter, active_limit_set, true);
-	const bool success = nwrs.send(client_socket);
+	bool success = true;
+	if(  queued  ) {
+		// behind the packets already queued for this client
+		nwrs.prepare_to_send();
+		socket_list_t::get_client( socket_list_t::get_client_id(client_socket) ).send_queue_append( nwrs.copy_packet() );
+	}
+	else {
+		success = nwrs.send(client_socket);
+	}
 	dbg->warning("nwc_routesearch_t::transmit_active_limit_set", "transmit %s sync_step=%u map_counter=%u limits=(%u, %u, %u, %llu, %u)",
 		success ? "succeeded" : "failed", sync_step, map_counter, active_limit_set.rebuild_connexions, active_limit_set.filter_eligible,
 		active_limit_set.fill_matrix, active_limit_set.explore_paths, active_limit_set.reroute_goods);
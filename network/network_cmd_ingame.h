@@ -208,21 +208,31 @@ protected:
  * @from-server:
  *      @data client_id this client wants to receive the game
  *      @data new_map_counter new map counter for the new world after game reloading
+ *      @data streamed the game is streamed to the joining client instead
  *      clients: pause game, save, load, wait for nwc_ready_t command to unpause
  *      server: pause game, save, load, send game to client, send nwc_ready_t command to client
  */
 class nwc_sync_t : public network_world_command_t {
 public:
-	nwc_sync_t() : network_world_command_t(NWC_SYNC, 0, 0), client_id(0), new_map_counter(0) {};
-	nwc_sync_t(uint32 sync_steps, uint32 map_counter, uint32 send_to_client, uint32 _new_map_counter) : network_world_command_t(NWC_SYNC, sync_steps, map_counter), client_id(send_to_client), new_map_counter(_new_map_counter) { }
+	nwc_sync_t() : network_world_command_t(NWC_SYNC, 0, 0), streamed(false), client_id(0), new_map_counter(0) {};
+	nwc_sync_t(uint32 sync_steps, uint32 map_counter, uint32 send_to_client, uint32 _new_map_counter) : network_world_command_t(NWC_SYNC, sync_steps, map_counter), streamed(false), client_id(send_to_client), new_map_counter(_new_map_counter) { }
 
 	void rdwr() OVERRIDE;
 	void do_command(karte_t*) OVERRIDE;
 	const char* get_name() OVERRIDE { return "nwc_sync_t"; }
 	uint32 get_new_map_counter() const { return new_map_counter; }
+
+	/**
+	 * the game is reloaded, but nobody waits for the joining client: the server queues its
+	 * save for it, followed by the commands still to be executed, which everybody keeps
+	 * @see env_t::server_streamed_join
+	 */
+	bool streamed;
 private:
 	uint32 client_id; // this client shall receive the game
 	uint32 new_map_counter; // map counter to be applied to the new world after game reloading
+
+	void send_snapshot(karte_t *welt, const char *fn, uint16 unlocked_players);
 };
 
 /**
@@ -244,7 +254,7 @@ public:
 	virtual void do_command(karte_t *world);
 
 	static void check_for_transmission(karte_t *world);
-	static bool transmit_active_limit_set(SOCKET client_socket, uint32 sync_step, uint32 map_counter);
+	static bool transmit_active_limit_set(SOCKET client_socket, uint32 sync_step, uint32 map_counter, bool queued = false);
 	static void remove_client_entry(uint32 client_id);
 	static void reset();
 private:
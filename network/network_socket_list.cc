@@ -10,6 +10,9 @@
 
 #ifndef NETTOOL
 #include "../dataobj/environment.h"
+#include "../sys/simsys.h"
+#else
+#define dr_remove remove
 #endif
 
 
@@ -27,6 +30,10 @@ void socket_info_t::reset()
 		packet_t *p = send_queue.remove_first();
 		delete p;
 	}
+	if (send_file) {
+		close_send_file();
+	}
+	awaiting_snapshot = false;
 	if (socket != INVALID_SOCKET) {
 		network_close_socket(socket);
 	}
@@ -66,7 +73,21 @@ network_command_t* socket_info_t::receive_nwc()
 
 void socket_info_t::process_send_queue()
 {
-	while(!send_queue.empty()) {
+	while(!send_queue.empty()  ||  send_file) {
+		if (send_file  &&  send_file->packets_before == 0) {
+			if (!send_file_data()) {
+				// close this client, clear the send_queue
+				socket_list_t::remove_client(socket);
+				break;
+			}
+			if (send_file->len > 0) {
+				// could not send more without blocking
+				break;
+			}
+			// file completely sent, proceed with the packets behind it
+			close_send_file();
+			continue;
+		}
 		packet_t *p = send_queue.front();
 		p->send(socket, false);
 		if (p->has_failed()) {
@@ -78,6 +99,9 @@ void socket_info_t::process_send_queue()
 			// packet complete sent, remove from queue
 			send_queue.remove_first();
 			delete p;
+			if (send_file) {
+				send_file->packets_before--;
+			}
 			// proceed with next packet
 		}
 		else {
@@ -87,6 +111,31 @@ void socket_info_t::process_send_queue()
 }
 
 
+bool socket_info_t::send_file_data()
+{
+	for(;;) {
+		if (send_file->sent == send_file->len) {
+			// buffer sent, read the next part
+			send_file->len = (uint16)fread(send_file->buf, 1, sizeof(send_file->buf), send_file->file);
+			send_file->sent = 0;
+			if (send_file->len == 0) {
+				// end of file
+				return !ferror(send_file->file);
+			}
+		}
+		uint16 count;
+		if (!network_send_data(socket, send_file->buf + send_file->sent, send_file->len - send_file->sent, count, 0)) {
+			return false;
+		}
+		send_file->sent += count;
+		if (send_file->sent < send_file->len) {
+			// socket is full
+			return true;
+		}
+	}
+}
+
+
 void socket_info_t::send_queue_append(packet_t *p)
 {
 	if (p) {
@@ -99,6 +148,27 @@ void socket_info_t::send_queue_append(packet_t *p)
 	}
 }
 
+void socket_info_t::close_send_file()
+{
+	fclose(send_file->file);
+	dr_remove(send_file->filename);
+	delete send_file;
+	send_file = NULL;
+}
+
+
+void socket_info_t::send_queue_append_file(FILE *f, const char *filename)
+{
+	assert(send_file == NULL);
+	send_file = new file_transfer_t;
+	send_file->file = f;
+	send_file->filename = filename;
+	send_file->packets_before = send_queue.get_count();
+	send_file->len = 0;
+	send_file->sent = 0;
+}
+
+
 void socket_info_t::rdwr(packet_t *p)
 {
 	address.rdwr(p);
@@ -200,6 +270,7 @@ void socket_list_t::add_client( SOCKET sock, uint32 ip )
 	change_state( i, socket_info_t::connected );
 
 	network_set_socket_nodelay( sock );
+	network_watch_socket( sock );
 }
 
 
@@ -237,6 +308,7 @@ void socket_list_t::add_server( SOCKET sock )
 	}
 
 	network_set_socket_nodelay( sock );
+	network_watch_socket( sock );
 }
 
 
@@ -327,7 +399,7 @@ void socket_list_t::send_all(network_command_t* nwc, bool only_playing_clients)
 		return;
 	}
 	for(uint32 i=server_sockets; i<list.get_count(); i++) {
-		if (list[i]->is_active()  &&  list[i]->socket!=INVALID_SOCKET
+		if (list[i]->is_active()  &&  list[i]->socket!=INVALID_SOCKET  &&  !list[i]->awaiting_snapshot
 			&& (!only_playing_clients || list[i]->state == socket_info_t::playing || list[i]->state == socket_info_t::connected)) {
 			packet_t *p = nwc->copy_packet();
 			list[i]->send_queue_append(p);
@@ -336,6 +408,17 @@ void socket_list_t::send_all(network_command_t* nwc, bool only_playing_clients)
 }
 
 
+void socket_list_t::process_send_queues()
+{
+	for(uint32 i=server_sockets; i<list.get_count(); i++) {
+		if (list[i]->is_active()  &&  list[i]->socket!=INVALID_SOCKET) {
+			list[i]->process_send_queue();
+			// errors are caught and treated in socket_info_t::process_send_queue
+		}
+	}
+}
+
+
 SOCKET socket_list_t::fill_set(fd_set *fds)
 {
 	SOCKET s_max = 0;
@@ -14,6 +14,8 @@
 #include "../utils/plainstring.h"
 #include "../simconst.h"
 
+#include <stdio.h>
+
 class network_command_t;
 class packet_t;
 
@@ -50,6 +52,24 @@ private:
 	packet_t *packet;
 	slist_tpl<packet_t *> send_queue;
 
+	/// a file sent as raw data once the packets queued before it are sent
+	struct file_transfer_t {
+		FILE *file;
+		plainstring filename; ///< removed once sent
+		uint32 packets_before;
+		uint16 len, sent;
+		char buf[4096];
+	};
+	file_transfer_t *send_file;
+
+	/**
+	 * sends as much of send_file as possible without blocking
+	 * @return false if an error occurred
+	 */
+	bool send_file_data();
+
+	/// closes and removes send_file
+	void close_send_file();
 
 public:
 	enum {
@@ -64,7 +84,13 @@ public:
 
 	SOCKET socket;
 
-	socket_info_t() : connection_info_t(), packet(0), send_queue(), state(inactive), socket(INVALID_SOCKET), player_unlocked(0) {}
+	/**
+	 * client joins by a streamed snapshot of the game, which is not yet taken:
+	 * no commands are broadcast to it until then, see nwc_sync_t
+	 */
+	bool awaiting_snapshot;
+
+	socket_info_t() : connection_info_t(), packet(0), send_queue(), send_file(NULL), state(inactive), socket(INVALID_SOCKET), awaiting_snapshot(false), player_unlocked(0) {}
 
 	~socket_info_t();
 
@@ -90,6 +116,12 @@ public:
 
 	void send_queue_append(packet_t *p);
 
+	/**
+	 * appends the contents of file @p f to the send queue, they are sent without blocking
+	 * takes ownership of @p f, which is closed and removed as @p filename when done
+	 */
+	void send_queue_append_file(FILE *f, const char *filename);
+
 	/**
 	 * rdwr client information to packet
 	 */
@@ -189,6 +221,11 @@ public:
 
 	static void send_all(network_command_t* nwc, bool only_playing_clients);
 
+	/**
+	 * sends as much of the send queues of all clients as possible without blocking
+	 */
+	static void process_send_queues();
+
 	static void change_state(uint32 id, uint8 new_state);
 
 	/**
@@ -35,6 +35,8 @@ signal_t::signal_t( loadsave_t *file) :
 	roadsign_t(file)
 #endif
 {
+	time_interval_check_due = -1;
+	time_interval_timers = 0;
 	rdwr_signal(file);
 	if(desc==NULL) {
 		desc = roadsign_t::default_signal;
@@ -59,6 +61,8 @@ signal_t::signal_t(player_t *player, koord3d pos, ribi_t::ribi dir,const roadsig
 
 	train_last_passed = 0;
 	no_junctions_to_next_signal = false;
+	time_interval_check_due = -1;
+	time_interval_timers = 0;
 
 	if(desc->get_signal_group())
 	{
@@ -110,6 +114,22 @@ signal_t::~signal_t()
 	}
 }
 
+void signal_t::set_no_junctions_to_next_signal(bool value)
+{
+	no_junctions_to_next_signal = value;
+	if(  value  ) {
+		welt->recheck_time_interval_signal(this);
+	}
+}
+
+void signal_t::set_state(signal_aspects s)
+{
+	roadsign_t::set_state(s);
+	if(  s == danger  ) {
+		welt->recheck_time_interval_signal(this);
+	}
+}
+
 void signal_t::show_info()
 {
 	create_win(new signal_info_t(this), w_info, (ptrdiff_t)this);
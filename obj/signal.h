@@ -27,6 +27,15 @@ private:
 	// Used for time interval signalling
 	sint64 train_last_passed;
 
+	// The tick at which karte_t next checks whether this time interval signal
+	// should change its aspect, or -1 if it is not to be checked.
+	sint64 time_interval_check_due;
+
+	// The number of timers for this signal in karte_t's heap, including outdated ones
+	uint16 time_interval_timers;
+
+	friend class karte_t;
+
 protected:
 	mutable uint8 textlines_in_signal_window;
 
@@ -59,10 +68,13 @@ public:
 	koord3d get_signalbox() const { return signalbox; }
 
 	bool get_no_junctions_to_next_signal() const { return no_junctions_to_next_signal; }
-	void set_no_junctions_to_next_signal(bool value) { no_junctions_to_next_signal = value; }
+	void set_no_junctions_to_next_signal(bool value);
 
 	bool is_bidirectional() const { return ((dir & ribi_t::east) && (dir & ribi_t::west)) || ((dir & ribi_t::south) && (dir & ribi_t::north)) || ((dir & ribi_t::northeast) && (dir & ribi_t::southwest)) || ((dir & ribi_t::northwest) && (dir & ribi_t::southeast)); }
 
+	/// A time interval signal which is set to danger is checked again at the next karte_t::step_time_interval_signals()
+	void set_state(signal_aspects s) OVERRIDE;
+
 	void set_train_last_passed(sint64 value) { train_last_passed = value; }
 	sint64 get_train_last_passed() const { return train_last_passed; }
 
@@ -3,6 +3,9 @@
  * (see LICENSE.txt)
  */
 
+#include <string.h>
+#include <algorithm>
+
 #include "path_explorer.h"
 
 #include "tpl/slist_tpl.h"
@@ -42,6 +45,15 @@ bool path_explorer_t::must_refresh_on_loading;
 
 #ifdef MULTI_THREAD
 bool thread_local path_explorer_t::allow_path_explorer_on_this_thread = false;
+
+vector_tpl<pthread_t> path_explorer_t::compartment_t::explore_paths_threads;
+simthread_barrier_t path_explorer_t::compartment_t::explore_paths_barrier;
+bool path_explorer_t::compartment_t::terminating_explore_paths_threads = false;
+path_explorer_t::compartment_t *path_explorer_t::compartment_t::explore_paths_compartment = NULL;
+uint16 path_explorer_t::compartment_t::explore_paths_via = 0;
+uint32 path_explorer_t::compartment_t::explore_paths_begin = 0;
+uint32 path_explorer_t::compartment_t::explore_paths_end = 0;
+bool path_explorer_t::compartment_t::explore_paths_dense = false;
 #endif
 
 void path_explorer_t::initialise(karte_t *welt)
@@ -99,6 +111,13 @@ void path_explorer_t::finalise()
 
 void path_explorer_t::rdwr(loadsave_t* file)
 {
+	if (file->is_loading() && file->is_version_ex_less(14, 45) && world->get_settings().get_path_explorer_backend() == settings_t::PATH_EXPLORER_HUB_LABELS)
+	{
+		// Hub labels were not saved, so the paths must be explored afresh.
+		// The rest of the data must still be read to move the file onto the correct place.
+		set_must_refresh_on_loading();
+	}
+
 	if (file->get_extended_version() < 14 || (file->get_extended_version() == 14 && file->get_extended_revision() < 10))
 	{
 		// Iterate through the compartments and load/save these
@@ -385,6 +404,34 @@ void path_explorer_t::full_instant_refresh()
 }
 
 
+size_t path_explorer_t::get_finished_matrix_memory()
+{
+	size_t memory = 0;
+	for (uint8 ca = 0; goods_compartment && ca < max_categories; ++ca)
+	{
+		for (uint8 cl = 0; cl < max_classes; ++cl)
+		{
+			memory += goods_compartment[ca][cl].get_finished_matrix_memory();
+		}
+	}
+	return memory;
+}
+
+
+size_t path_explorer_t::get_finished_matrix_memory_saved()
+{
+	size_t memory = 0;
+	for (uint8 ca = 0; goods_compartment && ca < max_categories; ++ca)
+	{
+		for (uint8 cl = 0; cl < max_classes; ++cl)
+		{
+			memory += goods_compartment[ca][cl].get_finished_matrix_memory_saved();
+		}
+	}
+	return memory;
+}
+
+
 void path_explorer_t::refresh_all_categories(const bool reset_working_set)
 {
 	if (reset_working_set)
@@ -472,17 +519,45 @@ path_explorer_t::compartment_t::compartment_t()
 {
 	refresh_start_time = 0;
 
-	finished_matrix = NULL;
+	finished_times = NULL;
+	finished_times_high = NULL;
+	finished_next_transfer = NULL;
+	finished_matrix_memory = 0;
+	finished_matrix_memory_saved = 0;
 	finished_halt_index_map = NULL;
 	finished_halt_count = 0;
 
-	working_matrix = NULL;
+	working_times = NULL;
+	working_next_transfer = NULL;
+	working_first_transport = NULL;
+	working_last_transport = NULL;
 	transport_index_map = NULL;
-	transport_matrix = NULL;
 	working_halt_index_map = NULL;
 	working_halt_list = NULL;
 	working_halt_count = 0;
 
+	finished_connexions = NULL;
+	working_connexions = NULL;
+
+	finished_labels_out = NULL;
+	finished_labels_in = NULL;
+	finished_label_offsets_out = NULL;
+	finished_label_offsets_in = NULL;
+
+	working_hub_labels = false;
+	working_labels_out = NULL;
+	working_labels_in = NULL;
+	hub_order = NULL;
+	hub_forward_offsets = NULL;
+	hub_reverse_offsets = NULL;
+	hub_reverse_connexions = NULL;
+	hub_search_times = NULL;
+	hub_search_first_hop = NULL;
+	hub_search_edge_transport = NULL;
+	hub_search_hub_transport = NULL;
+	hub_pruning_times = NULL;
+	hub_pruning_transports = NULL;
+
 	all_halts_list = NULL;
 	all_halts_count = 0;
 
@@ -508,12 +583,10 @@ path_explorer_t::compartment_t::compartment_t()
 	total_iterations = 0;
 
 	via_index = 0;
-	origin_cluster_index = 0;
-	target_cluster_index = 0;
 	origin_member_index = 0;
 
-	inbound_connections = NULL;
-	outbound_connections = NULL;
+	via_connected_halts = NULL;
+	via_connected_count = 0;
 	process_next_transfer = true;
 
 	statistic_duration = 0;
@@ -523,40 +596,18 @@ path_explorer_t::compartment_t::compartment_t()
 
 path_explorer_t::compartment_t::~compartment_t()
 {
-	if (finished_matrix)
-	{
-		for (uint16 i = 0; i < finished_halt_count; ++i)
-		{
-			delete[] finished_matrix[i];
-		}
-		delete[] finished_matrix;
-	}
+	free_finished_matrix();
 	if (finished_halt_index_map)
 	{
 		delete[] finished_halt_index_map;
 	}
 
 
-	if (working_matrix)
-	{
-		for (uint16 i = 0; i < working_halt_count; ++i)
-		{
-			delete[] working_matrix[i];
-		}
-		delete[] working_matrix;
-	}
+	free_working_matrix();
 	if (transport_index_map)
 	{
 		delete[] transport_index_map;
 	}
-	if (transport_matrix)
-	{
-		for (uint16 i = 0; i < working_halt_count; ++i)
-		{
-			delete[] transport_matrix[i];
-		}
-		delete[] transport_matrix;
-	}
 	if (working_halt_index_map)
 	{
 		delete[] working_halt_index_map;
@@ -566,6 +617,12 @@ path_explorer_t::compartment_t::~compartment_t()
 		delete[] working_halt_list;
 	}
 
+	delete finished_connexions;
+	delete working_connexions;
+
+	free_finished_labels();
+	free_hub_label_search();
+
 
 	if (all_halts_list)
 	{
@@ -582,14 +639,9 @@ path_explorer_t::compartment_t::~compartment_t()
 		delete[] transfer_list;
 	}
 
-	if (inbound_connections)
+	if (via_connected_halts)
 	{
-		delete inbound_connections;
-	}
-
-	if (outbound_connections)
-	{
-		delete outbound_connections;
+		delete[] via_connected_halts;
 	}
 
 	if (class_name)
@@ -605,47 +657,25 @@ void path_explorer_t::compartment_t::reset(const bool reset_finished_set)
 
 	if (reset_finished_set)
 	{
-		if (finished_matrix)
-		{
-			for (uint16 i = 0; i < finished_halt_count; ++i)
-			{
-				delete[] finished_matrix[i];
-			}
-			delete[] finished_matrix;
-			finished_matrix = NULL;
-		}
+		free_finished_matrix();
 		if (finished_halt_index_map)
 		{
 			delete[] finished_halt_index_map;
 			finished_halt_index_map = NULL;
 		}
+		free_finished_labels();
 		finished_halt_count = 0;
+		delete finished_connexions;
+		finished_connexions = NULL;
 	}
 
 
-	if (working_matrix)
-	{
-		for (uint16 i = 0; i < working_halt_count; ++i)
-		{
-			delete[] working_matrix[i];
-		}
-		delete[] working_matrix;
-		working_matrix = NULL;
-	}
+	free_working_matrix();
 	if (transport_index_map)
 	{
 		delete[] transport_index_map;
 		transport_index_map = NULL;
 	}
-	if (transport_matrix)
-	{
-		for (uint16 i = 0; i < working_halt_count; ++i)
-		{
-			delete[] transport_matrix[i];
-		}
-		delete[] transport_matrix;
-		transport_matrix = NULL;
-	}
 	if (working_halt_index_map)
 	{
 		delete[] working_halt_index_map;
@@ -656,7 +686,11 @@ void path_explorer_t::compartment_t::reset(const bool reset_finished_set)
 		delete[] working_halt_list;
 		working_halt_list = NULL;
 	}
+	free_hub_label_search();
+	working_hub_labels = false;
 	working_halt_count = 0;
+	delete working_connexions;
+	working_connexions = NULL;
 
 
 	if (all_halts_list)
@@ -681,16 +715,12 @@ void path_explorer_t::compartment_t::reset(const bool reset_finished_set)
 	}
 	transfer_count = 0;
 
-	if (inbound_connections)
-	{
-		delete inbound_connections;
-		inbound_connections = NULL;
-	}
-	if (outbound_connections)
+	if (via_connected_halts)
 	{
-		delete outbound_connections;
-		outbound_connections = NULL;
+		delete[] via_connected_halts;
+		via_connected_halts = NULL;
 	}
+	via_connected_count = 0;
 	process_next_transfer = true;
 
 #ifdef DEBUG_COMPARTMENT_STEP
@@ -711,8 +741,6 @@ void path_explorer_t::compartment_t::reset(const bool reset_finished_set)
 	total_iterations = 0;
 
 	via_index = 0;
-	origin_cluster_index = 0;
-	target_cluster_index = 0;
 	origin_member_index = 0;
 
 	statistic_duration = 0;
@@ -723,14 +751,697 @@ void path_explorer_t::compartment_t::reset(const bool reset_finished_set)
 void path_explorer_t::compartment_t::initialise()
 {
 	initialise_connexion_list();
+#ifdef MULTI_THREAD
+	init_explore_paths_threads();
+#endif
 }
 
 
 void path_explorer_t::compartment_t::finalise()
 {
 	finalise_connexion_list();
+#ifdef MULTI_THREAD
+	destroy_explore_paths_threads();
+#endif
 }
 
+
+#ifdef MULTI_THREAD
+void *explore_paths_threaded(void *args)
+{
+	const uint32 *thread_number_ptr = (const uint32 *)args;
+	const uint32 thread_number = *thread_number_ptr;
+	delete thread_number_ptr;
+
+	while (true)
+	{
+		simthread_barrier_wait(&path_explorer_t::compartment_t::explore_paths_barrier);
+		if (path_explorer_t::compartment_t::terminating_explore_paths_threads)
+		{
+			break;
+		}
+		path_explorer_t::compartment_t::relax_explore_paths_slice(thread_number);
+		simthread_barrier_wait(&path_explorer_t::compartment_t::explore_paths_barrier);
+	}
+
+	return NULL;
+}
+
+
+void path_explorer_t::compartment_t::init_explore_paths_threads()
+{
+	if (!explore_paths_threads.empty() || env_t::num_threads <= 1)
+	{
+		// already running (the world may be initialised more than once) or single threaded
+		return;
+	}
+
+	const uint32 worker_count = env_t::num_threads - 1;
+	terminating_explore_paths_threads = false;
+	simthread_barrier_init(&explore_paths_barrier, NULL, worker_count + 1);
+
+	pthread_attr_t attributes;
+	pthread_attr_init(&attributes);
+	pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_JOINABLE);
+	for (uint32 i = 0; i < worker_count; i++)
+	{
+		pthread_t thread;
+		uint32 *thread_number = new uint32;
+		*thread_number = i + 1; // +1 because thread number 0 is the path explorer's own thread
+		const int rc = pthread_create(&thread, &attributes, &explore_paths_threaded, (void *)thread_number);
+		if (rc)
+		{
+			dbg->fatal("path_explorer_t::compartment_t::init_explore_paths_threads()", "Failed to create path explorer worker thread, error %d", rc);
+		}
+		explore_paths_threads.append(thread);
+	}
+	pthread_attr_destroy(&attributes);
+}
+
+
+void path_explorer_t::compartment_t::destroy_explore_paths_threads()
+{
+	if (explore_paths_threads.empty())
+	{
+		return;
+	}
+
+	terminating_explore_paths_threads = true;
+	simthread_barrier_wait(&explore_paths_barrier);
+	FOR(vector_tpl<pthread_t>, thread, explore_paths_threads)
+	{
+		pthread_join(thread, NULL);
+	}
+	explore_paths_threads.clear();
+	simthread_barrier_destroy(&explore_paths_barrier);
+	terminating_explore_paths_threads = false;
+}
+
+
+void path_explorer_t::compartment_t::relax_explore_paths_slice(const uint32 thread_number)
+{
+	const uint32 thread_count = explore_paths_threads.get_count() + 1;
+	const uint32 rows = explore_paths_end - explore_paths_begin;
+	const uint32 slice_begin = explore_paths_begin + (uint32)((uint64)rows * thread_number / thread_count);
+	const uint32 slice_end = explore_paths_begin + (uint32)((uint64)rows * (thread_number + 1) / thread_count);
+	for (uint32 i = slice_begin; i < slice_end; ++i)
+	{
+		explore_paths_compartment->relax_paths_via(explore_paths_via, explore_paths_compartment->via_connected_halts[i], explore_paths_dense);
+	}
+}
+#endif
+
+
+void path_explorer_t::compartment_t::relax_connected_halts(const uint16 via, const uint32 begin, const uint32 end, const bool dense)
+{
+#ifdef MULTI_THREAD
+	const uint64 elements = (uint64)(end - begin) * (dense ? working_halt_count : via_connected_count);
+	if (!explore_paths_threads.empty() && elements >= explore_paths_parallel_threshold)
+	{
+		explore_paths_compartment = this;
+		explore_paths_via = via;
+		explore_paths_begin = begin;
+		explore_paths_end = end;
+		explore_paths_dense = dense;
+
+		simthread_barrier_wait(&explore_paths_barrier); // start the workers
+		relax_explore_paths_slice(0);
+		simthread_barrier_wait(&explore_paths_barrier); // wait for all slices to complete
+
+		explore_paths_compartment = NULL;
+		return;
+	}
+#endif
+	for (uint32 i = begin; i < end; ++i)
+	{
+		relax_paths_via(via, via_connected_halts[i], dense);
+	}
+}
+
+bool path_explorer_t::compartment_t::try_incremental_update()
+{
+	// The halts must be the same and at the same matrix indices as in the finished matrix,
+	// and the connexions from which the finished matrix was built must be known.
+	if ( !paths_available || !finished_times || !finished_connexions || !working_connexions
+		|| !working_times || !transport_index_map || !linkages || finished_halt_count != working_halt_count
+		|| memcmp(finished_halt_index_map, working_halt_index_map, 65536 * sizeof(uint16)) != 0 )
+	{
+		return false;
+	}
+
+	const uint16 count = working_halt_count;
+
+	// The exploration does not combine two legs served by the same line or convoy. The transports of the
+	// finished paths are not kept, so this can only be applied to connexions served by walking (which is
+	// exempt) or by a transport which served no connexion before, and so cannot be part of any finished path.
+	bool *served_before = new bool[linkages->get_count() + 1]();
+	bool applicable = true;
+
+	// Any removed, slower or differently served connexion may invalidate paths in the finished matrix
+	// -> full refresh. At this stage, the working matrix only contains the direct connexions.
+	FOR(vector_tpl<direct_connexion_t>, const& old_connexion, *finished_connexions)
+	{
+		const size_t element = matrix_index(old_connexion.origin, old_connexion.target, count);
+		const uint16 old_transport_idx = old_connexion.transport == 0 ? 0 : transport_index_map[old_connexion.transport];
+		if ( working_times[element] > old_connexion.aggregate_time
+			|| (old_connexion.transport != 0 && old_transport_idx == 0)
+			|| working_first_transport[element] != old_transport_idx )
+		{
+			applicable = false;
+			break;
+		}
+		served_before[old_transport_idx] = true;
+	}
+
+	// Only connexions faster than the best known path between their halts can improve any path.
+	vector_tpl<direct_connexion_t> improved_connexions;
+	vector_tpl<uint16> improved_transports;
+	for ( uint32 i = 0; applicable && i < working_connexions->get_count(); ++i )
+	{
+		const direct_connexion_t &new_connexion = (*working_connexions)[i];
+		if ( new_connexion.aggregate_time < get_finished_time(new_connexion.origin, new_connexion.target) )
+		{
+			const uint16 transport_idx = working_first_transport[matrix_index(new_connexion.origin, new_connexion.target, count)];
+			if ( transport_idx != 0 && served_before[transport_idx] )
+			{
+				applicable = false;
+			}
+			improved_connexions.append(new_connexion);
+			improved_transports.append(transport_idx);
+		}
+	}
+	delete[] served_before;
+
+	// Each improved connexion costs a pass over the whole matrix; beyond the budget of a single step,
+	// a normal exploration is used, which can be spread over several steps.
+	const uint64 cost = (uint64)improved_connexions.get_count() * count * count;
+	if ( !applicable || (use_limits && cost > limit_explore_paths) )
+	{
+		return false;
+	}
+
+	// start from the finished matrix. No finished path can share its transport with an improved connexion,
+	// so their transports are recorded as walking, which is never excluded.
+	const size_t element_count = (size_t)count * count;
+	for ( uint16 i = 0; i < count; ++i )
+	{
+		for ( uint16 j = 0; j < count; ++j )
+		{
+			working_times[matrix_index(i, j, count)] = get_finished_time(i, j);
+		}
+	}
+	for ( size_t i = 0; i < element_count; ++i )
+	{
+		working_next_transfer[i] = finished_next_transfer[i];
+		working_first_transport[i] = working_last_transport[i] = 0;
+	}
+
+	// Insert each improved connexion (u, v): any path i -> u -> v -> j formed from the shortest paths
+	// i -> u and v -> j may now be faster, unless the leg before or after the connexion is served by
+	// the same transport. Row v and column u cannot change while doing this.
+	for ( uint32 c = 0; c < improved_connexions.get_count(); ++c )
+	{
+		const direct_connexion_t &connexion = improved_connexions[c];
+		const uint16 transport = improved_transports[c];
+		const uint16 u = connexion.origin;
+		const uint16 v = connexion.target;
+		const uint32 *const from_v = working_times + matrix_index(v, 0, count);
+		const uint16 *const from_v_first = working_first_transport + matrix_index(v, 0, count);
+		const uint16 *const from_v_last = working_last_transport + matrix_index(v, 0, count);
+		for ( uint16 i = 0; i < count; ++i )
+		{
+			const size_t i_u = matrix_index(i, u, count);
+			const uint32 to_u = working_times[i_u];
+			if ( to_u == UINT32_MAX_VALUE || (transport != 0 && working_last_transport[i_u] == transport) )
+			{
+				continue;
+			}
+			const uint32 to_v = to_u + connexion.aggregate_time;
+			const halthandle_t first_transfer = i == u ? connexion.target_halt : working_next_transfer[i_u];
+			const uint16 first_transport = i == u ? transport : working_first_transport[i_u];
+			uint32 *const from_i = working_times + matrix_index(i, 0, count);
+			halthandle_t *const transfers_from_i = working_next_transfer + matrix_index(i, 0, count);
+			uint16 *const first_from_i = working_first_transport + matrix_index(i, 0, count);
+			uint16 *const last_from_i = working_last_transport + matrix_index(i, 0, count);
+			for ( uint16 j = 0; j < count; ++j )
+			{
+				if ( from_v[j] != UINT32_MAX_VALUE && (transport == 0 || from_v_first[j] != transport) && to_v + from_v[j] < from_i[j] )
+				{
+					from_i[j] = to_v + from_v[j];
+					transfers_from_i[j] = first_transfer;
+					first_from_i[j] = first_transport;
+					last_from_i[j] = j == v ? transport : from_v_last[j];
+				}
+			}
+		}
+	}
+
+	total_iterations += (uint32)cost;
+	return true;
+}
+
+
+void path_explorer_t::compartment_t::allocate_working_matrix()
+{
+	const size_t element_count = (size_t)working_halt_count * working_halt_count;
+	working_times = new uint32[element_count];
+	working_next_transfer = new halthandle_t[element_count];
+	working_first_transport = new uint16[element_count]();	// initialise all elements to zero
+	working_last_transport = new uint16[element_count]();	// initialise all elements to zero
+	for (size_t i = 0; i < element_count; ++i)
+	{
+		working_times[i] = UINT32_MAX_VALUE;
+	}
+}
+
+
+void path_explorer_t::compartment_t::free_working_matrix()
+{
+	delete[] working_times;
+	working_times = NULL;
+	delete[] working_next_transfer;
+	working_next_transfer = NULL;
+	delete[] working_first_transport;
+	working_first_transport = NULL;
+	delete[] working_last_transport;
+	working_last_transport = NULL;
+}
+
+
+void path_explorer_t::compartment_t::allocate_finished_times()
+{
+	finished_times = new uint16[(size_t)finished_halt_count * finished_halt_count];
+	finished_times_high = new uint16*[finished_halt_count]();	// initialise all elements to NULL
+}
+
+
+void path_explorer_t::compartment_t::store_finished_times_row(const uint16 row, const uint32 *const times)
+{
+	uint16 *const low = finished_times + matrix_index(row, 0, finished_halt_count);
+	bool fits = true;
+	for ( uint16 j = 0; j < finished_halt_count; ++j )
+	{
+		// finished_time_unreachable itself is reserved for the absence of a path
+		fits &= times[j] < finished_time_unreachable || times[j] == UINT32_MAX_VALUE;
+		low[j] = (uint16)times[j];
+	}
+	if ( !fits )
+	{
+		uint16 *const high = new uint16[finished_halt_count];
+		for ( uint16 j = 0; j < finished_halt_count; ++j )
+		{
+			high[j] = (uint16)(times[j] >> 16);
+		}
+		finished_times_high[row] = high;
+	}
+}
+
+
+void path_explorer_t::compartment_t::update_finished_matrix_memory()
+{
+	const size_t element_count = (size_t)finished_halt_count * finished_halt_count;
+	size_t high_rows = 0;
+	for ( uint16 i = 0; i < finished_halt_count; ++i )
+	{
+		if ( finished_times_high[i] )
+		{
+			++high_rows;
+		}
+	}
+	finished_matrix_memory = element_count * ( sizeof(uint16) + sizeof(halthandle_t) )
+		+ finished_halt_count * sizeof(uint16*) + high_rows * finished_halt_count * sizeof(uint16);
+	const size_t full_memory = element_count * ( sizeof(uint32) + sizeof(halthandle_t) );
+	finished_matrix_memory_saved = full_memory > finished_matrix_memory ? full_memory - finished_matrix_memory : 0;
+}
+
+
+void path_explorer_t::compartment_t::free_finished_matrix()
+{
+	delete[] finished_times;
+	finished_times = NULL;
+	if ( finished_times_high )
+	{
+		for ( uint16 i = 0; i < finished_halt_count; ++i )
+		{
+			delete[] finished_times_high[i];
+		}
+		delete[] finished_times_high;
+		finished_times_high = NULL;
+	}
+	delete[] finished_next_transfer;
+	finished_next_transfer = NULL;
+	finished_matrix_memory = 0;
+	finished_matrix_memory_saved = 0;
+}
+
+
+void path_explorer_t::compartment_t::prepare_hub_labels()
+{
+	const uint16 count = working_halt_count;
+	const uint32 connexion_count = working_connexions ? working_connexions->get_count() : 0;
+
+	// the direct connexions were recorded in order of origin, so only the reverse graph needs sorting
+	hub_forward_offsets = new uint32[count + 1]();	// initialise all elements to zero
+	hub_reverse_offsets = new uint32[count + 1]();	// initialise all elements to zero
+	for ( uint32 i = 0; i < connexion_count; ++i )
+	{
+		const direct_connexion_t &connexion = (*working_connexions)[i];
+		++hub_forward_offsets[connexion.origin + 1];
+		++hub_reverse_offsets[connexion.target + 1];
+	}
+	for ( uint16 i = 0; i < count; ++i )
+	{
+		hub_forward_offsets[i + 1] += hub_forward_offsets[i];
+		hub_reverse_offsets[i + 1] += hub_reverse_offsets[i];
+	}
+	hub_reverse_connexions = new uint32[connexion_count];
+	uint32 *const reverse_cursor = new uint32[count + 1];
+	memcpy(reverse_cursor, hub_reverse_offsets, (count + 1) * sizeof(uint32));
+	for ( uint32 i = 0; i < connexion_count; ++i )
+	{
+		hub_reverse_connexions[ reverse_cursor[(*working_connexions)[i].target]++ ] = i;
+	}
+	delete[] reverse_cursor;
+
+	// Halts with many connexions in both directions lie on the most shortest paths, so making them hubs
+	// first keeps the labels small. Ties are broken by matrix index for a deterministic order.
+	hub_order = new uint16[count];
+	for ( uint16 i = 0; i < count; ++i )
+	{
+		hub_order[i] = i;
+	}
+	const uint32 *const forward_offsets = hub_forward_offsets;
+	const uint32 *const reverse_offsets = hub_reverse_offsets;
+	std::sort(hub_order, hub_order + count, [forward_offsets, reverse_offsets](const uint16 a, const uint16 b)
+	{
+		const uint64 importance_a = (uint64)( forward_offsets[a + 1] - forward_offsets[a] + 1 ) * ( reverse_offsets[a + 1] - reverse_offsets[a] + 1 );
+		const uint64 importance_b = (uint64)( forward_offsets[b + 1] - forward_offsets[b] + 1 ) * ( reverse_offsets[b + 1] - reverse_offsets[b] + 1 );
+		return importance_a > importance_b || ( importance_a == importance_b && a < b );
+	});
+
+	// the labels of the hubs already processed may have been loaded
+	if ( !working_labels_out )
+	{
+		working_labels_out = new vector_tpl<hub_label_t>[count];
+		working_labels_in = new vector_tpl<hub_label_t>[count];
+	}
+	hub_search_times = new uint32[count];
+	hub_search_first_hop = new halthandle_t[count];
+	hub_search_edge_transport = new uint32[count];
+	hub_search_hub_transport = new uint32[count];
+	hub_pruning_times = new uint32[count];
+	hub_pruning_transports = new uint32[count];
+	for ( uint16 i = 0; i < count; ++i )
+	{
+		hub_search_times[i] = UINT32_MAX_VALUE;
+		hub_pruning_times[i] = UINT32_MAX_VALUE;
+		hub_pruning_transports[i] = 0;
+	}
+}
+
+
+uint32 path_explorer_t::compartment_t::add_hub_to_labels(const uint16 rank, const bool outbound)
+{
+	// An outbound search follows the connexions backwards from the hub, to find the paths from other halts to it;
+	// an inbound search follows them forwards, to find the paths from the hub to other halts.
+	const uint16 source = hub_order[rank];
+	vector_tpl<hub_label_t> *const labels = outbound ? working_labels_out : working_labels_in;
+
+	// the opposite label of the hub gives the times between it and the more important hubs
+	const vector_tpl<hub_label_t> &source_labels = outbound ? working_labels_in[source] : working_labels_out[source];
+	FOR(vector_tpl<hub_label_t>, const& label, source_labels)
+	{
+		hub_pruning_times[label.hub] = label.aggregate_time;
+		hub_pruning_transports[label.hub] = label.hub_transport;
+	}
+
+	uint32 iterations = 0;
+
+	hub_search_node_t node;
+	node.aggregate_time = 0;
+	node.halt = source;
+	hub_search_times[source] = 0;
+	hub_search_first_hop[source] = halthandle_t();
+	hub_search_edge_transport[source] = 0;
+	hub_search_hub_transport[source] = 0;
+	hub_search_reached.append(source);
+	hub_search_queue.append(node);
+
+	while ( !hub_search_queue.empty() )
+	{
+		std::pop_heap(hub_search_queue.begin(), hub_search_queue.end());
+		const hub_search_node_t current = hub_search_queue.pop_back();
+		++iterations;
+
+		// skip queue entries superseded by a shorter time
+		if ( current.aggregate_time != hub_search_times[current.halt] )
+		{
+			continue;
+		}
+
+		// prune the search where a more important hub already gives a path at least as short
+		vector_tpl<hub_label_t> &current_labels = labels[current.halt];
+		bool covered = false;
+		FOR(vector_tpl<hub_label_t>, const& label, current_labels)
+		{
+			if ( hub_pruning_times[label.hub] != UINT32_MAX_VALUE && (uint64)hub_pruning_times[label.hub] + label.aggregate_time <= current.aggregate_time
+				&& (label.hub_transport != hub_pruning_transports[label.hub] || label.hub_transport == 0) )
+			{
+				covered = true;
+				break;
+			}
+		}
+		iterations += current_labels.get_count();
+		if ( covered )
+		{
+			continue;
+		}
+
+		hub_label_t label;
+		label.hub = rank;
+		label.first_hop = hub_search_first_hop[current.halt];
+		label.aggregate_time = current.aggregate_time;
+		label.hub_transport = hub_search_hub_transport[current.halt];
+		current_labels.append(label);
+
+		// a connexion is not followed if the same line or convoy serves the leg at this halt (walking is exempt)
+		const uint32 edge_transport = hub_search_edge_transport[current.halt];
+
+		const uint32 begin = outbound ? hub_reverse_offsets[current.halt] : hub_forward_offsets[current.halt];
+		const uint32 end = outbound ? hub_reverse_offsets[current.halt + 1] : hub_forward_offsets[current.halt + 1];
+		for ( uint32 i = begin; i < end; ++i )
+		{
+			const direct_connexion_t &connexion = (*working_connexions)[ outbound ? hub_reverse_connexions[i] : i ];
+			const uint16 next = outbound ? connexion.origin : connexion.target;
+			if ( current.aggregate_time > UINT32_MAX_VALUE - connexion.aggregate_time
+				|| (connexion.transport == edge_transport && edge_transport != 0) )
+			{
+				continue;
+			}
+			const uint32 time = current.aggregate_time + connexion.aggregate_time;
+			if ( time < hub_search_times[next] )
+			{
+				if ( hub_search_times[next] == UINT32_MAX_VALUE )
+				{
+					hub_search_reached.append(next);
+				}
+				hub_search_times[next] = time;
+				hub_search_edge_transport[next] = connexion.transport;
+				hub_search_hub_transport[next] = current.halt == source ? connexion.transport : hub_search_hub_transport[current.halt];
+				if ( outbound )
+				{
+					// the next halt on the way to the hub
+					hub_search_first_hop[next] = connexion.target_halt;
+				}
+				else
+				{
+					// the first halt after the hub
+					hub_search_first_hop[next] = current.halt == source ? connexion.target_halt : hub_search_first_hop[current.halt];
+				}
+				node.aggregate_time = time;
+				node.halt = next;
+				hub_search_queue.append(node);
+				std::push_heap(hub_search_queue.begin(), hub_search_queue.end());
+			}
+		}
+		iterations += end - begin;
+	}
+
+	FOR(vector_tpl<uint16>, const halt, hub_search_reached)
+	{
+		hub_search_times[halt] = UINT32_MAX_VALUE;
+	}
+	hub_search_reached.clear();
+	FOR(vector_tpl<hub_label_t>, const& label, source_labels)
+	{
+		hub_pruning_times[label.hub] = UINT32_MAX_VALUE;
+		hub_pruning_transports[label.hub] = 0;
+	}
+
+	return iterations;
+}
+
+
+void path_explorer_t::compartment_t::store_finished_labels()
+{
+	finished_label_offsets_out = new uint32[finished_halt_count + 1];
+	finished_label_offsets_in = new uint32[finished_halt_count + 1];
+	finished_label_offsets_out[0] = 0;
+	finished_label_offsets_in[0] = 0;
+	for ( uint16 i = 0; i < finished_halt_count; ++i )
+	{
+		finished_label_offsets_out[i + 1] = finished_label_offsets_out[i] + working_labels_out[i].get_count();
+		finished_label_offsets_in[i + 1] = finished_label_offsets_in[i] + working_labels_in[i].get_count();
+	}
+
+	finished_labels_out = new hub_label_t[ finished_label_offsets_out[finished_halt_count] ];
+	finished_labels_in = new hub_label_t[ finished_label_offsets_in[finished_halt_count] ];
+	for ( uint16 i = 0; i < finished_halt_count; ++i )
+	{
+		if ( !working_labels_out[i].empty() )
+		{
+			memcpy(finished_labels_out + finished_label_offsets_out[i], working_labels_out[i].begin(), working_labels_out[i].get_count() * sizeof(hub_label_t));
+		}
+		if ( !working_labels_in[i].empty() )
+		{
+			memcpy(finished_labels_in + finished_label_offsets_in[i], working_labels_in[i].begin(), working_labels_in[i].get_count() * sizeof(hub_label_t));
+		}
+	}
+
+	finished_matrix_memory = ( (size_t)finished_label_offsets_out[finished_halt_count] + finished_label_offsets_in[finished_halt_count] ) * sizeof(hub_label_t)
+		+ ( (size_t)finished_halt_count + 1 ) * 2 * sizeof(uint32);
+	const size_t full_memory = (size_t)finished_halt_count * finished_halt_count * ( sizeof(uint32) + sizeof(halthandle_t) );
+	finished_matrix_memory_saved = full_memory > finished_matrix_memory ? full_memory - finished_matrix_memory : 0;
+}
+
+
+void path_explorer_t::compartment_t::free_hub_label_search()
+{
+	delete[] working_labels_out;
+	working_labels_out = NULL;
+	delete[] working_labels_in;
+	working_labels_in = NULL;
+	delete[] hub_order;
+	hub_order = NULL;
+	delete[] hub_forward_offsets;
+	hub_forward_offsets = NULL;
+	delete[] hub_reverse_offsets;
+	hub_reverse_offsets = NULL;
+	delete[] hub_reverse_connexions;
+	hub_reverse_connexions = NULL;
+	delete[] hub_search_times;
+	hub_search_times = NULL;
+	delete[] hub_search_first_hop;
+	hub_search_first_hop = NULL;
+	delete[] hub_search_edge_transport;
+	hub_search_edge_transport = NULL;
+	delete[] hub_search_hub_transport;
+	hub_search_hub_transport = NULL;
+	delete[] hub_pruning_times;
+	hub_pruning_times = NULL;
+	delete[] hub_pruning_transports;
+	hub_pruning_transports = NULL;
+	hub_search_reached.clear();
+	hub_search_queue.clear();
+}
+
+
+void path_explorer_t::compartment_t::free_finished_labels()
+{
+	if ( finished_labels_out )
+	{
+		finished_matrix_memory = 0;
+		finished_matrix_memory_saved = 0;
+	}
+	delete[] finished_labels_out;
+	finished_labels_out = NULL;
+	delete[] finished_labels_in;
+	finished_labels_in = NULL;
+	delete[] finished_label_offsets_out;
+	finished_label_offsets_out = NULL;
+	delete[] finished_label_offsets_in;
+	finished_label_offsets_in = NULL;
+}
+
+
+void path_explorer_t::compartment_t::collect_connected_halts(const uint16 via)
+{
+	const uint32 *const via_times = working_times + matrix_index(via, 0, working_halt_count);
+	via_connected_count = 0;
+	for ( uint16 idx = 0; idx < working_halt_count; ++idx )
+	{
+		if ( via_times[idx] != UINT32_MAX_VALUE && via != idx )
+		{
+			via_connected_halts[via_connected_count++] = idx;
+		}
+	}
+}
+
+
+void path_explorer_t::compartment_t::relax_paths_via(const uint16 via, const uint16 origin, const bool dense)
+{
+	const uint16 count = working_halt_count;
+
+	// values along the path from origin to the transfer are the same for every target
+	const size_t origin_via = matrix_index(origin, via, count);
+	const uint32 origin_via_time = working_times[origin_via];
+	const halthandle_t origin_via_transfer = working_next_transfer[origin_via];
+	const uint16 origin_via_first = working_first_transport[origin_via];
+	const uint16 inbound_transport = working_last_transport[origin_via];
+
+	const uint32 *const via_times = working_times + matrix_index(via, 0, count);
+	const uint16 *const via_first = working_first_transport + matrix_index(via, 0, count);
+	const uint16 *const via_last = working_last_transport + matrix_index(via, 0, count);
+
+	uint32 *const origin_times = working_times + matrix_index(origin, 0, count);
+	halthandle_t *const origin_transfers = working_next_transfer + matrix_index(origin, 0, count);
+	uint16 *const origin_first = working_first_transport + matrix_index(origin, 0, count);
+	uint16 *const origin_last = working_last_transport + matrix_index(origin, 0, count);
+
+	// A connection is not relaxed through a transfer if the same line or convoy serves both legs
+	// (walking, transport 0, is exempt), since that path would already be covered without transferring.
+	// Note that the additions below deliberately wrap in the same way as the original per-cluster loop.
+	if (dense)
+	{
+		// Branch-free pass over the whole row: this is the common case once a network is well connected.
+		for (uint16 target = 0; target < count; ++target)
+		{
+			const uint32 combined_time = origin_via_time + via_times[target];
+			const bool improved = (via_times[target] != UINT32_MAX_VALUE)
+				& (target != via)
+				& ((via_first[target] != inbound_transport) | (inbound_transport == 0u))
+				& (combined_time < origin_times[target]);
+			origin_times[target] = improved ? combined_time : origin_times[target];
+			origin_first[target] = improved ? origin_via_first : origin_first[target];
+			origin_last[target] = improved ? via_last[target] : origin_last[target];
+			if (improved)
+			{
+				origin_transfers[target] = origin_via_transfer;
+			}
+		}
+	}
+	else
+	{
+		for (uint16 i = 0; i < via_connected_count; ++i)
+		{
+			const uint16 target = via_connected_halts[i];
+			if (via_first[target] == inbound_transport && inbound_transport != 0u)
+			{
+				continue;
+			}
+			const uint32 combined_time = origin_via_time + via_times[target];
+			if (combined_time < origin_times[target])
+			{
+				origin_times[target] = combined_time;
+				origin_transfers[target] = origin_via_transfer;
+				origin_first[target] = origin_via_first;
+				origin_last[target] = via_last[target];
+			}
+		}
+	}
+}
+
+
 void path_explorer_t::compartment_t::set_absolute_limits()
 {
 	time_midpoint = get_world()->get_settings().get_path_explorer_time_midpoint();
@@ -1383,21 +2094,17 @@ void path_explorer_t::compartment_t::step()
 			// build working matrix and transfer list only if we are not resuming
 			if (phase_counter == 0)
 			{
+				working_hub_labels = world->get_settings().get_path_explorer_backend() == settings_t::PATH_EXPLORER_HUB_LABELS;
 				if (working_halt_count > 0)
 				{
-					// build working matrix
-					working_matrix = new path_element_t*[working_halt_count];
-					for (uint16 i = 0; i < working_halt_count; ++i)
+					// build working and transport matrices, unless the paths are to be found from the direct connexions alone
+					if (!working_hub_labels)
 					{
-						working_matrix[i] = new path_element_t[working_halt_count];
+						allocate_working_matrix();
 					}
 
-					// build transport matrix
-					transport_matrix = new transport_element_t*[working_halt_count];
-					for (uint16 i = 0; i < working_halt_count; ++i)
-					{
-						transport_matrix[i] = new transport_element_t[working_halt_count];
-					}
+					// record the direct connexions for detecting incremental changes next time, or for building hub labels
+					working_connexions = new vector_tpl<direct_connexion_t>(working_halt_count);
 
 					// build transfer list
 					transfer_list = new uint16[working_halt_count];
@@ -1445,20 +2152,24 @@ void path_explorer_t::compartment_t::step()
 
 					// validate transport and determine transport index
 					uint16 transport_idx;
+					uint32 transport;
 					if ( current_connexion->best_line.is_null() && current_connexion->best_convoy.is_null() )
 					{
 						// passengers walking between 2 halts
+						transport = 0;
 						transport_idx = 0;
 					}
 					else if ( current_connexion->best_line.is_bound() )
 					{
 						// valid line
-						transport_idx = transport_index_map[ current_connexion->best_line.get_id() ];
+						transport = current_connexion->best_line.get_id();
+						transport_idx = transport_index_map[ transport ];
 					}
 					else if ( current_connexion->best_convoy.is_bound() )
 					{
 						// valid lineless convoy
-						transport_idx = transport_index_map[ 65536u + current_connexion->best_convoy.get_id() ];
+						transport = 65536u + current_connexion->best_convoy.get_id();
+						transport_idx = transport_index_map[ transport ];
 					}
 					else
 					{
@@ -1474,19 +2185,37 @@ void path_explorer_t::compartment_t::step()
 						continue;
 					}
 
+					const uint32 aggregate_time = current_connexion->waiting_time + current_connexion->journey_time + current_connexion->transfer_time;
+
 					// update corresponding matrix element
-					working_matrix[phase_counter][reachable_halt_index].next_transfer = reachable_halt;
-					working_matrix[phase_counter][reachable_halt_index].aggregate_time = current_connexion->waiting_time + current_connexion->journey_time + current_connexion->transfer_time;
-					transport_matrix[phase_counter][reachable_halt_index].first_transport
-						= transport_matrix[phase_counter][reachable_halt_index].last_transport
-						= transport_idx;
+					if (working_times)
+					{
+						const size_t element = matrix_index(phase_counter, reachable_halt_index, working_halt_count);
+						working_next_transfer[element] = reachable_halt;
+						working_times[element] = aggregate_time;
+						working_first_transport[element] = working_last_transport[element] = transport_idx;
+					}
+
+					if (working_connexions)
+					{
+						direct_connexion_t direct_connexion;
+						direct_connexion.origin = phase_counter;
+						direct_connexion.target = reachable_halt_index;
+						direct_connexion.aggregate_time = aggregate_time;
+						direct_connexion.target_halt = reachable_halt;
+						direct_connexion.transport = transport;
+						working_connexions->append(direct_connexion);
+					}
 
 					// Debug journey times
-					// printf("\n%s -> %s : %lu \n",current_halt->get_name(), reachable_halt->get_name(), working_matrix[phase_counter][reachable_halt_index].journey_time);
+					// printf("\n%s -> %s : %lu \n",current_halt->get_name(), reachable_halt->get_name(), working_times[element]);
 				}
 
 				// Special case
-				working_matrix[phase_counter][phase_counter].aggregate_time = 0;
+				if (working_times)
+				{
+					working_times[matrix_index(phase_counter, phase_counter, working_halt_count)] = 0;
+				}
 
 				++phase_counter;
 
@@ -1550,6 +2279,13 @@ void path_explorer_t::compartment_t::step()
 					delete[] working_halt_list;
 					working_halt_list = NULL;
 				}
+
+				if ( try_incremental_update() )
+				{
+					// the working matrix is complete -> nothing to explore, the next step publishes it
+					transfer_count = 0;
+				}
+
 				if (transport_index_map)
 				{
 					delete[] transport_index_map;
@@ -1581,119 +2317,113 @@ void path_explorer_t::compartment_t::step()
 
 			printf("\t\tCurrent Step : %lu \n", step_count);
 #endif
-			// temporary variables
-			uint32 combined_time;
-			uint32 target_member_index;
 			uint64 iterations_processed = 0;
 
-			// initialize only when not resuming
-			if ( via_index == 0 && origin_cluster_index == 0 && target_cluster_index == 0 && origin_member_index == 0 )
+			if ( working_hub_labels )
 			{
-				// build data structures for inbound/outbound connections to/from transfer halts
-				inbound_connections = new connection_t(64u, working_halt_count);
-				outbound_connections = new connection_t(64u, working_halt_count);
-			}
-
-			start = dr_time();	// start timing
+				// initialize only when not resuming
+				if ( !hub_order )
+				{
+					prepare_hub_labels();
+				}
 
-			// for each transfer
-			while ( via_index < transfer_count )
-			{
-				const uint16 via = transfer_list[via_index];
+				start = dr_time();	// start timing
 
-				if ( process_next_transfer )
+				// Pruned labelling : each halt in turn, from the most important, becomes a hub of the halts
+				// to and from which it lies on a shortest path not already covered by a more important hub.
+				while ( via_index < working_halt_count )
 				{
-					// prevent reconstruction of connected halt list while resuming in subsequent steps
-					process_next_transfer = false;
+					const uint32 hub_iterations = add_hub_to_labels(via_index, false) + add_hub_to_labels(via_index, true);
+					iterations_processed += hub_iterations;
+					total_iterations += hub_iterations;
+					++via_index;
 
-					// identify halts which are connected with the current transfer halt
-					for ( uint16 idx = 0; idx < working_halt_count; ++idx )
+					// iteration control
+					if ( use_limits && iterations_processed >= limit_explore_paths )
 					{
-						if ( working_matrix[via][idx].aggregate_time != UINT32_MAX_VALUE && via != idx )
-						{
-							inbound_connections->register_connection( transport_matrix[idx][via].last_transport, idx );
-							outbound_connections->register_connection( transport_matrix[via][idx].first_transport, idx );
-						}
+						break;
 					}
-
-					// should take into account the iterations above
-					iterations_processed += (uint32)working_halt_count + ( inbound_connections->get_total_member_count() << 1 );
-					total_iterations += (uint32)working_halt_count + ( inbound_connections->get_total_member_count() << 1 );
 				}
-
-				// for each origin cluster
-				while ( origin_cluster_index < inbound_connections->get_cluster_count() )
+			}
+			else
+			{
+				// initialize only when not resuming
+				if ( !via_connected_halts )
 				{
-					const connection_t::connection_cluster_t &origin_cluster = (*inbound_connections)[origin_cluster_index];
-					const uint16 inbound_transport = origin_cluster.transport;
-					const vector_tpl<uint16> &origin_halt_list = origin_cluster.connected_halts;
+					via_connected_halts = new uint16[working_halt_count];
+					via_connected_count = 0;
 
-					// for each target cluster
-					while ( target_cluster_index < outbound_connections->get_cluster_count() )
+					// the connected halt list is not saved -> rebuild it if a saved game is resumed within a transfer
+					if ( !process_next_transfer && via_index < transfer_count )
 					{
-						const connection_t::connection_cluster_t &target_cluster = (*outbound_connections)[target_cluster_index];
-						const uint16 outbound_transport = target_cluster.transport;
-						if ( inbound_transport == outbound_transport && inbound_transport != 0u )
-						{
-							++target_cluster_index;
-							continue;
-						}
-						const vector_tpl<uint16> &target_halt_list = target_cluster.connected_halts;
-
-						// for each origin cluster member
-						while ( origin_member_index < origin_halt_list.get_count() )
-						{
-							const uint16 origin = origin_halt_list[origin_member_index];
+						collect_connected_halts( transfer_list[via_index] );
+					}
+				}
 
-							// for each target cluster member
-							for ( target_member_index = 0; target_member_index < target_halt_list.get_count(); ++target_member_index )
-							{
-								const uint16 target = target_halt_list[target_member_index];
-
-								if ( ( combined_time = working_matrix[origin][via].aggregate_time
-													 + working_matrix[via][target].aggregate_time )
-											< working_matrix[origin][target].aggregate_time			   )
-								{
-									working_matrix[origin][target].aggregate_time = combined_time;
-									working_matrix[origin][target].next_transfer = working_matrix[origin][via].next_transfer;
-									transport_matrix[origin][target].first_transport = transport_matrix[origin][via].first_transport;
-									transport_matrix[origin][target].last_transport = transport_matrix[via][target].last_transport;
-								}
-							}	// loop : target cluster member
-
-							++origin_member_index;
-
-							// iteration control
-							iterations_processed += target_halt_list.get_count();
-							total_iterations += target_halt_list.get_count();
-							if ( use_limits && iterations_processed >= limit_explore_paths )
-							{
-								goto loop_termination;
-							}
+				start = dr_time();	// start timing
 
-						}	// loop : origin cluster member
+				// for each transfer
+				while ( via_index < transfer_count )
+				{
+					const uint16 via = transfer_list[via_index];
 
+					if ( process_next_transfer )
+					{
+						// prevent reconstruction of connected halt list while resuming in subsequent steps
+						process_next_transfer = false;
 						origin_member_index = 0;
 
-						++target_cluster_index;
+						// identify halts which are connected with the current transfer halt
+						collect_connected_halts(via);
 
-					}	// loop : target cluster
+						// should take into account the iterations above
+						iterations_processed += (uint32)working_halt_count + ( (uint32)via_connected_count << 1 );
+						total_iterations += (uint32)working_halt_count + ( (uint32)via_connected_count << 1 );
+					}
 
-					target_cluster_index = 0;
+					// Row relaxation: all connected targets of the transfer are relaxed for one origin at a time.
+					// Origins are independent of each other within one transfer, as neither the transfer row
+					// nor the origin->transfer column can change here, so the order of origins does not affect the result.
+					// Once the transfer reaches a sizeable share of the halts, a contiguous pass over the whole row is
+					// cheaper than gathering individual targets.
+					const bool dense = ( (uint32)via_connected_count << 2 ) >= working_halt_count;
+					const uint32 row_iterations = dense ? working_halt_count : via_connected_count;
 
-					++origin_cluster_index;
+					// for each batch of origins
+					while ( origin_member_index < via_connected_count )
+					{
+						// The batch ends with the row which reaches the iteration limit, exactly where
+						// processing one row at a time would stop, so that the limits behave identically.
+						uint32 batch_end = via_connected_count;
+						if ( use_limits )
+						{
+							const uint64 remaining = limit_explore_paths > iterations_processed ? limit_explore_paths - iterations_processed : 0;
+							const uint64 batch_rows = max( ( remaining + row_iterations - 1 ) / row_iterations, (uint64)1 );
+							if ( batch_rows < via_connected_count - origin_member_index )
+							{
+								batch_end = origin_member_index + (uint32)batch_rows;
+							}
+						}
+
+						relax_connected_halts(via, origin_member_index, batch_end, dense);
 
-				}	// loop : origin cluster
+						// iteration control
+						iterations_processed += (uint64)( batch_end - origin_member_index ) * row_iterations;
+						total_iterations += ( batch_end - origin_member_index ) * row_iterations;
+						origin_member_index = batch_end;
+						if ( use_limits && iterations_processed >= limit_explore_paths )
+						{
+							goto loop_termination;
+						}
 
-				origin_cluster_index = 0;
+					}	// loop : origin batch
 
-				// clear the inbound/outbound connections
-				inbound_connections->reset();
-				outbound_connections->reset();
-				process_next_transfer = true;
+					origin_member_index = 0;
+					process_next_transfer = true;
 
-				++via_index;
-			}	// loop : transfer
+					++via_index;
+				}	// loop : transfer
+			}
 
 		loop_termination :
 
@@ -1711,7 +2441,7 @@ void path_explorer_t::compartment_t::step()
 			printf("\t\t\tPath searching -> %lu iterations takes :  %lu ms \n", static_cast<unsigned long>(iterations_processed), diff);
 #endif
 
-			if (via_index == transfer_count)
+			if ( via_index == ( working_hub_labels ? working_halt_count : transfer_count ) )
 			{
 				// iteration limit adjustment
 				if ( catg == representative_category )
@@ -1745,15 +2475,8 @@ void path_explorer_t::compartment_t::step()
 
 
 				// path search completed -> delete old path info
-				if (finished_matrix)
-				{
-					for (uint16 i = 0; i < finished_halt_count; ++i)
-					{
-						delete[] finished_matrix[i];
-					}
-					delete[] finished_matrix;
-					finished_matrix = NULL;
-				}
+				free_finished_matrix();
+				free_finished_labels();
 				if (finished_halt_index_map)
 				{
 					delete[] finished_halt_index_map;
@@ -1761,23 +2484,38 @@ void path_explorer_t::compartment_t::step()
 				}
 
 				// transfer working to finished
-				finished_matrix = working_matrix;
-				working_matrix = NULL;
-				finished_halt_index_map = working_halt_index_map;
-				working_halt_index_map = NULL;
 				finished_halt_count = working_halt_count;
-				// working_halt_count is reset below after deleting transport matrix
+				if ( working_hub_labels )
+				{
+					store_finished_labels();
+					free_hub_label_search();
 
-				// path search completed -> delete auxilliary data structures
-				if (transport_matrix)
+					DBG_DEBUG("path_explorer_t::compartment_t::step()", "%s %s: hub labels of %u halts use %lu bytes, %lu bytes saved compared with a path matrix",
+						catg_name, get_class_name(), (unsigned)finished_halt_count, (unsigned long)finished_matrix_memory, (unsigned long)finished_matrix_memory_saved);
+				}
+				else
 				{
-					for (uint16 i = 0; i < working_halt_count; ++i)
+					allocate_finished_times();
+					for ( uint16 i = 0; i < finished_halt_count; ++i )
 					{
-						delete[] transport_matrix[i];
+						store_finished_times_row( i, working_times + matrix_index(i, 0, finished_halt_count) );
 					}
-					delete[] transport_matrix;
-					transport_matrix = NULL;
+					update_finished_matrix_memory();
+					finished_next_transfer = working_next_transfer;
+					working_next_transfer = NULL;
+
+					DBG_DEBUG("path_explorer_t::compartment_t::step()", "%s %s: path matrix of %u halts uses %lu bytes, %lu bytes saved by compact times",
+						catg_name, get_class_name(), (unsigned)finished_halt_count, (unsigned long)finished_matrix_memory, (unsigned long)finished_matrix_memory_saved);
 				}
+				finished_halt_index_map = working_halt_index_map;
+				working_halt_index_map = NULL;
+
+				delete finished_connexions;
+				finished_connexions = working_connexions;
+				working_connexions = NULL;
+
+				// path search completed -> delete auxilliary data structures
+				free_working_matrix();
 				working_halt_count = 0;
 				if (transfer_list)
 				{
@@ -1786,27 +2524,21 @@ void path_explorer_t::compartment_t::step()
 				}
 				transfer_count = 0;
 
-				if (inbound_connections)
+				if (via_connected_halts)
 				{
-					delete inbound_connections;
-					inbound_connections = NULL;
-				}
-				if (outbound_connections)
-				{
-					delete outbound_connections;
-					outbound_connections = NULL;
+					delete[] via_connected_halts;
+					via_connected_halts = NULL;
 				}
+				via_connected_count = 0;
 				process_next_transfer = true;
 
 				// Debug paths : to execute, working_halt_list should not be deleted in the previous phase
-				// enumerate_all_paths(finished_matrix, working_halt_list, finished_halt_index_map, finished_halt_count);
+				// enumerate_all_paths(working_halt_list);
 
 				current_phase = phase_reroute_goods;	// proceed to the next phase
 
 				// reset counters
 				via_index = 0;
-				origin_cluster_index = 0;
-				target_cluster_index = 0;
 				origin_member_index = 0;
 
 				paths_available = true;
@@ -1939,9 +2671,11 @@ void path_explorer_t::compartment_t::step()
 }
 
 
-void path_explorer_t::compartment_t::enumerate_all_paths(const path_element_t *const *const matrix, const halthandle_t *const halt_list,
-														 const uint16 *const halt_map, const uint16 halt_count)
+void path_explorer_t::compartment_t::enumerate_all_paths(const halthandle_t *const halt_list)
 {
+	const uint16 *const halt_map = finished_halt_index_map;
+	const uint16 halt_count = finished_halt_count;
+
 	// Debugging code : Enumerate all paths for validation
 	halthandle_t transfer_halt;
 
@@ -1954,9 +2688,9 @@ void path_explorer_t::compartment_t::enumerate_all_paths(const path_element_t *c
 				// print origin
 				printf("\n\nOrigin :  %s\n", halt_list[x]->get_name());
 
-				transfer_halt = matrix[x][y].next_transfer;
+				transfer_halt = finished_next_transfer[matrix_index(x, y, halt_count)];
 
-				if (matrix[x][y].aggregate_time == UINT32_MAX_VALUE)
+				if (get_finished_time(x, y) == UINT32_MAX_VALUE)
 				{
 					printf("\t\t\t\t******** No Route ********\n");
 				}
@@ -1968,7 +2702,7 @@ void path_explorer_t::compartment_t::enumerate_all_paths(const path_element_t *c
 
 						if ( halt_map[transfer_halt.get_id()] != 65535)
 						{
-							transfer_halt = matrix[ halt_map[transfer_halt.get_id()] ][y].next_transfer;
+							transfer_halt = finished_next_transfer[ matrix_index(halt_map[transfer_halt.get_id()], y, halt_count) ];
 						}
 						else
 						{
@@ -1994,12 +2728,58 @@ bool path_explorer_t::compartment_t::get_path_between(const halthandle_t origin_
 	// check if origin and target halts are both present in matrix; if yes, check the validity of the next transfer
 	if ( paths_available /*&& origin_halt.is_bound() && target_halt.is_bound()*/
 			&& ( origin_index = finished_halt_index_map[ origin_halt.get_id() ] ) != 65535
-			&& ( target_index = finished_halt_index_map[ target_halt.get_id() ] ) != 65535
-			&& finished_matrix[origin_index][target_index].next_transfer.is_bound() )
+			&& ( target_index = finished_halt_index_map[ target_halt.get_id() ] ) != 65535 )
 	{
-		aggregate_time = finished_matrix[origin_index][target_index].aggregate_time;
-		next_transfer = finished_matrix[origin_index][target_index].next_transfer;
-		return true;
+		if ( finished_labels_out )
+		{
+			// the shortest path passes through the common hub of the outbound label of the origin
+			// and the inbound label of the target with the smallest total time
+			if ( origin_index != target_index )
+			{
+				const hub_label_t *out = finished_labels_out + finished_label_offsets_out[origin_index];
+				const hub_label_t *const out_end = finished_labels_out + finished_label_offsets_out[origin_index + 1];
+				const hub_label_t *in = finished_labels_in + finished_label_offsets_in[target_index];
+				const hub_label_t *const in_end = finished_labels_in + finished_label_offsets_in[target_index + 1];
+				uint64 best_time = UINT32_MAX_VALUE;
+				halthandle_t best_transfer;
+				while ( out < out_end && in < in_end )
+				{
+					if ( out->hub < in->hub )
+					{
+						++out;
+					}
+					else if ( out->hub > in->hub )
+					{
+						++in;
+					}
+					else
+					{
+						// the legs at the hub must not be served by the same line or convoy (walking is exempt)
+						const uint64 time = (uint64)out->aggregate_time + in->aggregate_time;
+						if ( time < best_time && (out->hub_transport != in->hub_transport || out->hub_transport == 0) )
+						{
+							best_time = time;
+							// the origin's own entry has no first hop : the origin is the hub itself
+							best_transfer = out->first_hop.is_bound() ? out->first_hop : in->first_hop;
+						}
+						++out;
+						++in;
+					}
+				}
+				if ( best_transfer.is_bound() )
+				{
+					aggregate_time = (uint32)best_time;
+					next_transfer = best_transfer;
+					return true;
+				}
+			}
+		}
+		else if ( finished_next_transfer[matrix_index(origin_index, target_index, finished_halt_count)].is_bound() )
+		{
+			aggregate_time = get_finished_time(origin_index, target_index);
+			next_transfer = finished_next_transfer[matrix_index(origin_index, target_index, finished_halt_count)];
+			return true;
+		}
 	}
 
 	// requested path not found
@@ -2107,7 +2887,7 @@ void path_explorer_t::compartment_t::rdwr(loadsave_t* file)
 		}
 	}
 
-	bool finished_matrix_live = finished_matrix != NULL;
+	bool finished_matrix_live = finished_times != NULL;
 	file->rdwr_bool(finished_matrix_live);
 
 	if (finished_matrix_live)
@@ -2115,13 +2895,15 @@ void path_explorer_t::compartment_t::rdwr(loadsave_t* file)
 		if (file->is_saving())
 		{
 			uint16 tmp_idx;
+			uint32 tmp_time;
+			// This is a 2 dimensional array, saved with full 32 bit times
 			for (uint16 i = 0; i < finished_halt_count; i++)
 			{
-				//  This is a 2 dimensional array
-				for (uint32 j = 0; j < finished_halt_count; j++)
+				for (uint16 j = 0; j < finished_halt_count; j++)
 				{
-					file->rdwr_long(finished_matrix[i][j].aggregate_time);
-					tmp_idx = finished_matrix[i][j].next_transfer.get_id();
+					tmp_time = get_finished_time(i, j);
+					file->rdwr_long(tmp_time);
+					tmp_idx = finished_next_transfer[matrix_index(i, j, finished_halt_count)].get_id();
 					file->rdwr_short(tmp_idx);
 				}
 			}
@@ -2133,22 +2915,23 @@ void path_explorer_t::compartment_t::rdwr(loadsave_t* file)
 			{
 				// Build the (empty) finished matrix
 				uint16 tmp_idx;
-				finished_matrix = new path_element_t*[finished_halt_count];
-				for (uint16 i = 0; i < finished_halt_count; ++i)
-				{
-					finished_matrix[i] = new path_element_t[finished_halt_count];
-				}
+				allocate_finished_times();
+				finished_next_transfer = new halthandle_t[(size_t)finished_halt_count * finished_halt_count];
 
-				// Now load them. These are 2 dimensional arrays.
+				// Now load them, one row at a time so that the times can be compacted
+				uint32 *row_times = new uint32[finished_halt_count];
 				for (uint16 i = 0; i < finished_halt_count; i++)
 				{
-					for (uint32 j = 0; j < finished_halt_count; j++)
+					for (uint16 j = 0; j < finished_halt_count; j++)
 					{
-						file->rdwr_long(finished_matrix[i][j].aggregate_time);
+						file->rdwr_long(row_times[j]);
 						file->rdwr_short(tmp_idx);
-						finished_matrix[i][j].next_transfer.set_id(tmp_idx);
+						finished_next_transfer[matrix_index(i, j, finished_halt_count)].set_id(tmp_idx);
 					}
+					store_finished_times_row(i, row_times);
 				}
+				delete[] row_times;
+				update_finished_matrix_memory();
 			}
 		}
 	}
@@ -2156,25 +2939,23 @@ void path_explorer_t::compartment_t::rdwr(loadsave_t* file)
 	file->rdwr_short(working_halt_count);
 
 	// Working matrix
-	bool working_matrix_live = working_matrix != NULL;
+	bool working_matrix_live = working_times != NULL;
 	file->rdwr_bool(working_matrix_live);
 
 	if (working_matrix_live)
 	{
+		const size_t element_count = (size_t)working_halt_count * working_halt_count;
 		if (file->is_saving())
 		{
 			uint16 tmp_idx;
-			for (uint16 i = 0; i < working_halt_count; i++)
+			for (size_t i = 0; i < element_count; i++)
 			{
-				for (uint32 j = 0; j < working_halt_count; j++)
-				{
-					file->rdwr_long(working_matrix[i][j].aggregate_time);
-					tmp_idx = working_matrix[i][j].next_transfer.get_id();
-					file->rdwr_short(tmp_idx);
+				file->rdwr_long(working_times[i]);
+				tmp_idx = working_next_transfer[i].get_id();
+				file->rdwr_short(tmp_idx);
 
-					file->rdwr_short(transport_matrix[i][j].first_transport);
-					file->rdwr_short(transport_matrix[i][j].last_transport);
-				}
+				file->rdwr_short(working_first_transport[i]);
+				file->rdwr_short(working_last_transport[i]);
 			}
 		}
 
@@ -2183,34 +2964,19 @@ void path_explorer_t::compartment_t::rdwr(loadsave_t* file)
 			// Create the matrices
 			if (working_halt_count > 0)
 			{
-				// build working matrix
+				// build working and transport matrices
 				uint16 tmp_idx;
-				working_matrix = new path_element_t*[working_halt_count];
-				for (uint16 i = 0; i < working_halt_count; ++i)
-				{
-					working_matrix[i] = new path_element_t[working_halt_count];
-
-				}
-
-				// build transport matrix
-				transport_matrix = new transport_element_t*[working_halt_count];
-				for (uint16 i = 0; i < working_halt_count; ++i)
-				{
-					transport_matrix[i] = new transport_element_t[working_halt_count];
-				}
+				allocate_working_matrix();
 
 				// Now load them. These are 2 dimensional arrays.
-				for (uint16 i = 0; i < working_halt_count; i++)
+				for (size_t i = 0; i < element_count; i++)
 				{
-					for (uint32 j = 0; j < working_halt_count; j++)
-					{
-						file->rdwr_long(working_matrix[i][j].aggregate_time);
-						file->rdwr_short(tmp_idx);
-						working_matrix[i][j].next_transfer.set_id(tmp_idx);
+					file->rdwr_long(working_times[i]);
+					file->rdwr_short(tmp_idx);
+					working_next_transfer[i].set_id(tmp_idx);
 
-						file->rdwr_short(transport_matrix[i][j].first_transport);
-						file->rdwr_short(transport_matrix[i][j].last_transport);
-					}
+					file->rdwr_short(working_first_transport[i]);
+					file->rdwr_short(working_last_transport[i]);
 				}
 			}
 		}
@@ -2372,38 +3138,207 @@ void path_explorer_t::compartment_t::rdwr(loadsave_t* file)
 	file->rdwr_long(total_iterations);
 
 	file->rdwr_short(via_index);
+
+	// Formerly, the position within a transfer was held as an origin cluster, a target cluster and a cluster member,
+	// with the inbound/outbound connection clusters saved alongside. The connected halt list is now rebuilt from
+	// the working matrix, and only the origin position is saved; the cluster fields are written as zero.
+	uint32 origin_cluster_index = 0;
+	uint32 target_cluster_index = 0;
 	file->rdwr_long(origin_cluster_index);
 	file->rdwr_long(target_cluster_index);
 	file->rdwr_long(origin_member_index);
 
-	bool inbound_connections_live = inbound_connections != NULL;
+	bool connections_live = false;
+	bool inbound_connections_live = false;
 	file->rdwr_bool(inbound_connections_live);
-
 	if(inbound_connections_live)
 	{
-		if(file->is_loading())
-		{
-			inbound_connections = new connection_t(64u, working_halt_count);
-		}
-		inbound_connections->rdwr(file);
+		connection_t discarded_connections(64u, working_halt_count);
+		discarded_connections.rdwr(file);
+		connections_live = true;
 	}
 
-	bool outbound_connections_live = outbound_connections != NULL;
+	bool outbound_connections_live = false;
 	file->rdwr_bool(outbound_connections_live);
-
 	if(outbound_connections_live)
 	{
-		if(file->is_loading())
-		{
-			outbound_connections = new connection_t(64u, working_halt_count);
-		}
-		outbound_connections->rdwr(file);
+		connection_t discarded_connections(64u, working_halt_count);
+		discarded_connections.rdwr(file);
+		connections_live = true;
 	}
 
 	file->rdwr_bool(process_next_transfer);
 
+	if(file->is_loading() && connections_live)
+	{
+		// Saved part way through a transfer in the old cluster layout: repeat this transfer from the start.
+		// This gives the same result, since relaxing through the same transfer twice cannot improve any path further.
+		origin_member_index = 0;
+		process_next_transfer = true;
+	}
+
 	file->rdwr_long(statistic_duration);
 	file->rdwr_long(statistic_iteration);
+
+	if (file->is_version_ex_atleast(14, 45))
+	{
+		// needed so that an incremental update is applied, or not, in the same way after loading
+		rdwr_direct_connexions(file, finished_connexions);
+		rdwr_direct_connexions(file, working_connexions);
+		rdwr_hub_labels(file);
+	}
+}
+
+
+void path_explorer_t::compartment_t::rdwr_hub_label(loadsave_t* file, hub_label_t &label)
+{
+	uint16 halt_id = label.first_hop.get_id();
+	file->rdwr_short(label.hub);
+	file->rdwr_short(halt_id);
+	file->rdwr_long(label.aggregate_time);
+	file->rdwr_long(label.hub_transport);
+	if (file->is_loading())
+	{
+		label.first_hop.set_id(halt_id);
+	}
+}
+
+
+void path_explorer_t::compartment_t::rdwr_hub_labels(loadsave_t* file)
+{
+	file->rdwr_bool(working_hub_labels);
+
+	// finished labels
+	bool finished_labels_live = finished_labels_out != NULL;
+	file->rdwr_bool(finished_labels_live);
+
+	if (finished_labels_live)
+	{
+		if (file->is_loading())
+		{
+			finished_label_offsets_out = new uint32[finished_halt_count + 1];
+			finished_label_offsets_in = new uint32[finished_halt_count + 1];
+		}
+		for (uint32 i = 0; i <= finished_halt_count; i++)
+		{
+			file->rdwr_long(finished_label_offsets_out[i]);
+			file->rdwr_long(finished_label_offsets_in[i]);
+		}
+
+		const uint32 label_count_out = finished_label_offsets_out[finished_halt_count];
+		const uint32 label_count_in = finished_label_offsets_in[finished_halt_count];
+		if (file->is_loading())
+		{
+			finished_labels_out = new hub_label_t[label_count_out];
+			finished_labels_in = new hub_label_t[label_count_in];
+		}
+		for (uint32 i = 0; i < label_count_out; i++)
+		{
+			rdwr_hub_label(file, finished_labels_out[i]);
+		}
+		for (uint32 i = 0; i < label_count_in; i++)
+		{
+			rdwr_hub_label(file, finished_labels_in[i]);
+		}
+
+		if (file->is_loading())
+		{
+			finished_matrix_memory = ( (size_t)label_count_out + label_count_in ) * sizeof(hub_label_t) + ( (size_t)finished_halt_count + 1 ) * 2 * sizeof(uint32);
+			const size_t full_memory = (size_t)finished_halt_count * finished_halt_count * ( sizeof(uint32) + sizeof(halthandle_t) );
+			finished_matrix_memory_saved = full_memory > finished_matrix_memory ? full_memory - finished_matrix_memory : 0;
+		}
+	}
+
+	// labels of the hubs processed so far in the current refresh; the rest of the search data is rebuilt
+	bool working_labels_live = working_labels_out != NULL;
+	file->rdwr_bool(working_labels_live);
+
+	if (working_labels_live)
+	{
+		if (file->is_loading())
+		{
+			working_labels_out = new vector_tpl<hub_label_t>[working_halt_count];
+			working_labels_in = new vector_tpl<hub_label_t>[working_halt_count];
+		}
+		for (uint16 i = 0; i < working_halt_count; i++)
+		{
+			vector_tpl<hub_label_t> *const labels[2] = { working_labels_out + i, working_labels_in + i };
+			for (uint8 direction = 0; direction < 2; direction++)
+			{
+				uint32 label_count = labels[direction]->get_count();
+				file->rdwr_long(label_count);
+				if (file->is_loading())
+				{
+					labels[direction]->resize(label_count);
+				}
+				for (uint32 j = 0; j < label_count; j++)
+				{
+					hub_label_t label;
+					if (file->is_saving())
+					{
+						label = (*labels[direction])[j];
+					}
+					rdwr_hub_label(file, label);
+					if (file->is_loading())
+					{
+						labels[direction]->append(label);
+					}
+				}
+			}
+		}
+	}
+}
+
+
+void path_explorer_t::compartment_t::rdwr_direct_connexions(loadsave_t* file, vector_tpl<direct_connexion_t> *&connexions)
+{
+	bool connexions_live = connexions != NULL;
+	file->rdwr_bool(connexions_live);
+
+	if (connexions_live)
+	{
+		uint32 connexion_count;
+		if (file->is_saving())
+		{
+			connexion_count = connexions->get_count();
+		}
+
+		file->rdwr_long(connexion_count);
+
+		if (file->is_loading())
+		{
+			delete connexions;
+			connexions = new vector_tpl<direct_connexion_t>(connexion_count);
+		}
+
+		for (uint32 i = 0; i < connexion_count; i++)
+		{
+			direct_connexion_t tmp;
+			uint16 halt_id;
+			if (file->is_saving())
+			{
+				tmp = (*connexions)[i];
+				halt_id = tmp.target_halt.get_id();
+			}
+
+			file->rdwr_short(tmp.origin);
+			file->rdwr_short(tmp.target);
+			file->rdwr_long(tmp.aggregate_time);
+			file->rdwr_short(halt_id);
+			file->rdwr_long(tmp.transport);
+
+			if (file->is_loading())
+			{
+				tmp.target_halt.set_id(halt_id);
+				connexions->append(tmp);
+			}
+		}
+	}
+	else if (file->is_loading())
+	{
+		delete connexions;
+		connexions = NULL;
+	}
 }
 
 void path_explorer_t::compartment_t::connection_t::rdwr(loadsave_t* file)
@@ -2451,9 +3386,10 @@ void path_explorer_t::compartment_t::connection_t::rdwr(loadsave_t* file)
 		uint16 key;
 		for(uint32 i = 0; i < cluster_map_count; i ++)
 		{
+			// The map entries duplicate the clusters loaded above; as this is only
+			// read for skipping an old exploration state, they are not kept.
 			file->rdwr_short(key);
-			connection_cluster_t* value = new connection_cluster_t(file);
-			cluster_map.put(key, value);
+			connection_cluster_t discarded_cluster(file);
 		}
 	}
 }
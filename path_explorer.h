@@ -106,25 +106,8 @@ private:
 
 	private:
 
-		// element used during path search and for storing calculated paths
-		struct path_element_t
-		{
-			uint32 aggregate_time;
-			halthandle_t next_transfer;
-
-			path_element_t() : aggregate_time(UINT32_MAX_VALUE) { }
-		};
-
-		// element used during path search only for storing best lines/convoys
-		struct transport_element_t
-		{
-			uint16 first_transport;
-			uint16 last_transport;
-
-			transport_element_t() : first_transport(0), last_transport(0) { }
-		};
-
 		// structure used for storing indices of halts connected to a transfer, grouped by transport
+		// Note that this is only retained for reading the exploration state of older saved games.
 		class connection_t
 		{
 
@@ -233,6 +216,41 @@ private:
 			void rdwr(loadsave_t* file);
 		};
 
+		// element used for remembering the direct connexions from which a path matrix was built
+		struct direct_connexion_t
+		{
+			uint16 origin;				// matrix index
+			uint16 target;				// matrix index
+			uint32 aggregate_time;
+			halthandle_t target_halt;
+			uint32 transport;			// 0 for walking, else the line id, or 65536 + the id of a lineless convoy
+		};
+
+		// entry of a hub label : the shortest time between a halt and a hub (as a hub rank), the
+		// first halt after the start of that path, which is the next transfer when routing along it,
+		// and the transport of the leg of that path at the hub, with the same encoding as in direct_connexion_t
+		struct hub_label_t
+		{
+			uint16 hub;
+			halthandle_t first_hop;
+			uint32 aggregate_time;
+			uint32 hub_transport;
+		};
+
+		// element of the priority queue used for building hub labels
+		struct hub_search_node_t
+		{
+			uint32 aggregate_time;
+			uint16 halt;			// matrix index
+
+			// orders the queue with the shortest time at its front, and ties broken by halt index
+			// so that the labels do not depend upon the implementation of the heap algorithms
+			bool operator<(const hub_search_node_t &other) const
+			{
+				return aggregate_time > other.aggregate_time || ( aggregate_time == other.aggregate_time && halt > other.halt );
+			}
+		};
+
 		// data structure for temporarily storing lines and lineless conovys
 		struct linkage_t
 		{
@@ -244,18 +262,68 @@ private:
 		sint64 refresh_start_time;
 
 		// set of variables for finished path data
-		path_element_t **finished_matrix;
+		// The matrices are each a single contiguous row-major block of finished_halt_count^2 elements.
+		// To save memory, times are held in 16 bits, where finished_time_unreachable means that there is no path.
+		// Only rows containing a time which does not fit are given a second array holding the high 16 bits.
+		uint16 *finished_times;
+		uint16 **finished_times_high;
+		halthandle_t *finished_next_transfer;
 		uint16 *finished_halt_index_map;
 		uint16 finished_halt_count;
 
+		// memory used by the finished matrices, and the amount saved compared with 32 bit times
+		size_t finished_matrix_memory;
+		size_t finished_matrix_memory_saved;
+
+		static const uint16 finished_time_unreachable = 0xFFFF;
+
 		// set of variables for working path data
-		path_element_t **working_matrix;
+		// These are kept as separate arrays (structure of arrays) rather than an array of structures
+		// so that the relaxation kernel in the path exploration phase streams over plain integer rows.
+		uint32 *working_times;
+		halthandle_t *working_next_transfer;
+		uint16 *working_first_transport;
+		uint16 *working_last_transport;
 		uint16 *transport_index_map;
-		transport_element_t **transport_matrix;
 		uint16 *working_halt_index_map;
 		halthandle_t *working_halt_list;
 		uint16 working_halt_count;
 
+		// Hub labels, the alternative to the matrices selected by settings_t::path_explorer_backend.
+		// Every halt has an outbound label (paths from the halt to hubs) and an inbound label (paths from
+		// hubs to the halt). The shortest path between two halts passes through the hub which they share
+		// with the smallest total time. The labels of halt i are [offsets[i], offsets[i+1]) and are sorted
+		// by hub rank. As in the matrices, two legs served by the same line or convoy are not combined,
+		// neither within a label nor at the hub shared by two labels.
+		hub_label_t *finished_labels_out;
+		hub_label_t *finished_labels_in;
+		uint32 *finished_label_offsets_out;
+		uint32 *finished_label_offsets_in;
+
+		// working data for building the hub labels, with the direct connexions as the graph :
+		// working_connexions sorted by origin, indexed by hub_forward_offsets, and indices of the same
+		// connexions sorted by target, indexed by hub_reverse_offsets
+		bool working_hub_labels;
+		vector_tpl<hub_label_t> *working_labels_out;
+		vector_tpl<hub_label_t> *working_labels_in;
+		uint16 *hub_order;				// matrix indices of halts in descending order of importance
+		uint32 *hub_forward_offsets;
+		uint32 *hub_reverse_offsets;
+		uint32 *hub_reverse_connexions;
+		uint32 *hub_search_times;		// per halt, UINT32_MAX_VALUE when not reached
+		halthandle_t *hub_search_first_hop;
+		uint32 *hub_search_edge_transport;	// per halt, transport of the leg of the path at that halt
+		uint32 *hub_search_hub_transport;	// per halt, transport of the leg of the path at the hub
+		uint32 *hub_pruning_times;		// per hub rank, UINT32_MAX_VALUE when not a hub of the searched halt
+		uint32 *hub_pruning_transports;	// per hub rank, transport at the hub of the path giving the pruning time
+		vector_tpl<uint16> hub_search_reached;
+		vector_tpl<hub_search_node_t> hub_search_queue;
+
+		// direct connexions of the finished and working matrices, used to detect changes which
+		// can be applied to the finished matrix incrementally
+		vector_tpl<direct_connexion_t> *finished_connexions;
+		vector_tpl<direct_connexion_t> *working_connexions;
+
 		// set of variables for full halt list
 		halthandle_t *all_halts_list;
 		uint16 all_halts_count;
@@ -288,13 +356,11 @@ private:
 
 		// phase counters for path searching
 		uint16 via_index;
-		uint32 origin_cluster_index;
-		uint32 target_cluster_index;
 		uint32 origin_member_index;
 
 		// variables for limiting search around transfers
-		connection_t *inbound_connections;		// relative to the current transfer
-		connection_t *outbound_connections;		// relative to the current transfer
+		uint16 *via_connected_halts;	// halts connected with the current transfer, both as origins and as targets
+		uint16 via_connected_count;
 		bool process_next_transfer;
 
 		// statistics for determining limits
@@ -366,8 +432,89 @@ private:
 		static const uint32 percent_lower_limit = 100 - percent_deviation;
 		static const uint32 percent_upper_limit = 100 + percent_deviation;
 
-		void enumerate_all_paths(const path_element_t *const *const matrix, const halthandle_t *const halt_list,
-								 const uint16 *const halt_map, const uint16 halt_count);
+		void enumerate_all_paths(const halthandle_t *const halt_list);
+
+		// index of an element in a contiguous row-major square matrix
+		static inline size_t matrix_index(const uint16 row, const uint16 column, const uint16 count)
+		{
+			return (size_t)row * count + column;
+		}
+
+		// if the only changes since the last refresh are new or faster connexions served by walking or by
+		// transport which served no connexion before, and the halts are unchanged, replace the working
+		// matrix with the finished matrix updated for these connexions
+		bool try_incremental_update();
+
+		static void rdwr_direct_connexions(loadsave_t* file, vector_tpl<direct_connexion_t> *&connexions);
+		static void rdwr_hub_label(loadsave_t* file, hub_label_t &label);
+		void rdwr_hub_labels(loadsave_t* file);
+
+		void allocate_working_matrix();
+		void free_working_matrix();
+
+		// allocate the finished times for finished_halt_count halts, and store one row of them
+		void allocate_finished_times();
+		void store_finished_times_row(const uint16 row, const uint32 *const times);
+		void update_finished_matrix_memory();
+		void free_finished_matrix();
+
+		inline uint32 get_finished_time(const uint16 row, const uint16 column) const
+		{
+			const uint16 low = finished_times[matrix_index(row, column, finished_halt_count)];
+			const uint16 *const high = finished_times_high[row];
+			if ( high )
+			{
+				return ((uint32)high[column] << 16) | low;
+			}
+			return low == finished_time_unreachable ? UINT32_MAX_VALUE : low;
+		}
+
+		// build the search graph and the hub order from working_connexions
+		void prepare_hub_labels();
+		// add the hub of the given rank to the labels of the halts for which it is on a shortest path;
+		// returns the number of iterations
+		uint32 add_hub_to_labels(const uint16 rank, const bool outbound);
+		// publish the working labels as the finished labels
+		void store_finished_labels();
+		void free_hub_label_search();
+		void free_finished_labels();
+
+		// fill via_connected_halts for the given transfer
+		void collect_connected_halts(const uint16 via);
+
+		// relax all paths from one origin halt through the current transfer
+		void relax_paths_via(const uint16 via, const uint16 origin, const bool dense);
+
+		// relax the paths of the connected halts [begin, end) through the current transfer,
+		// sharing the rows among the explorer worker threads where worthwhile
+		void relax_connected_halts(const uint16 via, const uint32 begin, const uint32 end, const bool dense);
+
+#ifdef MULTI_THREAD
+		// Worker threads which relax slices of the origin rows of one transfer in parallel with the
+		// path explorer's own thread. Rows are independent within one transfer and each thread is given
+		// a fixed contiguous slice, so the result does not depend on the number of threads.
+		static vector_tpl<pthread_t> explore_paths_threads;
+		static simthread_barrier_t explore_paths_barrier;
+		static bool terminating_explore_paths_threads;
+
+		// the batch of rows currently shared with the worker threads
+		static compartment_t *explore_paths_compartment;
+		static uint16 explore_paths_via;
+		static uint32 explore_paths_begin;
+		static uint32 explore_paths_end;
+		static bool explore_paths_dense;
+
+		// minimum number of matrix elements in a batch before it is shared with the worker threads
+		static const uint32 explore_paths_parallel_threshold = 0x8000;
+
+		static void init_explore_paths_threads();
+		static void destroy_explore_paths_threads();
+
+		// relax this thread's share of the current batch; thread 0 is the path explorer's own thread
+		static void relax_explore_paths_slice(const uint32 thread_number);
+
+		friend void *explore_paths_threaded(void *args);
+#endif
 
 	public:
 
@@ -396,6 +543,9 @@ private:
 		uint16 get_transfer_count() const { return transfer_count; }
 		uint32 get_total_iterations() { const uint32 ti = total_iterations; total_iterations = 0; return ti; }
 
+		size_t get_finished_matrix_memory() const { return finished_matrix_memory; }
+		size_t get_finished_matrix_memory_saved() const { return finished_matrix_memory_saved; }
+
 		void set_category(uint8 category);
 		void set_class(uint8 value);
 		void set_refresh() { refresh_requested = true; }
@@ -474,6 +624,7 @@ public:
 #ifdef MULTI_THREAD
 	static thread_local bool allow_path_explorer_on_this_thread;
 	friend void *path_explorer_threaded(void* args);
+	friend void *explore_paths_threaded(void *args);
 #endif
 	static void initialise(karte_t *welt);
 	static void finalise();
@@ -520,6 +671,10 @@ public:
 	static uint16 get_transfer_count(uint8 catg, uint8 g_class) { return goods_compartment[catg][g_class].get_transfer_count(); }
 	static uint32 get_total_iterations(uint8 catg, uint8 g_class) { return goods_compartment[catg][g_class].get_total_iterations(); }
 
+	// memory used by the finished path matrices of all compartments, and the amount saved by their compact storage
+	static size_t get_finished_matrix_memory();
+	static size_t get_finished_matrix_memory_saved();
+
 	inline static void set_absolute_limits_external() { compartment_t::set_absolute_limits();  }
 
 	inline static bool get_must_refresh_on_loading() { return must_refresh_on_loading; }
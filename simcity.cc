@@ -69,8 +69,6 @@
 
 #include "tpl/minivec_tpl.h"
 
-uint32 weg_t::private_car_routes_currently_reading_element;
-
 // since we use 32 bit per growth steps, we use this variable to take care of the remaining sub citizen growth
 #define CITYGROWTH_PER_CITIZEN (0x0000000100000000ll)
 
@@ -2399,6 +2397,14 @@ void stadt_t::rdwr(loadsave_t* file)
 		}
 	}
 
+	if (file->is_version_ex_atleast(14, 45))
+	{
+		// The area explored by the last check of this city's private car routes,
+		// which decides whether changed roads make it due to be checked again.
+		private_car_route_area_min.rdwr(file);
+		private_car_route_area_max.rdwr(file);
+	}
+
 	if(file->get_extended_version() >= 12 && file->get_extended_version() < 13)
 	{
 		// Was waschtum
@@ -2700,6 +2706,24 @@ void stadt_t::roll_history()
 	outgoing_private_cars = 0;
 }
 
+bool stadt_t::are_private_car_routes_affected(const vector_tpl<koord3d> &tiles) const
+{
+	if (private_car_route_area_min == koord::invalid)
+	{
+		return true;
+	}
+	FOR(vector_tpl<koord3d>, const& pos, tiles)
+	{
+		// A new road next to the explored area may connect further destinations.
+		if (pos.x >= private_car_route_area_min.x - 1 && pos.x <= private_car_route_area_max.x + 1 &&
+			pos.y >= private_car_route_area_min.y - 1 && pos.y <= private_car_route_area_max.y + 1)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
 void stadt_t::check_all_private_car_routes()
 {
 	const planquadrat_t* plan = welt->access(townhall_road);
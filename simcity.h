@@ -447,6 +447,11 @@ private:
 
 	bool private_car_route_finding_in_progress = false;
 
+	// The area explored by the last check of the private car routes from this city,
+	// or koord::invalid if it has not been checked since the game was loaded.
+	koord private_car_route_area_min = koord::invalid;
+	koord private_car_route_area_max = koord::invalid;
+
 	sint32 traffic_level;
 	void calc_traffic_level();
 
@@ -687,6 +692,11 @@ public:
 	bool get_private_car_route_finding_in_progress() const { return private_car_route_finding_in_progress; }
 	void set_private_car_route_finding_in_progress(bool value) { private_car_route_finding_in_progress = value; }
 
+	void set_private_car_route_area(koord min, koord max) { private_car_route_area_min = min; private_car_route_area_max = max; }
+
+	/// @returns whether a road changed at one of @p tiles may change the private car routes from this city
+	bool are_private_car_routes_affected(const vector_tpl<koord3d> &tiles) const;
+
 	// @author: jamespetts
 	// September 2010
 	uint16 get_max_dimension();
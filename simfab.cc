@@ -835,6 +835,7 @@ fabrik_t::fabrik_t(loadsave_t* file)
 	rdwr(file);
 
 	delta_sum = 0;
+	distribution_due = false;
 	delta_menge = 0;
 	menge_remainder = 0;
 	total_input = total_transit = total_output = 0;
@@ -890,6 +891,7 @@ fabrik_t::fabrik_t(koord3d pos_, player_t* owner, const factory_desc_t* desc, si
 	}
 
 	delta_sum = 0;
+	distribution_due = false;
 	delta_menge = 0;
 	menge_remainder = 0;
 	activity_count = 0;
@@ -2132,13 +2134,13 @@ bool fabrik_t::is_consumer_active_at(koord consumer_pos ) const
 
 void fabrik_t::step(uint32 delta_t)
 {
-	if(!has_calculated_intransit_percentages)
-	{
-		// Can only do it here (once after loading) as paths
-		// are not available when loading, even in finish_rd
-		calc_max_intransit_percentages();
-	}
+	step_production(delta_t);
+	step_distribution(delta_t);
+}
 
+
+void fabrik_t::step_production(uint32 delta_t)
+{
 	if(  delta_t==0  ) {
 		return;
 	}
@@ -2345,6 +2347,26 @@ void fabrik_t::step(uint32 delta_t)
 	delta_sum += delta_t;
 	if(  delta_sum > PRODUCTION_DELTA_T  ) {
 		delta_sum = delta_sum % PRODUCTION_DELTA_T;
+		distribution_due = true;
+	}
+}
+
+
+void fabrik_t::step_distribution(uint32 delta_t)
+{
+	if(!has_calculated_intransit_percentages)
+	{
+		// Can only do it here (once after loading) as paths
+		// are not available when loading, even in finish_rd
+		calc_max_intransit_percentages();
+	}
+
+	if(  delta_t==0  ) {
+		return;
+	}
+
+	if(  distribution_due  ) {
+		distribution_due = false;
 
 		// distribute, if there is more than 1 waiting ...
 		// Changed from the original 10 by jamespetts, July 2017
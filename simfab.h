@@ -268,6 +268,9 @@ private:
 
 	/// Accumulated time since last production
 	sint32 delta_sum;
+
+	/// Set by step_production() when the goods are to be distributed in step_distribution()
+	bool distribution_due;
 	uint32 delta_menge;
 
 	// production remainder when scaled to PRODUCTION_DELTA_T. added back next step to eliminate cumulative error
@@ -577,6 +580,15 @@ public:
 
 	void step(uint32 delta_t);                  // factory muss auch arbeiten ("factory must also work")
 
+	/**
+	 * The two halves of step(). step_production() only changes this factory's own
+	 * stock, production and power figures, so it may be called for different factories
+	 * at the same time. step_distribution() then sends the goods to halts and other
+	 * factories, and must be called for all factories in turn after their production.
+	 */
+	void step_production(uint32 delta_t);
+	void step_distribution(uint32 delta_t);
+
 	void new_month();
 
 	char const* get_name() const;
@@ -4,6 +4,7 @@
  */
 
 #include <algorithm>
+#include <atomic>
 
 #include "freight_list_sorter.h"
 
@@ -53,6 +54,7 @@
 
 #include "utils/simrandom.h"
 #include "utils/simstring.h"
+#include "utils/simthread.h"
 
 #include "vehicle/simpeople.h"
 
@@ -78,13 +80,102 @@ uint8 haltestelle_t::reconnect_counter = 0;
 // controls the halt iterator in step_all():
 static bool restart_halt_iterator = true;
 
+// Every halt is stepped at least once in this many steps. This must not depend
+// on timing or on the number of threads, or network games would desynchronise.
+static const uint32 halt_sweep_steps = 16;
+
+// the halts to be stepped in this step, and those of them which have goods to re-route
+static vector_tpl<halthandle_t> halts_to_step;
+static vector_tpl<halthandle_t> halts_to_reroute;
+
+#ifdef MULTI_THREAD
+// Threads which find the routes for halts_to_reroute together with the main thread.
+// Each halt is claimed by one thread, and only that halt's prepared routes are written.
+static vector_tpl<pthread_t> reroute_goods_threads;
+static simthread_barrier_t reroute_goods_barrier;
+static bool terminating_reroute_goods_threads = false;
+static std::atomic<uint32> next_halt_to_reroute;
+
+static void prepare_reroute_goods_of_halts()
+{
+	const uint32 halt_count = halts_to_reroute.get_count();
+	for (uint32 i = next_halt_to_reroute++; i < halt_count; i = next_halt_to_reroute++)
+	{
+		halts_to_reroute[i]->prepare_reroute_goods();
+	}
+}
+
+void *prepare_reroute_goods_threaded(void *)
+{
+	while (true)
+	{
+		simthread_barrier_wait(&reroute_goods_barrier);
+		if (terminating_reroute_goods_threads)
+		{
+			break;
+		}
+		prepare_reroute_goods_of_halts();
+		simthread_barrier_wait(&reroute_goods_barrier);
+	}
+
+	return NULL;
+}
+
+static void init_reroute_goods_threads()
+{
+	if (!reroute_goods_threads.empty() || env_t::num_threads <= 1)
+	{
+		return;
+	}
+
+	const uint32 worker_count = env_t::num_threads - 1;
+	terminating_reroute_goods_threads = false;
+	simthread_barrier_init(&reroute_goods_barrier, NULL, worker_count + 1);
+
+	pthread_attr_t attributes;
+	pthread_attr_init(&attributes);
+	pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_JOINABLE);
+	for (uint32 i = 0; i < worker_count; i++)
+	{
+		pthread_t thread;
+		const int rc = pthread_create(&thread, &attributes, &prepare_reroute_goods_threaded, NULL);
+		if (rc)
+		{
+			dbg->fatal("init_reroute_goods_threads()", "Failed to create halt re-routing thread, error %d", rc);
+		}
+		reroute_goods_threads.append(thread);
+	}
+	pthread_attr_destroy(&attributes);
+}
+
+static void destroy_reroute_goods_threads()
+{
+	if (reroute_goods_threads.empty())
+	{
+		return;
+	}
+
+	terminating_reroute_goods_threads = true;
+	simthread_barrier_wait(&reroute_goods_barrier);
+	FOR(vector_tpl<pthread_t>, thread, reroute_goods_threads)
+	{
+		pthread_join(thread, NULL);
+	}
+	reroute_goods_threads.clear();
+	simthread_barrier_destroy(&reroute_goods_barrier);
+	terminating_reroute_goods_threads = false;
+}
+#endif
+
 void haltestelle_t::step_all()
 {
 	const uint32 count = alle_haltestellen.get_count();
 	if (count)
 	{
-		const uint32 loops = min(count, 256u);
+		const uint32 loops = min(count, max(256u, (count + halt_sweep_steps - 1) / halt_sweep_steps));
 		static vector_tpl<halthandle_t>::iterator iter;
+		halts_to_step.clear();
+		halts_to_reroute.clear();
 		for (uint32 i = 0; i < loops; ++i)
 		{
 			if (restart_halt_iterator || iter == alle_haltestellen.end())
@@ -92,7 +183,34 @@ void haltestelle_t::step_all()
 				restart_halt_iterator = false;
 				iter = alle_haltestellen.begin();
 			}
-			(*iter++)->step();
+			const halthandle_t halt = *iter++;
+			halts_to_step.append(halt);
+			if (!halt->categories_to_refresh_next_step.empty())
+			{
+				halts_to_reroute.append(halt);
+			}
+		}
+
+#ifdef MULTI_THREAD
+		// Finding the routes is by far the most expensive part of stepping a halt,
+		// and it only reads the path explorer, so this is shared among the threads.
+		// Everything else is done below in the same order as before.
+		init_reroute_goods_threads();
+		if (!reroute_goods_threads.empty() && halts_to_reroute.get_count() > 1)
+		{
+			next_halt_to_reroute = 0;
+			simthread_barrier_wait(&reroute_goods_barrier); // start the workers
+			prepare_reroute_goods_of_halts();
+			simthread_barrier_wait(&reroute_goods_barrier); // wait for all halts to be prepared
+		}
+#endif
+
+		FOR(vector_tpl<halthandle_t>, halt, halts_to_step)
+		{
+			if (halt.is_bound())
+			{
+				halt->step();
+			}
 		}
 	}
 }
@@ -374,6 +492,11 @@ void haltestelle_t::destroy_all()
 		halthandle_t halt = alle_haltestellen.back();
 		destroy(halt);
 	}
+	halts_to_step.clear();
+	halts_to_reroute.clear();
+#ifdef MULTI_THREAD
+	destroy_reroute_goods_threads();
+#endif
 	delete all_koords;
 	all_koords = NULL;
 	//status_step = 0;
@@ -1269,11 +1392,21 @@ void haltestelle_t::step()
 
 	PIXVAL old_status_color = status_color;
 
-	FOR(vector_tpl<uint8>, catg, categories_to_refresh_next_step)
+	for (uint32 i = 0; i < categories_to_refresh_next_step.get_count(); i++)
 	{
-		reroute_goods(catg);
+		if (i + 1 < prepared_route_offsets.get_count())
+		{
+			const uint32 offset = prepared_route_offsets[i];
+			reroute_goods(categories_to_refresh_next_step[i], prepared_routes.begin() + offset, prepared_route_offsets[i + 1] - offset);
+		}
+		else
+		{
+			reroute_goods(categories_to_refresh_next_step[i]);
+		}
 	}
 	categories_to_refresh_next_step.clear();
+	prepared_routes.clear();
+	prepared_route_offsets.clear();
 
 	check_transferring_cargoes();
 
@@ -1508,7 +1641,47 @@ void haltestelle_t::new_month()
  * will distribute the goods to changed routes (if there are any)
  * returns true upon completion
  */
-uint32 haltestelle_t::reroute_goods(const uint8 catg)
+void haltestelle_t::prepare_reroute_goods()
+{
+	prepared_routes.clear();
+	prepared_route_offsets.clear();
+	for (uint32 i = 0; i < categories_to_refresh_next_step.get_count(); i++)
+	{
+		prepared_route_offsets.append(prepared_routes.get_count());
+		const uint8 catg = categories_to_refresh_next_step[i];
+		bool repeated = false;
+		for (uint32 j = 0; j < i; j++)
+		{
+			repeated |= categories_to_refresh_next_step[j] == catg;
+		}
+		if (repeated || !cargo[catg])
+		{
+			// The goods will have been re-routed already.
+			continue;
+		}
+
+		FOR(vector_tpl<ware_t>, const& ware, *cargo[catg])
+		{
+			prepared_route_t prepared;
+			prepared.ware = ware;
+			prepared.journey_time = UINT32_MAX_VALUE;
+			fabrik_t* fab = ware.menge ? fabrik_t::get_fab(ware.get_zielpos()) : NULL;
+			if (ware.menge == 0 || ware.get_zielpos() == koord::invalid || (fab && fab_list.is_contained(fab)))
+			{
+				// Not re-routed by the same rules as reroute_goods()
+				prepared.ware.set_zielpos(koord::invalid);
+			}
+			else
+			{
+				prepared.journey_time = find_route(prepared.ware);
+			}
+			prepared_routes.append(prepared);
+		}
+	}
+	prepared_route_offsets.append(prepared_routes.get_count());
+}
+
+uint32 haltestelle_t::reroute_goods(const uint8 catg, const prepared_route_t *prepared, const uint32 prepared_count)
 {
 	if(cargo[catg])
 	{
@@ -1542,9 +1715,29 @@ uint32 haltestelle_t::reroute_goods(const uint8 catg)
 				}
 			}
 
-			// check if this good can still reach its destination
+			// check if this good can still reach its destination.
+			// The route depends only on the destination and the goods type, so a prepared
+			// route still applies if these are the same, even if other goods have arrived since.
+			uint32 journey_time;
+			if ((uint32)j < prepared_count
+				&& prepared[j].ware.get_zielpos() != koord::invalid
+				&& prepared[j].ware.get_zielpos() == ware.get_zielpos()
+				&& prepared[j].ware.get_desc() == ware.get_desc()
+				&& prepared[j].ware.get_class() == ware.get_class())
+			{
+				journey_time = prepared[j].journey_time;
+				if (journey_time != UINT32_MAX_VALUE)
+				{
+					ware.set_ziel(prepared[j].ware.get_ziel());
+					ware.set_zwischenziel(prepared[j].ware.get_zwischenziel());
+				}
+			}
+			else
+			{
+				journey_time = find_route(ware);
+			}
 
-			if(find_route(ware) == UINT32_MAX_VALUE)
+			if(journey_time == UINT32_MAX_VALUE)
 			{
 				// remove invalid destinations
 				continue;
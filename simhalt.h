@@ -195,6 +195,21 @@ private:
 	 */
 	vector_tpl<uint8> categories_to_refresh_next_step;
 
+	/**
+	 * The routes of the waiting goods of categories_to_refresh_next_step,
+	 * found by prepare_reroute_goods() on the halt stepping threads, in the
+	 * order of the goods in cargo when these were prepared.
+	 * prepared_route_offsets holds the first route of each category to
+	 * refresh, followed by the total count.
+	 */
+	struct prepared_route_t
+	{
+		ware_t ware; // as re-routed; zielpos invalid if not routed
+		uint32 journey_time;
+	};
+	vector_tpl<prepared_route_t> prepared_routes;
+	vector_tpl<uint32> prepared_route_offsets;
+
 	/**
 	* This is the list of passengers/mail/goods that
 	* have arrived at this stop but are in the process
@@ -537,8 +552,16 @@ public:
 	*/
 	//uint32 reroute_goods();
 
-	// Re-routing goods of a single ware category
-	uint32 reroute_goods(uint8 catg);
+	/**
+	 * Finds the routes of the goods to be re-routed in the next step().
+	 * This only reads the path explorer and the world, so it may be called
+	 * for different halts at the same time.
+	 */
+	void prepare_reroute_goods();
+
+	// Re-routing goods of a single ware category,
+	// using the routes of the first prepared_count goods found by prepare_reroute_goods() where these still apply
+	uint32 reroute_goods(uint8 catg, const prepared_route_t *prepared = NULL, uint32 prepared_count = 0);
 
 
 	/**
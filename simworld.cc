@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <limits>
 #include <functional>
+#include <atomic>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -89,6 +90,8 @@
 #include "dataobj/environment.h"
 #include "dataobj/powernet.h"
 #include "dataobj/marker.h"
+#include "dataobj/route_landmarks.h"
+#include "dataobj/private_car_routes.h"
 
 #include "utils/cbuffer_t.h"
 #include "utils/simrandom.h"
@@ -125,6 +128,7 @@
 
 static vector_tpl<pthread_t> private_car_route_threads;
 static vector_tpl<pthread_t> unreserve_route_threads;
+static vector_tpl<pthread_t> run_parallel_threads;
 static vector_tpl<pthread_t> step_passengers_and_mail_threads;
 static vector_tpl<pthread_t> individual_convoy_step_threads;
 static vector_tpl<pthread_t> path_explorer_threads;
@@ -147,6 +151,15 @@ pthread_mutex_t karte_t::unreserve_route_mutex;
 
 simthread_barrier_t karte_t::private_car_barrier;
 simthread_barrier_t karte_t::unreserve_route_barrier;
+static simthread_barrier_t run_parallel_barrier;
+
+// the task of karte_t::run_parallel()
+static void (*run_parallel_task)(const void *context, uint32 begin, uint32 end);
+static const void *run_parallel_context;
+static uint32 run_parallel_count;
+#endif
+
+#ifdef MULTI_THREAD
 static simthread_barrier_t step_passengers_and_mail_barrier;
 static simthread_barrier_t path_explorer_barrier;
 static simthread_barrier_t step_convoys_barrier_internal;
@@ -159,6 +172,18 @@ thread_local uint32 karte_t::marker_index = UINT32_MAX_VALUE;
 
 vector_tpl<convoihandle_t> convoys_next_step;
 
+// The index of the next convoy in convoys_next_step to be claimed by one of the convoy threads
+static std::atomic<uint32> next_convoy_step;
+
+// A convoy which needs a route, and the straight line distance which it is to be routed
+struct convoy_step_cost_t
+{
+	convoihandle_t cnv;
+	uint32 cost;
+	bool operator<(const convoy_step_cost_t &other) const { return cost > other.cost; }
+};
+static vector_tpl<convoy_step_cost_t> convoys_next_step_costs;
+
 vector_tpl<pedestrian_t*> *karte_t::pedestrians_added_threaded;
 vector_tpl<private_car_t*> *karte_t::private_cars_added_threaded;
 #endif
@@ -329,7 +354,7 @@ void karte_t::world_xy_loop(xy_loop_func function, uint8 flags)
 }
 
 
-checklist_t::checklist_t(uint32 _ss, uint32 _st, uint8 _nfc, uint32 _random_seed, uint16 _halt_entry, uint16 _line_entry, uint16 _convoy_entry, uint32 *_rands, uint32 *_debug_sums)
+checklist_t::checklist_t(uint32 _ss, uint32 _st, uint8 _nfc, uint32 _random_seed, uint16 _halt_entry, uint16 _line_entry, uint16 _convoy_entry, uint32 *_rands, uint32 *_debug_sums, uint32 *_world_hashes, uint32 *_region_hashes)
 	: ss(_ss), st(_st), nfc(_nfc), random_seed(_random_seed), halt_entry(_halt_entry), line_entry(_line_entry), convoy_entry(_convoy_entry)
 {
 	for(  uint8 i = 0;  i < CHK_RANDS; i++  ) {
@@ -338,6 +363,12 @@ checklist_t::checklist_t(uint32 _ss, uint32 _st, uint8 _nfc, uint32 _random_seed
 	for(  uint8 i = 0;  i < CHK_DEBUG_SUMS; i++  ) {
 		debug_sum[i]	 = _debug_sums[i];
 	}
+	for(  uint8 i = 0;  i < CHK_WORLD_HASHES; i++  ) {
+		world_hash[i] = _world_hashes[i];
+	}
+	for(  uint8 i = 0;  i < CHK_REGIONS; i++  ) {
+		region_hash[i] = _region_hashes[i];
+	}
 }
 
 
@@ -359,19 +390,52 @@ void checklist_t::rdwr(memory_rw_t *buffer)
 	for(  uint8 i = 0;  i < CHK_DEBUG_SUMS;  i++  ) {
 		buffer->rdwr_long(debug_sum[i]);
 	}
+	// Digests of the world state, to tell where a desync happened
+	for(  uint8 i = 0;  i < CHK_WORLD_HASHES;  i++  ) {
+		buffer->rdwr_long(world_hash[i]);
+	}
+	for(  uint8 i = 0;  i < CHK_REGIONS;  i++  ) {
+		buffer->rdwr_long(region_hash[i]);
+	}
 }
 
 
 
 int checklist_t::print(char *buffer, const char *entity) const
 {
-	return sprintf(buffer, "%s=[ss=%u st=%u nfc=%u rand=%u halt=%u line=%u cnvy=%u\n\tssr=%u,%u,%u,%u,%u,%u,%u,%u\n\tstr=%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n\texr=%u,%u,%u,%u,%u,%u,%u,%u\n\tsums=%u,%u,%u,%u,%u,%u,%u,%u,%u,%u]\n",
+	int n = sprintf(buffer, "%s=[ss=%u st=%u nfc=%u rand=%u halt=%u line=%u cnvy=%u\n\tssr=%u,%u,%u,%u,%u,%u,%u,%u\n\tstr=%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n\texr=%u,%u,%u,%u,%u,%u,%u,%u\n\tsums=%u,%u,%u,%u,%u,%u,%u,%u,%u,%u\n\thash=%u,%u,%u,%u,%u\n\tregions=",
 		entity, ss, st, nfc, random_seed, halt_entry, line_entry, convoy_entry,
 		rand[0], rand[1], rand[2], rand[3], rand[4], rand[5], rand[6], rand[7],
 		rand[8], rand[9], rand[10], rand[11], rand[12], rand[13], rand[14], rand[15], rand[16], rand[17], rand[18], rand[19], rand[20], rand[21], rand[22], rand[23],
 		rand[24], rand[25], rand[26], rand[27], rand[28], rand[29], rand[30], rand[31],
-		debug_sum[0], debug_sum[1], debug_sum[2], debug_sum[3], debug_sum[4], debug_sum[5], debug_sum[6], debug_sum[7], debug_sum[8], debug_sum[9]
+		debug_sum[0], debug_sum[1], debug_sum[2], debug_sum[3], debug_sum[4], debug_sum[5], debug_sum[6], debug_sum[7], debug_sum[8], debug_sum[9],
+		world_hash[0], world_hash[1], world_hash[2], world_hash[3], world_hash[4]
 	);
+	for(  uint8 i = 0;  i < CHK_REGIONS;  i++  ) {
+		n += sprintf(buffer + n, i + 1 < CHK_REGIONS ? "%u," : "%u]\n", region_hash[i]);
+	}
+	return n;
+}
+
+
+int checklist_t::print_divergence(char *buffer, const checklist_t &other) const
+{
+	static const char *const world_hash_names[CHK_WORLD_HASHES] = { "ways", "halts", "convoys", "factories", "cities" };
+
+	int n = sprintf(buffer, "diverged in");
+	for(  uint8 i = 0;  i < CHK_WORLD_HASHES;  i++  ) {
+		if(  world_hash[i] != other.world_hash[i]  ) {
+			n += sprintf(buffer + n, " %s", world_hash_names[i]);
+		}
+	}
+	n += sprintf(buffer + n, ", regions (x,y of %u):", CHK_REGIONS_PER_AXIS);
+	for(  uint8 i = 0;  i < CHK_REGIONS;  i++  ) {
+		if(  region_hash[i] != other.region_hash[i]  ) {
+			n += sprintf(buffer + n, " %u,%u", i % CHK_REGIONS_PER_AXIS, i / CHK_REGIONS_PER_AXIS);
+		}
+	}
+	n += sprintf(buffer + n, "\n");
+	return n;
 }
 
 
@@ -546,6 +610,9 @@ void karte_t::destroy()
 	destroying = true;
 	DBG_MESSAGE("karte_t::destroy()", "destroying world");
 
+	// an autosave may still be written
+	loadsave_t::finish_background_save();
+
 #ifdef MULTI_THREAD
 	suspend_private_car_threads();
 	destroy_threads();
@@ -698,6 +765,10 @@ void karte_t::destroy()
 
 	// Added by : B.Gabriel
 	route_t::TERM_NODES();
+	route_landmarks_t::reset();
+	private_car_routes_t::reset();
+	private_car_routes_up_to_date = false;
+	last_private_car_route_full_refresh = -1;
 
 	// Added by : Knightly
 	path_explorer_t::finalise();
@@ -1459,6 +1530,7 @@ void karte_t::init(settings_t* const sets, sint8 const* const h_field)
 	current_month = last_month + (last_year*12);
 	set_ticks_per_world_month_shift(settings.get_bits_per_month());
 	next_month_ticks =  karte_t::ticks_per_world_month;
+	way_wear_row = 0;
 	season=(2+last_month/3)&3; // summer always zero
 	steps = 0;
 	network_frame_count = 0;
@@ -1580,6 +1652,7 @@ DBG_DEBUG("karte_t::init()","built timeline");
 
 	// Added by : Knightly
 	path_explorer_t::full_instant_refresh();
+	route_landmarks_t::reset();
 
 	// Set the actual industry density and industry density proportion
 	actual_industry_density = 0;
@@ -1905,12 +1978,27 @@ void *step_convoys_threaded(void* args)
 			return NULL;
 		}
 
-		// since convois will be deleted during stepping, we need to step backwards
+		// Only convoys waiting for a route have anything to do in the threaded step.
+		// These are handed out longest route first, so that no thread is left with
+		// a long search when the others have run out of work.
 		for (uint32 i = world->convoi_array.get_count(); i-- != 0;)
 		{
 			convoihandle_t cnv = world->convoi_array[i];
-			convoys_next_step.append(cnv);
+			if (cnv->get_state() == convoi_t::ROUTING_2)
+			{
+				convoy_step_cost_t entry;
+				entry.cnv = cnv;
+				entry.cost = cnv->get_schedule() && cnv->front() ? shortest_distance(cnv->front()->get_pos().get_2d(), cnv->get_schedule()->get_current_entry().pos.get_2d()) : 0;
+				convoys_next_step_costs.append(entry);
+			}
+		}
+		std::stable_sort(convoys_next_step_costs.begin(), convoys_next_step_costs.end());
+		for (uint32 i = 0; i < convoys_next_step_costs.get_count(); i++)
+		{
+			convoys_next_step.append(convoys_next_step_costs[i].cnv);
 		}
+		convoys_next_step_costs.clear();
+		next_convoy_step = 0;
 
 		simthread_barrier_wait(&step_convoys_barrier_internal);
 		simthread_barrier_wait(&step_convoys_barrier_internal); // The multiples of these is intentional: we must wait for the individual threads to finish before the clear() command is executed.
@@ -1938,8 +2026,10 @@ void* step_individual_convoy_threaded(void* args)
 			return NULL;
 		}
 
+		// Each thread claims the next convoy as soon as it has finished its last,
+		// so that a thread with several long route searches does not hold up the others.
 		const uint32 convoys_next_step_count = convoys_next_step.get_count();
-		for (uint32 i = thread_number; i < convoys_next_step_count; i += karte_t::world->get_parallel_operations())
+		for (uint32 i = next_convoy_step++; i < convoys_next_step_count; i = next_convoy_step++)
 		{
 			convoihandle_t cnv = convoys_next_step[i];
 			if (cnv.is_bound())
@@ -2114,8 +2204,101 @@ void* unreserve_route_threaded(void* args)
 	pthread_exit(NULL);
 	return args;
 }
+
+void* run_parallel_threaded(void* args)
+{
+	const uint32* thread_number_ptr = (const uint32*)args;
+	const uint32 thread_number = *thread_number_ptr;
+	delete thread_number_ptr;
+
+	do
+	{
+		simthread_barrier_wait(&run_parallel_barrier);
+
+		if (karte_t::world->is_terminating_threads())
+		{
+			break;
+		}
+
+		const uint32 thread_count = karte_t::world->get_parallel_operations() + 1;
+		const uint32 begin = (uint32)(((uint64)run_parallel_count * thread_number) / thread_count);
+		const uint32 end = (uint32)(((uint64)run_parallel_count * (thread_number + 1)) / thread_count);
+		if (begin < end)
+		{
+			run_parallel_task(run_parallel_context, begin, end);
+		}
+
+		simthread_barrier_wait(&run_parallel_barrier);
+
+	} while (!karte_t::world->is_terminating_threads());
+
+	pthread_exit(NULL);
+	return args;
+}
 #endif
 
+void karte_t::run_parallel(void (*task)(const void *context, uint32 begin, uint32 end), const void *context, uint32 count)
+{
+#ifdef MULTI_THREAD
+	if (threads_initialised)
+	{
+		run_parallel_task = task;
+		run_parallel_context = context;
+		run_parallel_count = count;
+		simthread_barrier_wait(&run_parallel_barrier); // start the threads
+		simthread_barrier_wait(&run_parallel_barrier); // wait for all slices to be done
+		return;
+	}
+#endif
+	task(context, 0, count);
+}
+
+// context : the time since the last step, as uint32
+static void step_factory_production(const void *context, uint32 begin, uint32 end)
+{
+	const uint32 delta_t = *(const uint32 *)context;
+	const vector_tpl<fabrik_t*> &fab_list = world()->get_fab_list();
+	for (uint32 i = begin; i < end; i++)
+	{
+		fab_list[i]->step_production(delta_t);
+	}
+}
+
+static void roll_way_statistics(const void *, uint32 begin, uint32 end)
+{
+	const vector_tpl<weg_t*> &ways = weg_t::get_alle_wege();
+	for (uint32 i = begin; i < end; i++)
+	{
+		ways[i]->roll_statistics();
+	}
+}
+
+void karte_t::wear_ways(bool all)
+{
+	// Wearing may renew ways at their owners' expense, so this must be done in order.
+	const uint32 rows = (uint32)get_size().y;
+	const uint32 end = all ? rows : min(rows, way_wear_row + max(1u, (rows + way_wear_steps - 1) / way_wear_steps));
+	for (uint32 y = way_wear_row; y < end; y++)
+	{
+		for (sint16 x = 0; x < get_size().x; x++)
+		{
+			const planquadrat_t *plan = access_nocheck(x, y);
+			for (uint8 i = 0; i < plan->get_boden_count(); i++)
+			{
+				const grund_t *gr = plan->get_boden_bei(i);
+				for (int n = 0; n < 2; n++)
+				{
+					if (weg_t *weg = gr->get_weg_nr(n))
+					{
+						weg->apply_monthly_wear();
+					}
+				}
+			}
+		}
+	}
+	way_wear_row = max(way_wear_row, end);
+}
+
 void karte_t::await_all_threads()
 {
 #ifdef MULTI_THREAD
@@ -2153,6 +2336,7 @@ void karte_t::init_threads()
 	simthread_barrier_init(&private_car_barrier, NULL, one_private_car_thread ? 2 : parallel_operations + 1);
 	simthread_barrier_init(&karte_t::unreserve_route_barrier, NULL, parallel_operations + 2); // This and the next does not run concurrently with anything significant on the main thread, so the number of parallel operations need to be +1 compared to the others.
 	simthread_barrier_init(&step_passengers_and_mail_barrier, NULL, parallel_operations + 2);
+	simthread_barrier_init(&run_parallel_barrier, NULL, parallel_operations + 2);
 	simthread_barrier_init(&step_convoys_barrier_external, NULL, 2);
 	simthread_barrier_init(&step_convoys_barrier_internal, NULL, parallel_operations + 1);
 	simthread_barrier_init(&path_explorer_barrier, NULL, 2);
@@ -2200,6 +2384,18 @@ void karte_t::init_threads()
 			unreserve_route_threads.append(thread);
 		}
 
+		uint32* thread_number_par = new uint32;
+		*thread_number_par = i;
+		rc = pthread_create(&thread, &thread_attributes, &run_parallel_threaded, (void*)thread_number_par);
+		if (rc)
+		{
+			dbg->fatal("void karte_t::init_threads()", "Failed to create parallel task thread, error %d. See here for a translation of the error numbers: http://epydoc.sourceforge.net/stdlib/errno-module.html", rc);
+		}
+		else
+		{
+			run_parallel_threads.append(thread);
+		}
+
 #ifdef MULTI_THREAD_PASSENGER_GENERATION
 		sint32* thread_number_pass = new sint32;
 		*thread_number_pass = i + 1; // +1 because we need thread number 0 to represent the main thread.
@@ -2286,6 +2482,7 @@ void karte_t::destroy_threads()
 		simthread_barrier_wait(&private_car_barrier);
 
 		simthread_barrier_wait(&unreserve_route_barrier);
+		simthread_barrier_wait(&run_parallel_barrier);
 #ifdef MULTI_THREAD_PATH_EXPLORER
 		simthread_barrier_wait(&path_explorer_barrier);
 		pthread_join(path_explorer_thread, 0);
@@ -2304,6 +2501,8 @@ void karte_t::destroy_threads()
 
 		clean_threads(&unreserve_route_threads);
 		unreserve_route_threads.clear();
+		clean_threads(&run_parallel_threads);
+		run_parallel_threads.clear();
 #ifdef MULTI_THREAD_CONVOYS
 		simthread_barrier_destroy(&step_convoys_barrier_external);
 		simthread_barrier_destroy(&step_convoys_barrier_internal);
@@ -2313,6 +2512,7 @@ void karte_t::destroy_threads()
 #endif
 		simthread_barrier_destroy(&private_car_barrier);
 		simthread_barrier_destroy(&unreserve_route_barrier);
+		simthread_barrier_destroy(&run_parallel_barrier);
 
 #ifdef MULTI_THREAD_PATH_EXPLORER
 		simthread_barrier_destroy(&path_explorer_barrier);
@@ -2972,18 +3172,18 @@ void karte_t::enlarge_map(settings_t const* sets, sint8 const* const h_field)
 
 	for (uint8 i = 0; i < goods_manager_t::passengers->get_number_of_classes(); i++)
 	{
-		FOR(weighted_vector_tpl<gebaeude_t*>, const target, commuter_targets[i])
+		FOR(fenwick_weighted_vector_tpl<gebaeude_t*>, const target, commuter_targets[i])
 		{
 			target->set_building_tiles();
 		}
 
-		FOR(weighted_vector_tpl<gebaeude_t*>, const target, visitor_targets[i])
+		FOR(fenwick_weighted_vector_tpl<gebaeude_t*>, const target, visitor_targets[i])
 		{
 			target->set_building_tiles();
 		}
 	}
 
-	FOR(weighted_vector_tpl<gebaeude_t*>, const target, mail_origins_and_targets)
+	FOR(fenwick_weighted_vector_tpl<gebaeude_t*>, const target, mail_origins_and_targets)
 	{
 		target->set_building_tiles();
 	}
@@ -3114,6 +3314,10 @@ karte_t::karte_t() :
 	sync_steps_barrier = sync_steps;
 	next_step_passenger = 0;
 	next_step_mail = 0;
+	time_interval_caution_ticks = -1;
+	time_interval_clear_ticks = -1;
+	clear_checklist_world_hashes();
+	way_wear_row = 0;
 	destroying = false;
 	transferring_cargoes = NULL;
 #ifdef MULTI_THREAD
@@ -3191,8 +3395,8 @@ karte_t::karte_t() :
 	parallel_operations = -1;
 
 	const uint8 number_of_passenger_classes = goods_manager_t::passengers->get_number_of_classes();
-	commuter_targets = new weighted_vector_tpl<gebaeude_t*>[number_of_passenger_classes];
-	visitor_targets = new weighted_vector_tpl<gebaeude_t*>[number_of_passenger_classes];
+	commuter_targets = new fenwick_weighted_vector_tpl<gebaeude_t*>[number_of_passenger_classes];
+	visitor_targets = new fenwick_weighted_vector_tpl<gebaeude_t*>[number_of_passenger_classes];
 
 #ifdef MULTI_THREAD
 	passengers_and_mail_threads_working = false;
@@ -4502,6 +4706,9 @@ DBG_MESSAGE( "karte_t::rotate90()", "called" );
 		s->release_factory_links();
 	}
 
+	// The rows of tiles are about to change, so the wear still due this month is applied now.
+	wear_ways(true);
+
 	// Rotate cities first so that the private car routes can be removed
 	FOR(weighted_vector_tpl<stadt_t*>, const i, stadt) {
 		i->rotate90(cached_size.y);
@@ -4545,6 +4752,7 @@ DBG_MESSAGE( "karte_t::rotate90()", "called" );
 	int wx = cached_grid_size.x;
 	cached_grid_size.x = cached_grid_size.y;
 	cached_grid_size.y = wx;
+	way_wear_row = cached_grid_size.y; // the wear of this month has been applied above
 
 	//fixed order factory, halts, convois
 	FOR(vector_tpl<fabrik_t*>, const f, fab_list) {
@@ -4585,20 +4793,20 @@ DBG_MESSAGE( "karte_t::rotate90()", "called" );
 
 	for (uint8 i = 0; i < goods_manager_t::passengers->get_number_of_classes(); i++)
 	{
-		FOR(weighted_vector_tpl<gebaeude_t*>, const building, visitor_targets[i])
+		FOR(fenwick_weighted_vector_tpl<gebaeude_t*>, const building, visitor_targets[i])
 		{
 			building->set_building_tiles();
 		}
-		FOR(weighted_vector_tpl<gebaeude_t*>, const building, commuter_targets[i])
+		FOR(fenwick_weighted_vector_tpl<gebaeude_t*>, const building, commuter_targets[i])
 		{
 			building->set_building_tiles();
 		}
 	}
-	FOR(weighted_vector_tpl<gebaeude_t*>, const building, passenger_origins)
+	FOR(fenwick_weighted_vector_tpl<gebaeude_t*>, const building, passenger_origins)
 	{
 		building->set_building_tiles();
 	}
-	FOR(weighted_vector_tpl<gebaeude_t*>, const building, mail_origins_and_targets)
+	FOR(fenwick_weighted_vector_tpl<gebaeude_t*>, const building, mail_origins_and_targets)
 	{
 		building->set_building_tiles();
 	}
@@ -5175,9 +5383,12 @@ void karte_t::new_month()
 
 	// this should be done before a map update, since the map may want an update of the way usage
 //	DBG_MESSAGE("karte_t::new_month()","ways");
-	FOR(vector_tpl<weg_t*>, const w, weg_t::get_alle_wege()) {
-		w->new_month();
-	}
+	// The wear still due for the month which has ended is applied before the players' accounts
+	// move on to the new month. The statistics only concern each way itself, so these are rolled
+	// over in parallel. The wear of the new month is spread over its first steps.
+	wear_ways(true);
+	run_parallel(&roll_way_statistics, NULL, weg_t::get_alle_wege().get_count());
+	way_wear_row = 0;
 
 	// Update the maximum vehicle speed records to calibrate when passengers should not burden the journey time database.
 	calc_max_vehicle_speeds();
@@ -5375,7 +5586,7 @@ void karte_t::new_month()
 	if( !env_t::networkmode && env_t::autosave>0 && last_month%env_t::autosave==0 && !win_get_magic(magic_welt_gui_t) ) {
 		char buf[128];
 		sprintf( buf, "save/autosave%02i.sve", last_month+1 );
-		save( buf, true, env_t::savegame_version_str, env_t::savegame_ex_version_str, env_t::savegame_ex_revision_str, true );
+		save( buf, true, env_t::savegame_version_str, env_t::savegame_ex_version_str, env_t::savegame_ex_revision_str, true, env_t::background_autosave );
 	}
 
 	recalc_passenger_destination_weights();
@@ -5577,8 +5788,10 @@ void karte_t::pause_step()
 
 	if (!private_car_route_check_complete && cities_awaiting_private_car_route_check.empty())
 	{
-		refresh_private_car_routes();
-		dbg->message("karte_t::pause_step", "Refreshed private car routes");
+		if (refresh_private_car_routes())
+		{
+			dbg->message("karte_t::pause_step", "Refreshed private car routes");
+		}
 		private_car_route_check_complete = true;
 	}
 
@@ -5723,8 +5936,10 @@ void karte_t::step()
 
 		if (cities_awaiting_private_car_route_check.empty() && cities_to_process <= 0)
 		{
-			refresh_private_car_routes();
-			dbg->message("karte_t::step", "Refreshed private car routes");
+			if (refresh_private_car_routes())
+			{
+				dbg->message("karte_t::step", "Refreshed private car routes");
+			}
 		}
 
 #ifdef MULTI_THREAD
@@ -5808,6 +6023,14 @@ void karte_t::step()
 	}
 #endif
 
+	// The convoys' route searches are finished, so the landmarks for these may now be rebuilt,
+	// and ways may be renewed.
+	route_landmarks_t::step(this);
+	if (way_wear_row < (uint32)get_size().y)
+	{
+		wear_ways(false);
+	}
+
 	rands[13] = get_random_seed();
 
 	// The more computationally intensive parts of this have been extracted and made multi-threaded.
@@ -6018,8 +6241,13 @@ void karte_t::step()
 	INT_CHECK("karte_t::step 5");
 
 	DBG_DEBUG4("karte_t::step", "step factories");
+	// Production and consumption only concern each factory itself, so these are
+	// stepped in parallel. The goods are then distributed to halts and to other
+	// factories in the usual order, once all factories have produced.
+	const uint32 factory_delta_t = delta_t;
+	run_parallel(&step_factory_production, &factory_delta_t, fab_list.get_count());
 	FOR(vector_tpl<fabrik_t*>, const f, fab_list) {
-		f->step(delta_t);
+		f->step_distribution(delta_t);
 	}
 	rands[20] = get_random_seed();
 
@@ -6072,6 +6300,9 @@ void karte_t::step()
 
 	rands[25] = get_random_seed();
 
+	// All threads which change the world are finished here, until the path explorer and the convoys start again
+	step_world_hashes();
+
 #ifdef MULTI_THREAD_PATH_EXPLORER
 	// Start the path explorer ready for the next step. This can be very
 	// computationally intensive, but intermittently so.
@@ -6137,63 +6368,297 @@ void karte_t::step()
 	rands[26] = get_random_seed();
 }
 
-void karte_t::refresh_private_car_routes() {
+
+// number of objects of each kind digested per step
+#define WORLD_HASH_SLICE (256)
+
+// FNV-1a over 32 bit words
+static inline uint32 world_hash_word(uint32 hash, uint32 word)
+{
+	return (hash ^ word) * 16777619u;
+}
+
+
+void karte_t::add_to_world_hash(uint8 subsystem, koord pos, uint32 digest)
+{
+	// sums do not depend on the order in which the objects are digested
+	world_hashes[subsystem] += digest;
+	uint8 region = 0;
+	if(  is_within_limits(pos)  ) {
+		region = (uint8)( (pos.x * CHK_REGIONS_PER_AXIS) / get_size().x + CHK_REGIONS_PER_AXIS * ((pos.y * CHK_REGIONS_PER_AXIS) / get_size().y) );
+	}
+	region_hashes[region] += digest;
+}
+
+
+// whether the object with @p key is digested in this step: of @p count objects, about WORLD_HASH_SLICE are
+// the keys do not depend on the order of the lists, which differs between a running and a loaded game
+static inline bool is_in_world_hash_slice(uint32 key, uint32 count, sint32 steps)
+{
+	const uint32 slices = max(1u, (count + WORLD_HASH_SLICE - 1) / WORLD_HASH_SLICE);
+	return key % slices == (uint32)steps % slices;
+}
+
+
+void karte_t::step_world_hashes()
+{
+	clear_checklist_world_hashes();
+
+	// ways, by a band of tiles
+	const uint32 way_count = weg_t::get_all_ways_count();
+	if(  way_count > 0  ) {
+		const uint32 tiles = (uint32)cached_grid_size.x * (uint32)cached_grid_size.y;
+		const uint32 slices = max(1u, (way_count + WORLD_HASH_SLICE - 1) / WORLD_HASH_SLICE);
+		const uint32 tiles_per_slice = (tiles + slices - 1) / slices;
+		const uint32 first = ((uint32)steps % slices) * tiles_per_slice;
+		for(  uint32 i = first;  i < first + tiles_per_slice  &&  i < tiles;  i++  ) {
+			const planquadrat_t *plan = access_nocheck(i % cached_grid_size.x, i / cached_grid_size.x);
+			for(  uint8 b = 0;  b < plan->get_boden_count();  b++  ) {
+				const grund_t *gr = plan->get_boden_bei(b);
+				for(  int n = 0;  n < 2;  n++  ) {
+					const weg_t *w = gr->get_weg_nr(n);
+					if(  w == NULL  ) {
+						break;
+					}
+					const koord3d pos = w->get_pos();
+					uint32 digest = world_hash_word(2166136261u, (uint32)pos.x | ((uint32)(uint16)pos.y << 16));
+					digest = world_hash_word(digest, (uint32)(uint8)pos.z | ((uint32)w->get_waytype() << 8) | ((uint32)w->get_ribi_unmasked() << 16) | ((uint32)(uint8)w->get_player_nr() << 24));
+					digest = world_hash_word(digest, (uint32)w->get_max_speed());
+					digest = world_hash_word(digest, w->get_max_axle_load());
+					digest = world_hash_word(digest, w->get_remaining_wear_capacity());
+					add_to_world_hash(0, pos.get_2d(), digest);
+				}
+			}
+		}
+	}
+
+	// halts, by their handle
+	const vector_tpl<halthandle_t> &halts = haltestelle_t::get_alle_haltestellen();
+	FOR(vector_tpl<halthandle_t>, const halt, halts) {
+		if(  !is_in_world_hash_slice(halt.get_id(), halts.get_count(), steps)  ) {
+			continue;
+		}
+		const koord pos = halt->get_basis_pos();
+		uint32 digest = world_hash_word(2166136261u, (uint32)(uint16)pos.x | ((uint32)(uint16)pos.y << 16));
+		digest = world_hash_word(digest, halt.get_id());
+		for(  int i = HALT_ARRIVED;  i <= HALT_NOROUTE;  i++  ) {
+			digest = world_hash_word(digest, (uint32)halt->get_finance_history(0, i));
+		}
+		add_to_world_hash(1, pos, digest);
+	}
+
+	// convoys, by their handle
+	FOR(vector_tpl<convoihandle_t>, const cnv, convoi_array) {
+		if(  !is_in_world_hash_slice(cnv.get_id(), convoi_array.get_count(), steps)  ) {
+			continue;
+		}
+		const koord3d pos = cnv->get_pos();
+		uint32 digest = world_hash_word(2166136261u, (uint32)(uint16)pos.x | ((uint32)(uint16)pos.y << 16));
+		digest = world_hash_word(digest, cnv.get_id() | ((uint32)cnv->get_state() << 16) | ((uint32)(uint8)pos.z << 24));
+		digest = world_hash_word(digest, (uint32)cnv->get_akt_speed());
+		digest = world_hash_word(digest, (uint32)cnv->get_total_distance_traveled());
+		digest = world_hash_word(digest, (uint32)cnv->get_jahresgewinn());
+		add_to_world_hash(2, pos.get_2d(), digest);
+	}
+
+	// factories, by their tile
+	FOR(vector_tpl<fabrik_t *>, const fab, fab_list) {
+		const koord pos = fab->get_pos().get_2d();
+		if(  !is_in_world_hash_slice((uint32)pos.x + (uint32)pos.y * cached_grid_size.x, fab_list.get_count(), steps)  ) {
+			continue;
+		}
+		uint32 digest = world_hash_word(2166136261u, (uint32)(uint16)pos.x | ((uint32)(uint16)pos.y << 16));
+		digest = world_hash_word(digest, (uint32)fab->get_current_production());
+		digest = world_hash_word(digest, fab->get_total_in());
+		digest = world_hash_word(digest, fab->get_total_transit());
+		digest = world_hash_word(digest, fab->get_total_out());
+		add_to_world_hash(3, pos, digest);
+	}
+
+	// cities, by their tile
+	FOR(weighted_vector_tpl<stadt_t *>, const city, stadt) {
+		const koord pos = city->get_pos();
+		if(  !is_in_world_hash_slice((uint32)pos.x + (uint32)pos.y * cached_grid_size.x, stadt.get_count(), steps)  ) {
+			continue;
+		}
+		uint32 digest = world_hash_word(2166136261u, (uint32)(uint16)pos.x | ((uint32)(uint16)pos.y << 16));
+		digest = world_hash_word(digest, city->get_buildings());
+		digest = world_hash_word(digest, (uint32)city->get_finance_history_month(0, HIST_CITIZENS));
+		digest = world_hash_word(digest, (uint32)city->get_finance_history_month(0, HIST_PAS_GENERATED));
+		digest = world_hash_word(digest, (uint32)city->get_finance_history_month(0, HIST_PAS_TRANSPORTED));
+		digest = world_hash_word(digest, (uint32)city->get_finance_history_month(0, HIST_MAIL_GENERATED));
+		add_to_world_hash(4, pos, digest);
+	}
+}
+
+bool karte_t::refresh_private_car_routes() {
+	const uint16 full_refresh_months = settings.get_private_car_route_full_refresh_months();
+	const bool full_refresh = full_refresh_months == 0 || last_private_car_route_full_refresh < 0 || private_car_routes_t::has_too_many_road_changes() ||
+		(sint32)current_month >= last_private_car_route_full_refresh + full_refresh_months;
+	if (private_car_routes_up_to_date && !full_refresh && !private_car_routes_t::has_road_changes())
+	{
+		return false;
+	}
+
 #ifdef MULTI_THREAD
 	suspend_private_car_threads();
 #endif
-	weg_t::swap_private_car_routes_currently_reading_element();
-	clear_private_car_routes();
-	for(auto & city : stadt) {
-		cities_awaiting_private_car_route_check.insert(city);
+	if (!private_car_routes_up_to_date)
+	{
+		// The check which has just finished
+		private_car_routes_t::swap();
 	}
-}
+	private_car_routes_up_to_date = false;
 
-void karte_t::clear_private_car_routes() {
-	weg_t::private_car_route_map::route_map_lock();
-	for(auto & w : weg_t::get_alle_wege()) {
-		for(auto & l : w->private_car_routes[weg_t::get_private_car_routes_currently_writing_element()]) {
-			l.pre_reset();
+	if (full_refresh)
+	{
+		last_private_car_route_full_refresh = current_month;
+		private_car_routes_t::begin_full_refresh();
+		for(auto & city : stadt) {
+			cities_awaiting_private_car_route_check.insert(city);
 		}
 	}
-	weg_t::private_car_route_map::reset(weg_t::get_private_car_routes_currently_writing_element());
-
-	weg_t::private_car_route_map::route_map_unlock();
+	else if (private_car_routes_t::has_road_changes())
+	{
+		// Only check the cities whose routes may lead over the changed roads again.
+		// Their new routes replace the old ones on the same tiles, less those cut by removed roads.
+		vector_tpl<koord3d> changed_tiles;
+		private_car_routes_t::begin_update(changed_tiles);
+		for(auto & city : stadt) {
+			if (city->are_private_car_routes_affected(changed_tiles))
+			{
+				cities_awaiting_private_car_route_check.insert(city);
+			}
+		}
+		if (cities_awaiting_private_car_route_check.empty())
+		{
+			private_car_routes_t::swap();
+			private_car_routes_up_to_date = true;
+		}
+	}
+	else
+	{
+		private_car_routes_up_to_date = true;
+	}
+	return true;
+}
 
+void karte_t::set_time_interval_timer(signal_t *sig, sint64 due)
+{
+	sig->time_interval_check_due = due;
+	time_interval_timer_t timer;
+	timer.due = due;
+	timer.sig = sig;
+	time_interval_timers.append(timer);
+	std::push_heap(time_interval_timers.begin(), time_interval_timers.end());
+	sig->time_interval_timers++;
 }
 
-void karte_t::step_time_interval_signals()
+void karte_t::add_time_interval_signal_to_check(signal_t* sig)
 {
-	if (!time_interval_signals_to_check.empty())
+	if (sig->time_interval_check_due < 0 || sig->time_interval_check_due > ticks)
 	{
-		const sint64 caution_interval_ticks = get_seconds_to_ticks(settings.get_time_interval_seconds_to_caution());
-		const sint64 clear_interval_ticks = get_seconds_to_ticks(settings.get_time_interval_seconds_to_clear());
+		set_time_interval_timer(sig, ticks);
+	}
+}
 
-		for (vector_tpl<signal_t*>::iterator iter = time_interval_signals_to_check.begin(); iter != time_interval_signals_to_check.end();)
+bool karte_t::remove_time_interval_signal_to_check(signal_t* sig)
+{
+	const bool was_checked = sig->time_interval_check_due >= 0;
+	sig->time_interval_check_due = -1;
+	if (sig->time_interval_timers > 0)
+	{
+		// The signal is about to be deleted, so no timer may point to it any more.
+		for (uint32 i = 0; i < time_interval_timers.get_count(); )
 		{
-			signal_t* sig = *iter;
-			if (((sig->get_train_last_passed() + clear_interval_ticks) < ticks) && sig->get_no_junctions_to_next_signal())
+			if (time_interval_timers[i].sig == sig)
 			{
-				iter = time_interval_signals_to_check.swap_erase(iter);
-				sig->set_state(roadsign_t::clear_no_choose);
+				time_interval_timers.remove_at(i, false);
 			}
-			else if (sig->get_state() == roadsign_t::danger && ((sig->get_train_last_passed() + caution_interval_ticks) < ticks) && sig->get_no_junctions_to_next_signal())
+			else
 			{
-				if (sig->get_desc()->is_pre_signal())
-				{
-					sig->set_state(roadsign_t::clear_no_choose);
-				}
-				else
-				{
-					sig->set_state(roadsign_t::caution_no_choose);
-				}
+				i++;
+			}
+		}
+		std::make_heap(time_interval_timers.begin(), time_interval_timers.end());
+		sig->time_interval_timers = 0;
+	}
+	return was_checked;
+}
 
-				++iter;
+void karte_t::recheck_time_interval_signal(signal_t* sig)
+{
+	if (sig->time_interval_check_due > ticks)
+	{
+		set_time_interval_timer(sig, ticks);
+	}
+}
+
+void karte_t::step_time_interval_signals()
+{
+	const sint64 caution_interval_ticks = get_seconds_to_ticks(settings.get_time_interval_seconds_to_caution());
+	const sint64 clear_interval_ticks = get_seconds_to_ticks(settings.get_time_interval_seconds_to_clear());
+
+	if (caution_interval_ticks != time_interval_caution_ticks || clear_interval_ticks != time_interval_clear_ticks)
+	{
+		// The timers are out of date: check all signals now.
+		time_interval_caution_ticks = caution_interval_ticks;
+		time_interval_clear_ticks = clear_interval_ticks;
+		FOR(vector_tpl<time_interval_timer_t>, &timer, time_interval_timers)
+		{
+			if (timer.sig->time_interval_check_due == timer.due)
+			{
+				timer.sig->time_interval_check_due = ticks;
+			}
+			timer.due = ticks;
+		}
+	}
+
+	while (!time_interval_timers.empty() && time_interval_timers.front().due <= ticks)
+	{
+		std::pop_heap(time_interval_timers.begin(), time_interval_timers.end());
+		const time_interval_timer_t timer = time_interval_timers.pop_back();
+		signal_t* sig = timer.sig;
+		sig->time_interval_timers--;
+		if (sig->time_interval_check_due != timer.due)
+		{
+			// This timer has been replaced by an earlier one, or the signal is no longer checked.
+			continue;
+		}
+
+		if (((sig->get_train_last_passed() + clear_interval_ticks) < ticks) && sig->get_no_junctions_to_next_signal())
+		{
+			sig->time_interval_check_due = -1;
+			sig->set_state(roadsign_t::clear_no_choose);
+			continue;
+		}
+		else if (sig->get_state() == roadsign_t::danger && ((sig->get_train_last_passed() + caution_interval_ticks) < ticks) && sig->get_no_junctions_to_next_signal())
+		{
+			if (sig->get_desc()->is_pre_signal())
+			{
+				sig->set_state(roadsign_t::clear_no_choose);
 			}
 			else
 			{
-				++iter;
+				sig->set_state(roadsign_t::caution_no_choose);
 			}
 		}
+
+		// Check the signal again when it may next change. If both intervals have passed already, it
+		// waits for a junction to be removed or for being set to danger, which call recheck_time_interval_signal().
+		sint64 next_due = sig->get_train_last_passed() + clear_interval_ticks + 1;
+		if (sig->get_state() == roadsign_t::danger && sig->get_train_last_passed() + caution_interval_ticks >= ticks)
+		{
+			next_due = min(next_due, sig->get_train_last_passed() + caution_interval_ticks + 1);
+		}
+		if (next_due > ticks)
+		{
+			set_time_interval_timer(sig, next_due);
+		}
+		else
+		{
+			sig->time_interval_check_due = SINT64_MAX_VALUE;
+		}
 	}
 }
 
@@ -8470,12 +8935,20 @@ bool karte_t::play_sound_area_clipped(koord const k, uint16 const idx, sound_typ
 }
 
 
-void karte_t::save(const char *filename, bool autosave, const char *version_str, const char *ex_version_str, const char* ex_revision_str, bool silent )
+void karte_t::save(const char *filename, bool autosave, const char *version_str, const char *ex_version_str, const char* ex_revision_str, bool silent, bool background )
 {
 DBG_MESSAGE("karte_t::save()", "saving game to '%s'", filename);
+	// the previous background save must be complete before writing anything else
+	if(  const char *err = loadsave_t::finish_background_save()  ) {
+		static char err_str[512];
+		sprintf( err_str, translator::translate("Error during saving:\n%s"), err );
+		create_win( new news_img(err_str), w_time_delete, magic_none);
+	}
+
 	loadsave_t  file;
 	std::string savename = filename;
-	if (!env_t::networkmode || env_t::server)
+	const bool use_temp_name = !env_t::networkmode || env_t::server;
+	if (use_temp_name)
 	{
 		// There are some problems with re-naming this temporary file.
 		// Corruption is less of an issue when a client is saving a game from a network server,
@@ -8488,7 +8961,14 @@ DBG_MESSAGE("karte_t::save()", "saving game to '%s'", filename);
 
 	const loadsave_t::mode_t mode = autosave ? loadsave_t::autosave_mode : loadsave_t::save_mode;
 	const int level = autosave ? loadsave_t::autosave_level : loadsave_t::save_level;
-	loadsave_t::file_status_t status = file.wr_open( savename.c_str(), mode, level, env_t::objfilename.c_str(), version_str, ex_version_str, ex_revision_str );
+	loadsave_t::file_status_t status;
+	if(  background  ) {
+		// renamed by the background thread when written
+		status = file.wr_open_snapshot( savename.c_str(), use_temp_name ? filename : NULL, mode, level, env_t::objfilename.c_str(), version_str, ex_version_str, ex_revision_str );
+	}
+	else {
+		status = file.wr_open( savename.c_str(), mode, level, env_t::objfilename.c_str(), version_str, ex_version_str, ex_revision_str );
+	}
 
 	if(status != loadsave_t::FILE_STATUS_OK) {
 		create_win(new news_img("Kann Spielstand\nnicht speichern.\n"), w_info, magic_none);
@@ -8503,7 +8983,7 @@ DBG_MESSAGE("karte_t::save()", "saving game to '%s'", filename);
 			create_win( new news_img(err_str), w_time_delete, magic_none);
 		}
 		else {
-			if (!env_t::networkmode || env_t::server)
+			if (use_temp_name  &&  !background)
 			{
 				const int renamed_correctly = dr_rename(savename.c_str(), filename);
 				if (renamed_correctly)
@@ -8924,10 +9404,7 @@ DBG_MESSAGE("karte_t::save(loadsave_t *file)", "motd filename %s", env_t::server
 		}
 	}
 
-	if (file->get_extended_version() >= 15 || (file->get_extended_version() == 14 && file->get_extended_revision() >= 20))
-	{
-		file->rdwr_long(weg_t::private_car_routes_currently_reading_element);
-	}
+	private_car_routes_t::rdwr(file);
 
 	if (file->get_extended_version() >= 15 || ((file->get_extended_version() >= 14 && file->get_extended_revision() >= 8) && get_settings().get_save_path_explorer_data()))
 	{
@@ -8948,6 +9425,23 @@ DBG_MESSAGE("karte_t::save(loadsave_t *file)", "motd filename %s", env_t::server
 		file->rdwr_long(cities_to_process);
 	}
 
+	if(  file->is_version_ex_atleast(14, 44)  ) {
+		// the world hashes of the last step, which the checklists compare until the next one
+		for(  uint8 i = 0;  i < CHK_WORLD_HASHES;  i++  ) {
+			file->rdwr_long(world_hashes[i]);
+		}
+		for(  uint8 i = 0;  i < CHK_REGIONS;  i++  ) {
+			file->rdwr_long(region_hashes[i]);
+		}
+	}
+
+	if(  file->is_version_ex_atleast(14, 45)  ) {
+		file->rdwr_long(way_wear_row);
+		// the state of the private car route checks, so that the next check begins as in the saved game
+		file->rdwr_bool(private_car_routes_up_to_date);
+		file->rdwr_long(last_private_car_route_full_refresh);
+	}
+
 	// MUST be at the end of the load/save routine.
 	// save all open windows (upon request)
 	file->rdwr_byte( active_player_nr );
@@ -9058,7 +9552,7 @@ bool karte_t::load(const char *filename)
 	mute_sound(true);
 	display_show_load_pointer(true);
 	loadsave_t file;
-	time_interval_signals_to_check.clear();
+	time_interval_timers.clear();
 
 	// clear hash table with missing paks (may cause some small memory loss though)
 	missing_pak_names.clear();
@@ -9358,11 +9852,22 @@ void karte_t::clear_checklist_debug_sums()
 	}
 }
 
+void karte_t::clear_checklist_world_hashes()
+{
+	for(  int i = 0;  i < CHK_WORLD_HASHES  ;  i++  ) {
+		world_hashes[i] = 0;
+	}
+	for(  int i = 0;  i < CHK_REGIONS  ;  i++  ) {
+		region_hashes[i] = 0;
+	}
+}
+
 void karte_t::clear_all_checklists()
 {
 	clear_checklist_history();
 	clear_checklist_rands();
 	clear_checklist_debug_sums();
+	clear_checklist_world_hashes();
 }
 
 void karte_t::load(loadsave_t *file)
@@ -9561,6 +10066,8 @@ void karte_t::load(loadsave_t *file)
 	current_month = last_month + (last_year*12);
 	season = (2+last_month/3)&3; // summer always zero
 	next_month_ticks = ( (ticks >> karte_t::ticks_per_world_month_shift) + 1 ) << karte_t::ticks_per_world_month_shift;
+	// older games applied the wear of the last month when this month began, so this month's is still due
+	way_wear_row = 0;
 	last_step_ticks = ticks;
 	network_frame_count = 0;
 	sync_steps = 0;
@@ -10191,10 +10698,7 @@ DBG_MESSAGE("karte_t::load()", "%d factories loaded", fab_list.get_count());
 		}
 	}
 
-	if (file->get_extended_version() >= 15 || (file->get_extended_version() == 14 && file->get_extended_revision() >= 20))
-	{
-		file->rdwr_long(weg_t::private_car_routes_currently_reading_element);
-	}
+	private_car_routes_t::rdwr(file);
 
 	// Either reload the path explorer data or refresh the routing.
 	bool path_explorer_data_saved = false;
@@ -10210,6 +10714,7 @@ DBG_MESSAGE("karte_t::load()", "%d factories loaded", fab_list.get_count());
 	}
 
 	path_explorer_t::reset_must_refresh_on_loading();
+	route_landmarks_t::reset();
 
 	cities_awaiting_private_car_route_check.clear();
 	if (file->get_extended_version() >= 15 || (file->get_extended_version() == 14 && file->get_extended_revision() >= 35))
@@ -10228,6 +10733,23 @@ DBG_MESSAGE("karte_t::load()", "%d factories loaded", fab_list.get_count());
 		file->rdwr_long(cities_to_process);
 	}
 
+	clear_checklist_world_hashes();
+	if(  file->is_version_ex_atleast(14, 44)  ) {
+		for(  uint8 i = 0;  i < CHK_WORLD_HASHES;  i++  ) {
+			file->rdwr_long(world_hashes[i]);
+		}
+		for(  uint8 i = 0;  i < CHK_REGIONS;  i++  ) {
+			file->rdwr_long(region_hashes[i]);
+		}
+	}
+
+	if(  file->is_version_ex_atleast(14, 45)  ) {
+		file->rdwr_long(way_wear_row);
+		// the state of the private car route checks, so that the next check begins as in the saved game
+		file->rdwr_bool(private_car_routes_up_to_date);
+		file->rdwr_long(last_private_car_route_full_refresh);
+	}
+
 	// MUST be at the end of the load/save routine.
 	if(  file->is_version_atleast(102, 4)  ) {
 		if(  env_t::restore_UI  ) {
@@ -11010,6 +11532,22 @@ void karte_t::command_queue_append(network_world_command_t* nwc) const
 }
 
 
+void karte_t::command_queue_send_to(socket_info_t &client) const
+{
+	FOR(slist_tpl<network_world_command_t*>, const nwc, command_queue) {
+		client.send_queue_append(nwc->copy_packet());
+	}
+}
+
+
+void karte_t::command_queue_detach(slist_tpl<network_world_command_t*> &commands) const
+{
+	while (!command_queue.empty()) {
+		commands.append(command_queue.remove_first());
+	}
+}
+
+
 void karte_t::clear_command_queue() const
 {
 	while (!command_queue.empty()) {
@@ -11122,9 +11660,10 @@ void karte_t::process_network_commands(sint32 *ms_difference)
 				// out of sync => drop client (but we can only compare if nwt->last_sync_step is not too old)
 				else if(  is_checklist_available(nwt->last_sync_step)  &&  LCHKLST(nwt->last_sync_step)!=nwt->last_checklist  ) {
 					// lost synchronisation -> server kicks client out actively
-					char buf[2048];
-					const int offset = LCHKLST(nwt->last_sync_step).print(buf, "server");
-					nwt->last_checklist.print(buf + offset, "initiator");
+					char buf[4096];
+					int offset = LCHKLST(nwt->last_sync_step).print(buf, "server");
+					offset += nwt->last_checklist.print(buf + offset, "initiator");
+					LCHKLST(nwt->last_sync_step).print_divergence(buf + offset, nwt->last_checklist);
 					dbg->warning("karte_t::process_network_commands", "kicking client due to checklist mismatch : sync_step=%u %s", nwt->last_sync_step, buf);
 					socket_list_t::remove_client( nwc->get_sender() );
 					delete nwc;
@@ -11152,8 +11691,7 @@ void karte_t::process_network_commands(sint32 *ms_difference)
 	}
 
 	// send data
-	ms = dr_time();
-	network_process_send_queues( next_step_time>ms ? min( next_step_time-ms, 5) : 0 );
+	network_process_send_queues();
 
 	// process enqueued network world commands
 	while(  !command_queue.empty()  &&  (next_command_step<=sync_steps/*  ||  step_mode&PAUSE_FLAG*/)  ) {
@@ -11186,17 +11724,17 @@ void karte_t::do_network_world_command(network_world_command_t *nwc)
 		const checklist_t &server_checklist = nwcheck->server_checklist;
 		const uint32 server_sync_step = nwcheck->server_sync_step;
 		const checklist_t client_checklist = LCHKLST(server_sync_step);
-		char buf[2048];
+		char buf[4096];
 
 		const int offset = server_checklist.print(buf, "server");
-		assert(offset < 2048);
+		assert(offset < 4096);
 
 		const int offset2 = offset + client_checklist.print(buf + offset, "client");
-		assert(offset2 < 2048);
-		(void)offset2;
+		assert(offset2 < 4096);
 
 		if(client_checklist != server_checklist)
 		{
+			server_checklist.print_divergence(buf + offset2, client_checklist);
 			dbg->warning("karte_t:::do_network_world_command", "disconnecting due to checklist mismatch:\n%s", buf );
 			network_disconnect();
 		} else {
@@ -11208,12 +11746,12 @@ void karte_t::do_network_world_command(network_world_command_t *nwc)
 			nwc_tool_t *nwt = dynamic_cast<nwc_tool_t *>(nwc);
 			if(  is_checklist_available(nwt->last_sync_step)  &&  LCHKLST(nwt->last_sync_step)!=nwt->last_checklist  ) {
 				// lost synchronisation ...
-				char buf[2048];
+				char buf[4096];
 				const int offset = nwt->last_checklist.print(buf, "server");
-				assert(offset < 2048);
+				assert(offset < 4096);
 				const int offset2 = offset + LCHKLST(nwt->last_sync_step).print(buf + offset, "executor");
-				assert(offset2 < 2048);
-				(void)offset2;
+				assert(offset2 < 4096);
+				nwt->last_checklist.print_divergence(buf + offset2, LCHKLST(nwt->last_sync_step));
 
 				dbg->warning("karte_t:::do_network_world_command", "skipping command due to checklist mismatch : sync_step=%u %s", nwt->last_sync_step, buf);
 				if(  !env_t::server  ) {
@@ -11402,7 +11940,7 @@ bool karte_t::interactive(uint32 quit_month)
 					}
 					sync_steps = steps * settings.get_frames_per_step() + network_frame_count;
 					LCHKLST(sync_steps) = checklist_t(sync_steps, (uint32)steps, network_frame_count, get_random_seed(), halthandle_t::get_next_check(), linehandle_t::get_next_check(), convoihandle_t::get_next_check(),
-						rands, debug_sums
+						rands, debug_sums, world_hashes, region_hashes
 					);
 
 #ifdef DEBUG_SIMRAND_CALLS
@@ -11893,9 +12431,8 @@ void karte_t::update_weight_of_building_in_world_list(gebaeude_t *gb)
 		return;
 	}
 
-	if(passenger_origins.is_contained(gb))
+	if(passenger_origins.update(gb, gb->get_adjusted_population()))
 	{
-		passenger_origins.update_at(passenger_origins.index_of(gb), gb->get_adjusted_population());
 		passenger_step_interval = calc_adjusted_step_interval(passenger_origins.get_sum_weight(), get_settings().get_passenger_trips_per_month_hundredths());
 	}
 
@@ -11903,24 +12440,23 @@ void karte_t::update_weight_of_building_in_world_list(gebaeude_t *gb)
 	{
 		if (commuter_targets[i].is_contained(gb))
 		{
-			commuter_targets[i].update_at(commuter_targets[i].index_of(gb), (gb->get_tile()->get_desc()->get_class_proportions_sum_jobs() > 0 ? (gb->get_adjusted_jobs() * gb->get_tile()->get_desc()->get_class_proportion_jobs(i)) / gb->get_tile()->get_desc()->get_class_proportions_sum_jobs() : gb->get_adjusted_jobs()));
+			commuter_targets[i].update(gb, (gb->get_tile()->get_desc()->get_class_proportions_sum_jobs() > 0 ? (gb->get_adjusted_jobs() * gb->get_tile()->get_desc()->get_class_proportion_jobs(i)) / gb->get_tile()->get_desc()->get_class_proportions_sum_jobs() : gb->get_adjusted_jobs()));
 		}
 
 		if (visitor_targets[i].is_contained(gb))
 		{
-			visitor_targets[i].update_at(visitor_targets[i].index_of(gb), (gb->get_tile()->get_desc()->get_class_proportions_sum() > 0 ? (gb->get_adjusted_visitor_demand() * gb->get_tile()->get_desc()->get_class_proportion(i)) / gb->get_tile()->get_desc()->get_class_proportions_sum() : gb->get_adjusted_visitor_demand()));
+			visitor_targets[i].update(gb, (gb->get_tile()->get_desc()->get_class_proportions_sum() > 0 ? (gb->get_adjusted_visitor_demand() * gb->get_tile()->get_desc()->get_class_proportion(i)) / gb->get_tile()->get_desc()->get_class_proportions_sum() : gb->get_adjusted_visitor_demand()));
 		}
 	}
-	if(mail_origins_and_targets.is_contained(gb))
+	if(mail_origins_and_targets.update(gb, gb->get_adjusted_mail_demand()))
 	{
-		mail_origins_and_targets.update_at(mail_origins_and_targets.index_of(gb), gb->get_adjusted_mail_demand());
 		mail_step_interval = calc_adjusted_step_interval(mail_origins_and_targets.get_sum_weight(), get_settings().get_mail_packets_per_month_hundredths());
 	}
 }
 
 void karte_t::remove_all_building_references_to_city(stadt_t* city)
 {
-	FOR(weighted_vector_tpl <gebaeude_t *>, building, passenger_origins)
+	FOR(fenwick_weighted_vector_tpl <gebaeude_t *>, building, passenger_origins)
 	{
 		if(building->get_stadt() == city)
 		{
@@ -11928,7 +12464,7 @@ void karte_t::remove_all_building_references_to_city(stadt_t* city)
 		}
 	}
 
-	FOR(weighted_vector_tpl <gebaeude_t *>, building, mail_origins_and_targets)
+	FOR(fenwick_weighted_vector_tpl <gebaeude_t *>, building, mail_origins_and_targets)
 	{
 		if(building->get_stadt() == city)
 		{
@@ -11938,7 +12474,7 @@ void karte_t::remove_all_building_references_to_city(stadt_t* city)
 
 	for (uint8 i = 0; i < goods_manager_t::passengers->get_number_of_classes(); i++)
 	{
-		FOR(weighted_vector_tpl <gebaeude_t *>, building, commuter_targets[i])
+		FOR(fenwick_weighted_vector_tpl <gebaeude_t *>, building, commuter_targets[i])
 		{
 			if (building->get_stadt() == city)
 			{
@@ -11946,7 +12482,7 @@ void karte_t::remove_all_building_references_to_city(stadt_t* city)
 			}
 		}
 
-		FOR(weighted_vector_tpl <gebaeude_t *>, building, visitor_targets[i])
+		FOR(fenwick_weighted_vector_tpl <gebaeude_t *>, building, visitor_targets[i])
 		{
 			if (building->get_stadt() == city)
 			{
@@ -15,6 +15,7 @@
 #include "halthandle_t.h"
 
 #include "tpl/weighted_vector_tpl.h"
+#include "tpl/fenwick_weighted_vector_tpl.h"
 #include "tpl/vector_tpl.h"
 #include "tpl/slist_tpl.h"
 #include "tpl/koordhashtable_tpl.h"
@@ -56,12 +57,18 @@ class message_t;
 class way_desc_t;
 class tunnel_desc_t;
 class network_world_command_t;
+class socket_info_t;
 class goods_desc_t;
 class memory_rw_t;
 class viewport_t;
 
 #define CHK_RANDS 32
 #define CHK_DEBUG_SUMS 10
+// digests of ways, halts, convoys, factories and cities, see karte_t::step_world_hashes()
+#define CHK_WORLD_HASHES 5
+// the same digests by map region, in a square grid of regions
+#define CHK_REGIONS_PER_AXIS 4
+#define CHK_REGIONS (CHK_REGIONS_PER_AXIS * CHK_REGIONS_PER_AXIS)
 
 #ifdef MULTI_THREAD
 //#define FORBID_MULTI_THREAD_PASSENGER_GENERATION_IN_NETWORK_MODE
@@ -108,9 +115,11 @@ struct checklist_t
 
 	uint32 rand[CHK_RANDS];
 	uint32 debug_sum[CHK_DEBUG_SUMS];
+	uint32 world_hash[CHK_WORLD_HASHES];
+	uint32 region_hash[CHK_REGIONS];
 
 
-	checklist_t(uint32 _ss, uint32 _st, uint8 _nfc, uint32 _random_seed, uint16 _halt_entry, uint16 _line_entry, uint16 _convoy_entry, uint32 *_rands, uint32 *_debug_sums);
+	checklist_t(uint32 _ss, uint32 _st, uint8 _nfc, uint32 _random_seed, uint16 _halt_entry, uint16 _line_entry, uint16 _convoy_entry, uint32 *_rands, uint32 *_debug_sums, uint32 *_world_hashes, uint32 *_region_hashes);
 	checklist_t() : ss(0), st(0), nfc(0), random_seed(0), halt_entry(0), line_entry(0), convoy_entry(0)
 	{
 		for(  uint8 i = 0;  i < CHK_RANDS;  i++  ) {
@@ -119,6 +128,12 @@ struct checklist_t
 		for(  uint8 i = 0;  i < CHK_DEBUG_SUMS;  i++  ) {
 			debug_sum[i] = 0;
 		}
+		for(  uint8 i = 0;  i < CHK_WORLD_HASHES;  i++  ) {
+			world_hash[i] = 0;
+		}
+		for(  uint8 i = 0;  i < CHK_REGIONS;  i++  ) {
+			region_hash[i] = 0;
+		}
 	}
 
 	bool operator == (const checklist_t &other) const
@@ -133,8 +148,16 @@ struct checklist_t
 			// debugs_equal = debugs_equal  &&  (debug_sum[i] == 0  ||  other.debug_sum[i] == 0  ||  debug_sum[i] == other.debug_sum[i]);
 			debugs_equal = debugs_equal  &&  debug_sum[i] == other.debug_sum[i];
 		}
+		bool hashes_equal = true;
+		for(  uint8 i = 0;  i < CHK_WORLD_HASHES  &&  hashes_equal;  i++  ) {
+			hashes_equal = world_hash[i] == other.world_hash[i];
+		}
+		for(  uint8 i = 0;  i < CHK_REGIONS  &&  hashes_equal;  i++  ) {
+			hashes_equal = region_hash[i] == other.region_hash[i];
+		}
 		return ( rands_equal &&
 			debugs_equal &&
+			hashes_equal &&
 			ss == other.ss &&
 			st == other.st &&
 			nfc == other.nfc &&
@@ -148,6 +171,9 @@ struct checklist_t
 
 	void rdwr(memory_rw_t *buffer);
 	int print(char *buffer, const char *entity) const;
+
+	/// Prints which of the world hashes and regions differ from @p other, to locate a desync
+	int print_divergence(char *buffer, const checklist_t &other) const;
 };
 
 // Private car ownership information.
@@ -626,6 +652,17 @@ private:
 #define LCHKLST(x) (last_checklists[(x) % LAST_CHECKLISTS_COUNT])
 	uint32 rands[CHK_RANDS];
 	uint32 debug_sums[CHK_DEBUG_SUMS];
+	uint32 world_hashes[CHK_WORLD_HASHES];
+	uint32 region_hashes[CHK_REGIONS];
+
+	/**
+	 * Digests the state of a slice of each of the lists of ways, halts, convoys, factories and
+	 * cities into world_hashes and region_hashes, which go into the checklists. The slices move
+	 * on with each step, so that a desync is found soon after it happens, and the differing
+	 * hashes tell in which kind of object and in which part of the map.
+	 */
+	void step_world_hashes();
+	void add_to_world_hash(uint8 subsystem, koord pos, uint32 digest);
 
 
 	/// @note variable used in interactive()
@@ -766,6 +803,29 @@ private:
 	 */
 	void new_month();
 
+	/**
+	 * The wear of each month is applied to the ways over the first steps of
+	 * that month, row by row of the map tiles, so that each way is worn once
+	 * and the costs of renewing ways are booked in that month. The order does
+	 * not depend upon that of the list of all ways, which changes on loading.
+	 * It is not spread further than this many steps.
+	 */
+	static const uint32 way_wear_steps = 64;
+
+	/// The next row of tiles whose ways are to be worn this month.
+	uint32 way_wear_row;
+
+	/// Applies the monthly wear to the ways of the next share of the rows, or of all remaining rows.
+	void wear_ways(bool all);
+
+	/**
+	 * Calls @p task with @p context for slices of [0, @p count) on the world's
+	 * worker threads and waits for all of them. The task must only change the
+	 * objects of its own slice, so that the result does not depend on the
+	 * number of threads.
+	 */
+	void run_parallel(void (*task)(const void *context, uint32 begin, uint32 end), const void *context, uint32 count);
+
 	/**
 	 * Yearly actions.
 	 */
@@ -877,7 +937,7 @@ private:
 	 * journeys ultimately start, weighted by their level.
 	 * @author: jamespetts
 	 */
-	weighted_vector_tpl <gebaeude_t *> passenger_origins;
+	fenwick_weighted_vector_tpl <gebaeude_t *> passenger_origins;
 
 	/**
 	 * This contains all buildings in the world to which passengers make
@@ -885,7 +945,7 @@ private:
 	 * This is an array indexed by class.
 	 * @author: jamespetts
 	 */
-	weighted_vector_tpl <gebaeude_t *> *commuter_targets;
+	fenwick_weighted_vector_tpl <gebaeude_t *> *commuter_targets;
 
 	/**
 	 * This contains all buildings in the world to which passengers make
@@ -893,7 +953,7 @@ private:
 	 * This is an array indexed by class.
 	 * @author: jamespetts
 	 */
-	weighted_vector_tpl <gebaeude_t *> *visitor_targets;
+	fenwick_weighted_vector_tpl <gebaeude_t *> *visitor_targets;
 
 	/**
 	 * This contains all buildings in the world to and from which mail
@@ -901,7 +961,7 @@ private:
 	 * level.
 	 * @author: jamespetts
 	 */
-	weighted_vector_tpl <gebaeude_t *> mail_origins_and_targets;
+	fenwick_weighted_vector_tpl <gebaeude_t *> mail_origins_and_targets;
 
 	/** Stores the value of the next step for passenger/mail generation
 	 * purposes.
@@ -913,9 +973,25 @@ private:
 	sint32 mail_step_interval;
 
 	// Signals in the time interval working method that need
-	// to be checked periodically to see whether they need
-	// to change to a less restrictive aspect.
-	vector_tpl<signal_t*> time_interval_signals_to_check;
+	// to be checked to see whether they need to change to a
+	// less restrictive aspect. This is a heap of the ticks at
+	// which each signal may next change, so that only those
+	// signals are checked whose time has come.
+	struct time_interval_timer_t
+	{
+		sint64 due;
+		signal_t *sig;
+
+		// The earliest timer is at the top of the heap.
+		bool operator<(const time_interval_timer_t &other) const { return due > other.due; }
+	};
+	vector_tpl<time_interval_timer_t> time_interval_timers;
+
+	// The intervals from which the timers were calculated
+	sint64 time_interval_caution_ticks;
+	sint64 time_interval_clear_ticks;
+
+	void set_time_interval_timer(signal_t *sig, sint64 due);
 
 	// Do not repeat sounds from the same types of vehicles
 	// too often, so store the time when the next sound from
@@ -946,6 +1022,12 @@ private:
 	/// To prevent pause_step constantly re-checking the private car routes when not necessary.
 	bool private_car_route_check_complete = false;
 
+	/// Whether the private car routes are not being checked, because no roads have changed since the last check.
+	bool private_car_routes_up_to_date = false;
+
+	/// The month of the last full refresh of the private car routes, or -1 if there has been none, or none since loading an older game.
+	sint32 last_private_car_route_full_refresh = -1;
+
 #ifdef MULTI_THREAD
 	bool passengers_and_mail_threads_working;
 	bool convoy_threads_working;
@@ -1004,6 +1086,7 @@ private:
 #ifdef MULTI_THREAD
 	friend void *check_road_connexions_threaded(void* args);
 	friend void *unreserve_route_threaded(void* args);
+	friend void *run_parallel_threaded(void* args);
 	friend void *step_passengers_and_mail_threaded(void* args);
 	friend void *step_convoys_threaded(void* args);
 	friend void *path_explorer_threaded(void* args);
@@ -2559,8 +2642,9 @@ public:
 	/**
 	 * Saves the map to a file.
 	 * @param Filename name of the file to write.
+	 * @param background if true, the map is only copied into memory, and then compressed and written on a background thread.
 	 */
-	void save(const char *filename, bool autosave, const char *version, const char *ex_version, const char* ex_revision, bool silent);
+	void save(const char *filename, bool autosave, const char *version, const char *ex_version, const char* ex_revision, bool silent, bool background = false);
 
 	/**
 	 * Loads a map from a file.
@@ -2603,11 +2687,18 @@ public:
 
 	void clear_checklist_history();
 	void clear_checklist_debug_sums();
+	void clear_checklist_world_hashes();
 	void clear_checklist_rands();
 	void clear_all_checklists();
 
 	void command_queue_append(network_world_command_t*) const;
 
+	/// Server: queues the commands which are still to be executed for @p client, which joined by a snapshot.
+	void command_queue_send_to(socket_info_t &client) const;
+
+	/// Moves the commands still to be executed to @p commands, so that they survive reloading the game.
+	void command_queue_detach(slist_tpl<network_world_command_t*> &commands) const;
+
 	void clear_command_queue() const;
 
 	void network_disconnect();
@@ -2692,8 +2783,11 @@ public:
 	double get_forge_cost(waytype_t waytype, koord3d position);
 	bool is_forge_cost_reduced(waytype_t waytype, koord3d position);
 
-	inline void add_time_interval_signal_to_check(signal_t* sig) { time_interval_signals_to_check.append_unique(sig); }
-	inline bool remove_time_interval_signal_to_check(signal_t* sig) { return time_interval_signals_to_check.remove(sig); }
+	void add_time_interval_signal_to_check(signal_t* sig);
+	bool remove_time_interval_signal_to_check(signal_t* sig);
+
+	/// Checks @p sig at the next step_time_interval_signals(), if it is waiting for its timer
+	void recheck_time_interval_signal(signal_t* sig);
 
 	void calc_max_vehicle_speeds();
 
@@ -2709,9 +2803,12 @@ private:
 
 	void get_nearby_halts_of_tiles(const minivec_tpl<const planquadrat_t*> &tile_list, const goods_desc_t * wtyp, vector_tpl<nearby_halt_t> &halts) const;
 
-	void refresh_private_car_routes();
-
-	static void clear_private_car_routes() ;
+	/**
+	 * Completes the check of the private car routes which has just finished, and begins the next one:
+	 * either a full refresh, or a check of the cities affected by roads changed since the last one.
+	 * @returns false if there was nothing to do.
+	 */
+	bool refresh_private_car_routes();
 };
 
 
@@ -0,0 +1,514 @@
+/*
+ * This file is part of the Simutrans-Extended project under the Artistic License.
+ * (see LICENSE.txt)
+ */
+
+#ifndef TPL_FENWICK_WEIGHTED_VECTOR_TPL_H
+#define TPL_FENWICK_WEIGHTED_VECTOR_TPL_H
+
+
+#include <cstddef>
+#include <iterator>
+
+#include "../simdebug.h"
+#include "../simtypes.h"
+#include "ptrhashtable_tpl.h"
+
+
+/**
+ * A weighted vector like weighted_vector_tpl for large and often changing sets,
+ * such as the buildings from which passengers and mail are generated.
+ *
+ * The weights are kept in a Fenwick (binary indexed) tree over the slots, and
+ * each element is found by a hash map from the element to its slot. Thus
+ * append(), remove(), update() and at_weight() take O(log n) instead of O(n).
+ *
+ * Removed elements leave an empty slot behind, so that the order of the other
+ * elements does not change; the slots are compacted when more than half of them
+ * are empty. at_weight() therefore picks the same element as weighted_vector_tpl
+ * would after the same sequence of operations.
+ *
+ * The elements are hashed with ptrhash_tpl, so T must be a pointer or integer type.
+ * There is no access by position, as positions are not stable.
+ */
+template<class T> class fenwick_weighted_vector_tpl
+{
+	private:
+		enum {
+			NO_SLOT   = 0xFFFFFFFFu, ///< End of a chain of equal elements, or an unused bucket
+			DEAD_SLOT = 0xFFFFFFFEu  ///< Marks a slot whose element has been removed
+		};
+
+		struct nodestruct
+		{
+			T data;
+			uint32 weight;
+			uint32 next_same; ///< Next slot holding the same element, NO_SLOT or DEAD_SLOT
+		};
+
+		struct bucketstruct
+		{
+			T key;
+			uint32 slot; ///< First slot holding key, or NO_SLOT if the bucket is unused
+		};
+
+	public:
+		class const_iterator;
+
+		class iterator
+		{
+			public:
+				typedef std::forward_iterator_tag iterator_category;
+				typedef std::ptrdiff_t            difference_type;
+				typedef T const*                  pointer;
+				typedef T const&                  reference;
+				typedef T                         value_type;
+
+				T& operator *() const { return ptr->data; }
+
+				iterator& operator ++() { ++ptr; skip_dead(); return *this; }
+
+				bool operator !=(const iterator& o) { return ptr != o.ptr; }
+
+			private:
+				iterator(nodestruct* ptr_, nodestruct* end_) : ptr(ptr_), end(end_) { skip_dead(); }
+
+				void skip_dead() { while(  ptr != end  &&  ptr->next_same == DEAD_SLOT  ) { ++ptr; } }
+
+				nodestruct* ptr;
+				nodestruct* end;
+
+			friend class fenwick_weighted_vector_tpl;
+			friend class const_iterator;
+		};
+
+		class const_iterator
+		{
+			public:
+				typedef std::forward_iterator_tag iterator_category;
+				typedef std::ptrdiff_t            difference_type;
+				typedef T const*                  pointer;
+				typedef T const&                  reference;
+				typedef T                         value_type;
+
+				const_iterator(const iterator& o) : ptr(o.ptr), end(o.end) {}
+
+				const T& operator *() const { return ptr->data; }
+
+				const_iterator& operator ++() { ++ptr; skip_dead(); return *this; }
+
+				bool operator !=(const const_iterator& o) { return ptr != o.ptr; }
+
+			private:
+				const_iterator(const nodestruct* ptr_, const nodestruct* end_) : ptr(ptr_), end(end_) { skip_dead(); }
+
+				void skip_dead() { while(  ptr != end  &&  ptr->next_same == DEAD_SLOT  ) { ++ptr; } }
+
+				const nodestruct* ptr;
+				const nodestruct* end;
+
+			friend class fenwick_weighted_vector_tpl;
+		};
+
+		fenwick_weighted_vector_tpl() :
+			nodes(NULL), tree(NULL), size(0), used(0), count(0), total_weight(0),
+			buckets(NULL), bucket_bits(0), bucket_count(0) {}
+
+		~fenwick_weighted_vector_tpl()
+		{
+			delete [] nodes;
+			delete [] tree;
+			delete [] buckets;
+		}
+
+		/** sets the vector to empty */
+		void clear()
+		{
+			used = 0;
+			count = 0;
+			total_weight = 0;
+			clear_buckets();
+		}
+
+		/** Checks if element elem is contained in vector. */
+		bool is_contained(T elem) const
+		{
+			return first_slot(elem) != NO_SLOT;
+		}
+
+		/**
+		 * Appends the element at the end of the vector.
+		 * Extend if necessary.
+		 */
+		bool append(T elem, uint32 weight)
+		{
+#ifdef IGNORE_ZERO_WEIGHT
+			if (weight == 0) {
+				// ignore unused entries ...
+				return false;
+			}
+#endif
+			if(  used == size  ) {
+				if(  count <= size / 2  &&  size > 0  ) {
+					compact();
+				}
+				else {
+					resize(size == 0 ? 16 : size * 2);
+				}
+			}
+			const uint32 slot = used++;
+			nodes[slot].data      = elem;
+			nodes[slot].weight    = weight;
+			nodes[slot].next_same = NO_SLOT;
+
+			// a new last node of the tree covers the new slot and its children
+			const uint32 i = slot + 1;
+			tree[i] = weight;
+			for(  uint32 child = 1;  child < (i & (0 - i));  child <<= 1  ) {
+				tree[i] += tree[i - child];
+			}
+			count++;
+			total_weight += weight;
+
+			link_slot(elem, slot);
+			return true;
+		}
+
+		/**
+		 * Insert `elem' with respect to ordering.
+		 * Unlike append(), this takes O(n), as all following elements move.
+		 */
+		template<class StrictWeakOrdering>
+		void insert_ordered(const T& elem, uint32 weight, StrictWeakOrdering comp)
+		{
+#ifdef IGNORE_ZERO_WEIGHT
+			if (weight == 0) {
+				return;
+			}
+#endif
+			compact();
+			if(  used == size  ) {
+				resize(size == 0 ? 16 : size * 2);
+			}
+			sint32 high = used, low = -1;
+			while(  high-low>1  ) {
+				const sint32 mid = ((uint32)(high + low)) >> 1;
+				if(  comp(elem, nodes[mid].data)  ) {
+					high = mid;
+				}
+				else {
+					low = mid;
+				}
+			}
+			for(  uint32 i = used;  i > (uint32)high;  i--  ) {
+				nodes[i] = nodes[i - 1];
+			}
+			nodes[high].data   = elem;
+			nodes[high].weight = weight;
+			used++;
+			count++;
+			total_weight += weight;
+			rebuild();
+		}
+
+		/**
+		 * Update the weight of the element, if contained.
+		 * If it is contained more than once, the first copy is updated.
+		 */
+		bool update(T elem, uint32 weight)
+		{
+			const uint32 slot = first_slot(elem);
+			if(  slot == NO_SLOT  ) {
+				return false;
+			}
+			add_weight(slot, weight - nodes[slot].weight);
+			total_weight += weight - nodes[slot].weight;
+			nodes[slot].weight = weight;
+			return true;
+		}
+
+		/** removes the first copy of element, if contained */
+		bool remove(T elem)
+		{
+			const uint32 slot = first_slot(elem);
+			if(  slot == NO_SLOT  ) {
+				return false;
+			}
+			remove_slot(slot);
+			return true;
+		}
+
+		/** removes all copies of element, if contained */
+		bool remove_all(T elem)
+		{
+			if(  !remove(elem)  ) {
+				return false;
+			}
+			while(  remove(elem)  ) {}
+			return true;
+		}
+
+		/**
+		 * Accesses the element by weight: the element whose range of weights, counted
+		 * from the first element, contains target_weight.
+		 */
+		const T& at_weight(const uint32 target_weight) const
+		{
+			if (target_weight > total_weight) {
+				dbg->fatal("fenwick_weighted_vector_tpl<T>::at_weight()", "weight out of bounds: %i not in 0..%d", target_weight, total_weight);
+			}
+			if(  count == 0  ) {
+				static const T none = T();
+				return none;
+			}
+
+			// descend the tree to the last slot before the one containing target_weight
+			uint32 pos = 0;
+			uint32 remaining = target_weight;
+			uint32 step = 1;
+			while(  step <= used / 2  ) {
+				step <<= 1;
+			}
+			for(  ;  step > 0;  step >>= 1  ) {
+				if(  pos + step <= used  &&  tree[pos + step] <= remaining  ) {
+					pos += step;
+					remaining -= tree[pos];
+				}
+			}
+
+			if(  pos >= used  ) {
+				// target_weight==total_weight: the last element, as in weighted_vector_tpl
+				pos = used - 1;
+				while(  nodes[pos].next_same == DEAD_SLOT  ) {
+					pos--;
+				}
+			}
+			return nodes[pos].data;
+		}
+
+		/** Gets the number of elements in the vector */
+		uint32 get_count() const { return count; }
+
+		/** Gets the total weight */
+		uint32 get_sum_weight() const { return total_weight; }
+
+		bool empty() const { return count == 0; }
+
+		iterator begin() { return iterator(nodes, nodes + used); }
+		iterator end()   { return iterator(nodes + used, nodes + used); }
+
+		const_iterator begin() const { return const_iterator(nodes, nodes + used); }
+		const_iterator end()   const { return const_iterator(nodes + used, nodes + used); }
+
+	private:
+		nodestruct* nodes;
+		uint32* tree;                 ///< Fenwick tree of the weights, indexed by slot + 1
+		uint32 size;                  ///< Capacity
+		uint32 used;                  ///< Number of slots in use, including removed elements
+		uint32 count;                 ///< Number of elements in vector
+		uint32 total_weight;          ///< Sum of all weights
+
+		bucketstruct* buckets;        ///< Open addressing hash map from element to its first slot
+		uint8 bucket_bits;
+		uint32 bucket_count;          ///< Number of distinct elements in the map
+
+		fenwick_weighted_vector_tpl(const fenwick_weighted_vector_tpl& other);
+
+		fenwick_weighted_vector_tpl& operator=( fenwick_weighted_vector_tpl const& other );
+
+		/// Adds delta (modulo 2^32, so it may be "negative") to the weight of the slot in the tree
+		void add_weight(uint32 slot, uint32 delta)
+		{
+			for(  uint32 i = slot + 1;  i <= used;  i += i & (0 - i)  ) {
+				tree[i] += delta;
+			}
+		}
+
+		void remove_slot(uint32 slot)
+		{
+			unlink_slot(nodes[slot].data, slot);
+			add_weight(slot, 0 - nodes[slot].weight);
+			total_weight -= nodes[slot].weight;
+			nodes[slot].weight = 0;
+			nodes[slot].next_same = DEAD_SLOT;
+			count--;
+			if(  count == 0  ) {
+				used = 0;
+			}
+			else if(  used - count > used / 2  &&  used > 64  ) {
+				compact();
+			}
+		}
+
+		void resize(uint32 new_size)
+		{
+			nodestruct* new_nodes = new nodestruct[new_size];
+			for (uint32 i = 0; i < used; i++) new_nodes[i] = nodes[i];
+			delete [] nodes;
+			nodes = new_nodes;
+
+			uint32* new_tree = new uint32[new_size + 1];
+			for (uint32 i = 0; i <= used; i++) new_tree[i] = tree ? tree[i] : 0;
+			delete [] tree;
+			tree = new_tree;
+
+			size = new_size;
+		}
+
+		/// Removes the empty slots, keeping the order of the elements
+		void compact()
+		{
+			if(  used == count  ) {
+				return;
+			}
+			uint32 to = 0;
+			for(  uint32 from = 0;  from < used;  from++  ) {
+				if(  nodes[from].next_same != DEAD_SLOT  ) {
+					nodes[to++] = nodes[from];
+				}
+			}
+			used = to;
+			rebuild();
+		}
+
+		/// Rebuilds the tree and the map after the slots have moved, in O(n)
+		void rebuild()
+		{
+			tree[0] = 0;
+			for(  uint32 i = 1;  i <= used;  i++  ) {
+				tree[i] = nodes[i - 1].weight;
+			}
+			for(  uint32 i = 1;  i <= used;  i++  ) {
+				const uint32 parent = i + (i & (0 - i));
+				if(  parent <= used  ) {
+					tree[parent] += tree[i];
+				}
+			}
+
+			clear_buckets();
+			// backwards, so that the chains of equal elements are in slot order
+			for(  uint32 slot = used;  slot-- > 0;  ) {
+				const uint32 first = first_slot(nodes[slot].data);
+				nodes[slot].next_same = first;
+				if(  first == NO_SLOT  ) {
+					insert_bucket(nodes[slot].data, slot);
+				}
+				else {
+					find_bucket(nodes[slot].data)->slot = slot;
+				}
+			}
+		}
+
+		uint32 get_bucket_index(T key) const
+		{
+			// Fibonacci hashing, as pointers are aligned and their low bits are always zero
+			return (uint32)(ptrhash_tpl<T>::hash(key) * 2654435769u) >> (32 - bucket_bits);
+		}
+
+		/// @returns the bucket of key, or the unused bucket where it would go. There must be a map.
+		bucketstruct* find_bucket(T key) const
+		{
+			const uint32 mask = (1u << bucket_bits) - 1;
+			uint32 i = get_bucket_index(key);
+			while(  buckets[i].slot != NO_SLOT  &&  !(buckets[i].key == key)  ) {
+				i = (i + 1) & mask;
+			}
+			return buckets + i;
+		}
+
+		uint32 first_slot(T key) const
+		{
+			return buckets ? find_bucket(key)->slot : (uint32)NO_SLOT;
+		}
+
+		void clear_buckets()
+		{
+			for(  uint32 i = 0;  buckets  &&  i < (1u << bucket_bits);  i++  ) {
+				buckets[i].slot = NO_SLOT;
+			}
+			bucket_count = 0;
+		}
+
+		void insert_bucket(T key, uint32 slot)
+		{
+			// keep the map at most half full
+			if(  buckets == NULL  ||  (bucket_count + 1) * 2 > (1u << bucket_bits)  ) {
+				bucketstruct* old_buckets = buckets;
+				const uint32 old_buckets_size = buckets ? (1u << bucket_bits) : 0;
+				bucket_bits = buckets ? bucket_bits + 1 : 5;
+				buckets = new bucketstruct[1u << bucket_bits];
+				clear_buckets();
+				for(  uint32 i = 0;  i < old_buckets_size;  i++  ) {
+					if(  old_buckets[i].slot != NO_SLOT  ) {
+						*find_bucket(old_buckets[i].key) = old_buckets[i];
+						bucket_count++;
+					}
+				}
+				delete [] old_buckets;
+			}
+			bucketstruct* b = find_bucket(key);
+			b->key = key;
+			b->slot = slot;
+			bucket_count++;
+		}
+
+		/// Removes the bucket, moving back the following buckets of the same probe sequence
+		void erase_bucket(bucketstruct* b)
+		{
+			const uint32 mask = (1u << bucket_bits) - 1;
+			uint32 hole = b - buckets;
+			uint32 i = hole;
+			while(  true  ) {
+				i = (i + 1) & mask;
+				if(  buckets[i].slot == NO_SLOT  ) {
+					break;
+				}
+				// may the entry at i move to the hole, i.e. is its home not cyclically within (hole, i]?
+				const uint32 home = get_bucket_index(buckets[i].key);
+				if(  ((i - home) & mask) >= ((i - hole) & mask)  ) {
+					buckets[hole] = buckets[i];
+					hole = i;
+				}
+			}
+			buckets[hole].slot = NO_SLOT;
+			bucket_count--;
+		}
+
+		/// Adds the new last slot to the chain of its element
+		void link_slot(T elem, uint32 slot)
+		{
+			const uint32 first = first_slot(elem);
+			if(  first == NO_SLOT  ) {
+				insert_bucket(elem, slot);
+			}
+			else {
+				uint32 last = first;
+				while(  nodes[last].next_same != NO_SLOT  ) {
+					last = nodes[last].next_same;
+				}
+				nodes[last].next_same = slot;
+			}
+		}
+
+		void unlink_slot(T elem, uint32 slot)
+		{
+			bucketstruct* b = find_bucket(elem);
+			if(  b->slot == slot  ) {
+				if(  nodes[slot].next_same == NO_SLOT  ) {
+					erase_bucket(b);
+				}
+				else {
+					b->slot = nodes[slot].next_same;
+				}
+			}
+			else {
+				uint32 prev = b->slot;
+				while(  nodes[prev].next_same != slot  ) {
+					prev = nodes[prev].next_same;
+				}
+				nodes[prev].next_same = nodes[slot].next_same;
+			}
+		}
+};
+
+#endif